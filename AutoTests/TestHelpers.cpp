@@ -18,10 +18,84 @@
 #ifndef ORGMODEPARSER_TESTHELPERS_H
 #define ORGMODEPARSER_TESTHELPERS_H
 
+#include <QFile>
+#include <QDir>
+#include <QtTest>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <malloc.h>
+#endif
+
 #include "TestHelpers.h"
 
 QString FL1(const char* text)  {
     return QString::fromLatin1(text);
 }
 
+QByteArray generateOrgFile(int headlineCount)
+{
+    QByteArray data("#+DRAWERS: LOGBOOK\n#+PROPERTY: Effort_ALL 0 0:10 0:30 1:00\n\nA generated OrgMode file.\n");
+    for (int i = 0; i < headlineCount; ++i) {
+        const QByteArray number = QByteArray::number(i);
+        const QByteArray stars(1 + i % 3, '*');
+        data += stars + " TODO Headline " + number + "\t\t:work:project" + QByteArray::number(i % 7) + ":\n";
+        data += "   :PROPERTIES:\n   :ID:       " + number + "\n   :Effort:   0:30\n   :END:\n";
+        data += "   :LOGBOOK:\n   CLOCK: [2015-03-26 Thu 10:00]--[2015-03-26 Thu 10:30] =>  0:30\n   :END:\n";
+        data += "   CLOCK: [2015-03-27 Fri 09:00]--[2015-03-27 Fri 09:45] =>  0:45\n";
+        data += "   Some text that belongs to headline " + number + ".\n\n";
+    }
+    return data;
+}
+
+QByteArray generateUnclosedDrawers(int count)
+{
+    QByteArray data("#+DRAWERS: LOGBOOK\n* Headline\n");
+    for (int i = 0; i < count; ++i) {
+        data += "  :LOGBOOK:\n  :PROPERTIES:\n  Text\n";
+    }
+    data += "* Next headline\n";
+    return data;
+}
+
+void orgFileInputs_data()
+{
+    QTest::addColumn<QByteArray>("input");
+    const QDir testData(FL1(":/TestData/Parser"));
+    for(auto const& name : testData.entryList(QStringList() << FL1("*.org"), QDir::Files)) {
+        QFile file(testData.filePath(name));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QTest::newRow(qPrintable(name)) << file.readAll();
+    }
+    QTest::newRow("generated") << generateOrgFile(500);
+    QTest::newRow("unclosed drawers") << generateUnclosedDrawers(100);
+    QTest::newRow("no headlines") << QByteArray("#+TITLE: Text\nSome text.\n");
+}
+
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    //The second field of statm is the resident set size in pages:
+    QFile statm(QLatin1String("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.count() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return 0;
+}
+
+qint64 heapMemory()
+{
+#if defined(Q_OS_LINUX) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    //Bytes in use in the heap and in separately mapped blocks:
+    const struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
 #endif
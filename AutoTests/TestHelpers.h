@@ -19,7 +19,29 @@
 #define TESTHELPERS_H
 
 #include <QString>
+#include <QByteArray>
 
 extern QString FL1(const char* text);
 
+/** Generate an OrgMode file with headlineCount headlines, for benchmarks.
+ *
+ * Every headline is tagged and contains a property drawer, a logbook drawer, clock lines and text.
+ */
+extern QByteArray generateOrgFile(int headlineCount);
+
+/** Generate a headline that contains count drawer titles that are never closed, followed by another headline. */
+extern QByteArray generateUnclosedDrawers(int count);
+
+/** Add an input column with the test data files and generated files, for data-driven tests of the ways to parse. */
+extern void orgFileInputs_data();
+
+/** Return the resident memory of the process in bytes, or 0 if it cannot be determined on this platform. */
+extern qint64 residentMemory();
+
+/** Return the bytes allocated with malloc that are in use, or 0 if it cannot be determined on this platform.
+ *
+ * Unlike the resident memory, this does not include memory the allocator keeps after it has been freed.
+ */
+extern qint64 heapMemory();
+
 #endif // TESTHELPERS_H
@@ -15,15 +15,61 @@
     have received a copy of the GNU General Public License along with
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <cstdlib>
+#include <new>
+
 #include <QString>
 #include <QtTest>
 
 #include <Parser.h>
+#include <LineClassifier.h>
+#include <LineScanner.h>
+#include <OrgEventHandler.h>
+#include <Headline.h>
+#include <CompletedClockLine.h>
+#include <AttributeLine.h>
+#include <AtomTable.h>
+#include <Tags.h>
+#include <TagIndex.h>
+#include <Properties.h>
+#include <PropertyIndex.h>
+#include <PropertyDrawerEntry.h>
+#include <FindElements.h>
+#include <Traversal.h>
+#include <BinaryFormat.h>
+#include <CompactDocument.h>
+#include <Clock.h>
 
 #include "TestHelpers.h"
 
 using namespace OrgMode;
 
+namespace {
+
+//The number of calls to operator new in the process, which includes the library:
+QAtomicInteger<qint64> allocationCount;
+
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetchAndAddRelaxed(1);
+    if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
 class Benchmarks : public QObject
 {
     Q_OBJECT
@@ -33,6 +79,48 @@ public:
 
 private Q_SLOTS:
     void benchmarkParseClocklines();
+    void benchmarkClassifyLines_data();
+    void benchmarkClassifyLines();
+    void benchmarkScanLines_data();
+    void benchmarkScanLines();
+    void benchmarkParseLines_data();
+    void benchmarkParseLines();
+    void benchmarkParseFiles_data();
+    void benchmarkParseFiles();
+    void benchmarkParseParallel_data();
+    void benchmarkParseParallel();
+    void benchmarkTODOCount_data();
+    void benchmarkTODOCount();
+    void benchmarkOutline_data();
+    void benchmarkOutline();
+    void benchmarkReparse_data();
+    void benchmarkReparse();
+    void benchmarkDeserialize_data();
+    void benchmarkDeserialize();
+    void benchmarkArenaAllocation_data();
+    void benchmarkArenaAllocation();
+    void benchmarkCompactClockSum_data();
+    void benchmarkCompactClockSum();
+    void benchmarkCompactFilter_data();
+    void benchmarkCompactFilter();
+    void benchmarkFindElements_data();
+    void benchmarkFindElements();
+    void benchmarkDeepNesting_data();
+    void benchmarkDeepNesting();
+    void benchmarkUnclosedDrawers_data();
+    void benchmarkUnclosedDrawers();
+    void benchmarkTreeWalk_data();
+    void benchmarkTreeWalk();
+    void benchmarkMemoryPerByte_data();
+    void benchmarkMemoryPerByte();
+    void benchmarkTagAtoms_data();
+    void benchmarkTagAtoms();
+    void benchmarkTagFilter_data();
+    void benchmarkTagFilter();
+    void benchmarkTagQuery_data();
+    void benchmarkTagQuery();
+    void benchmarkPropertyResolution_data();
+    void benchmarkPropertyResolution();
 };
 
 Benchmarks::Benchmarks()
@@ -52,6 +140,763 @@ void Benchmarks::benchmarkParseClocklines()
     }
 }
 
+namespace {
+
+//The chain of regular expressions every body line was matched against before the line classifier was introduced:
+int classifyWithRegularExpressions(const QString& line)
+{
+    static const QRegularExpression headline(QStringLiteral("^([*]+)\\s+(.*)$"));
+    static const QRegularExpression clockLine(QStringLiteral("^(\\s*)CLOCK:\\s*\\[([- A-Z a-z 0-9 :]+)\\](.*)$"));
+    static const QRegularExpression fileAttribute(QStringLiteral("\\#\\+(.+):\\s+(.*)$"));
+    static const QRegularExpression drawerTitle(QStringLiteral("^\\s+:(.+):\\s*(.*)$"));
+    if (headline.match(line).hasMatch()) {
+        return LineClassifier::Headline;
+    } else if (clockLine.match(line).hasMatch()) {
+        return LineClassifier::Clock;
+    } else if (fileAttribute.match(line).hasMatch()) {
+        return LineClassifier::FileAttribute;
+    } else if (drawerTitle.match(line).hasMatch()) {
+        return LineClassifier::Drawer;
+    }
+    return LineClassifier::Text;
+}
+
+int classifyWithLineClassifier(const QString& line)
+{
+    int level;
+    QStringView description;
+    QStringView first;
+    QStringView second;
+    switch (LineClassifier::classify(line)) {
+    case LineClassifier::Headline:
+        return LineClassifier::matchHeadline(line, &level, &description) ? LineClassifier::Headline : LineClassifier::Text;
+    case LineClassifier::Clock:
+        return LineClassifier::matchClockLine(line, &first, &second) ? LineClassifier::Clock : LineClassifier::Text;
+    case LineClassifier::FileAttribute:
+        return LineClassifier::matchFileAttribute(line, &first, &second) ? LineClassifier::FileAttribute : LineClassifier::Text;
+    case LineClassifier::Drawer:
+        return LineClassifier::matchDrawerTitle(line, &first) ? LineClassifier::Drawer : LineClassifier::Text;
+    case LineClassifier::Text:
+        break;
+    }
+    return LineClassifier::Text;
+}
+
+}
+
+void Benchmarks::benchmarkClassifyLines_data()
+{
+    QTest::addColumn<bool>("regularExpressions");
+    QTest::newRow("regular expressions") << true;
+    QTest::newRow("line classifier") << false;
+}
+
+void Benchmarks::benchmarkClassifyLines()
+{
+    QFETCH(bool, regularExpressions);
+    const QStringList lines = QString::fromUtf8(generateOrgFile(1000)).split(QLatin1Char('\n'));
+    qint64 classified = 0;
+    int checksum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        for(auto const& line : lines) {
+            checksum += regularExpressions ? classifyWithRegularExpressions(line) : classifyWithLineClassifier(line);
+        }
+        classified += lines.count();
+    }
+    qDebug() << "Lines per second:" << classified * 1000 / qMax<qint64>(timer.elapsed(), 1);
+    Q_UNUSED(checksum)
+}
+
+void Benchmarks::benchmarkScanLines_data()
+{
+    QTest::addColumn<bool>("textStream");
+    QTest::addColumn<int>("implementation");
+    QTest::newRow("QTextStream::readLine") << true << int(LineScanner::Automatic);
+    QTest::newRow("scalar") << false << int(LineScanner::Scalar);
+    QTest::newRow("SSE2") << false << int(LineScanner::SSE2);
+    QTest::newRow("AVX2") << false << int(LineScanner::AVX2);
+}
+
+void Benchmarks::benchmarkScanLines()
+{
+    QFETCH(bool, textStream);
+    QFETCH(int, implementation);
+    if (!LineScanner::isSupported(LineScanner::Implementation(implementation))) {
+        QSKIP("Not supported on this CPU.");
+    }
+    const QByteArray data = generateOrgFile(10000);
+    qint64 scanned = 0;
+    qsizetype lineCount = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        if (textStream) {
+            QTextStream stream(data);
+            QString line;
+            lineCount = 0;
+            while (stream.readLineInto(&line)) {
+                ++lineCount;
+            }
+        } else {
+            lineCount = LineScanner::scan(data, LineScanner::Implementation(implementation)).size();
+        }
+        scanned += data.size();
+    }
+    qDebug() << "Lines:" << lineCount << "MB per second:" << scanned / 1000 / qMax<qint64>(timer.elapsed(), 1);
+}
+
+void Benchmarks::benchmarkParseLines_data()
+{
+    QTest::addColumn<int>("implementation");
+    QTest::newRow("scalar") << int(LineScanner::Scalar);
+    QTest::newRow("automatic") << int(LineScanner::Automatic);
+}
+
+void Benchmarks::benchmarkParseLines()
+{
+    QFETCH(int, implementation);
+    LineScanner::setImplementation(LineScanner::Implementation(implementation));
+    const QByteArray data = generateOrgFile(10000);
+    const qint64 lineCount = data.count('\n');
+    qint64 parsed = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        Parser parser;
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        Q_UNUSED(element)
+        parsed += lineCount;
+    }
+    LineScanner::setImplementation(LineScanner::Automatic);
+    qDebug() << "Lines per second:" << parsed * 1000 / qMax<qint64>(timer.elapsed(), 1);
+}
+
+void Benchmarks::benchmarkParseFiles_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("all cores") << QThread::idealThreadCount();
+}
+
+//Parse a synthetic corpus of 1000 files, with one file that is much larger than the others:
+void Benchmarks::benchmarkParseFiles()
+{
+    QFETCH(int, threadCount);
+    QTemporaryDir corpus;
+    QVERIFY(corpus.isValid());
+    QStringList fileNames;
+    for (int i = 0; i < 1000; ++i) {
+        const QString fileName = corpus.filePath(QString::fromLatin1("file%1.org").arg(i));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(generateOrgFile(i == 500 ? 5000 : 50));
+        fileNames << fileName;
+    }
+    const Parser parser;
+    QBENCHMARK {
+        const ParseBatch::Results results = parser.parseFiles(fileNames, threadCount);
+        QCOMPARE(results.count(), fileNames.count());
+    }
+}
+
+void Benchmarks::benchmarkParseParallel_data()
+{
+    QTest::addColumn<bool>("parallel");
+    QTest::newRow("sequential") << false;
+    QTest::newRow("split at level 1 headlines") << true;
+}
+
+void Benchmarks::benchmarkParseParallel()
+{
+    QFETCH(bool, parallel);
+    const QByteArray data = generateOrgFile(100000);
+    Parser parser;
+    parser.setParallelParsing(parallel);
+    QBENCHMARK {
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        Q_UNUSED(element)
+    }
+}
+
+void Benchmarks::benchmarkTODOCount_data()
+{
+    QTest::addColumn<bool>("events");
+    QTest::newRow("element tree") << false;
+    QTest::newRow("events") << true;
+}
+
+//Count TODO headlines with and without building the element tree, and report the memory that is used:
+void Benchmarks::benchmarkTODOCount()
+{
+    class TODOCounter : public OrgEventHandler {
+    public:
+        void onHeadline(int, QStringView caption, const QStringList&, QStringView) override {
+            if (caption.trimmed().startsWith(QLatin1String("TODO"))) {
+                ++todos;
+            }
+        }
+        int todos = 0;
+    };
+
+    QFETCH(bool, events);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    int todos = 0;
+    qint64 peak = 0;
+    const qint64 before = residentMemory();
+    QBENCHMARK {
+        if (events) {
+            TODOCounter counter;
+            parser.parse(QByteArrayView(data), &counter);
+            todos = counter.todos;
+            peak = qMax(peak, residentMemory());
+        } else {
+            const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+            auto isTODO = [](const Headline::Pointer& headline) {
+                return headline->caption().trimmed().startsWith(QLatin1String("TODO"));
+            };
+            todos = findElements<Headline>(element, isTODO).count();
+            peak = qMax(peak, residentMemory());
+        }
+    }
+    QCOMPARE(todos, 100000);
+    qDebug() << "Additional resident memory (KiB):" << qMax<qint64>(peak - before, 0) / 1024;
+}
+
+void Benchmarks::benchmarkOutline_data()
+{
+    QTest::addColumn<bool>("lazy");
+    QTest::newRow("full parse") << false;
+    QTest::newRow("lazy sections") << true;
+}
+
+//Collect the captions and tags of all headlines of a file, without accessing their bodies:
+void Benchmarks::benchmarkOutline()
+{
+    QFETCH(bool, lazy);
+    const QByteArray data = generateOrgFile(100000);
+    Parser parser;
+    parser.setLazyParsing(lazy);
+    int count = 0;
+    QBENCHMARK {
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        Headline::List headlines;
+        if (lazy) {
+            for(auto const& child : element->children()) {
+                if (auto const headline = child.dynamicCast<Headline>()) {
+                    headlines.append(headline);
+                }
+            }
+            for (int i = 0; i < headlines.count(); ++i) {
+                headlines.append(headlines.at(i)->headlines());
+            }
+        } else {
+            headlines = findElements<Headline>(element);
+        }
+        count = 0;
+        for(auto const& headline : headlines) {
+            count += headline->caption().isEmpty() || headline->tags().empty() ? 0 : 1;
+        }
+    }
+    QCOMPARE(count, 100000);
+}
+
+void Benchmarks::benchmarkReparse_data()
+{
+    QTest::addColumn<bool>("incremental");
+    QTest::newRow("full parse") << false;
+    QTest::newRow("reparse") << true;
+}
+
+//Edit a single line in the middle of a file with about 100000 lines:
+void Benchmarks::benchmarkReparse()
+{
+    QFETCH(bool, incremental);
+    const QByteArray data = generateOrgFile(10000);
+    const Parser parser;
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(data)).dynamicCast<OrgFile>();
+    QVERIFY(file);
+    //The text line of the headline in the middle of the file:
+    const qsizetype offset = data.indexOf("Some text that belongs to headline 5000.");
+    const int line = int(data.left(offset).count('\n'));
+    const QString text = QString::fromUtf8(data.mid(offset, data.indexOf('\n', offset) - offset));
+    const int lineCount = int(data.count('\n'));
+    int edits = 0;
+    QBENCHMARK {
+        const QString edited = text + QString::number(++edits);
+        if (incremental) {
+            parser.reparse(file, line, 1, edited);
+        } else {
+            const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+            Q_UNUSED(element)
+        }
+    }
+    qDebug() << "Lines:" << lineCount;
+}
+
+void Benchmarks::benchmarkDeserialize_data()
+{
+    QTest::addColumn<bool>("binary");
+    QTest::newRow("parse") << false;
+    QTest::newRow("deserialize") << true;
+}
+
+//Build the element tree of a large file from org text and from its binary form:
+void Benchmarks::benchmarkDeserialize()
+{
+    QFETCH(bool, binary);
+    const QByteArray data = generateOrgFile(10000);
+    const Parser parser;
+    const QByteArray serialized = BinaryFormat::serialize(parser.parse(QByteArrayView(data)));
+    QBENCHMARK {
+        const OrgElement::Pointer element = binary ? BinaryFormat::deserialize(QByteArrayView(serialized))
+                                                   : parser.parse(QByteArrayView(data));
+        Q_UNUSED(element)
+    }
+    qDebug() << "Text bytes:" << data.size() << "binary bytes:" << serialized.size();
+}
+
+void Benchmarks::benchmarkArenaAllocation_data()
+{
+    QTest::addColumn<bool>("arena");
+    QTest::newRow("heap") << false;
+    QTest::newRow("arena") << true;
+}
+
+//Parse and destroy a file with about one million lines, and report the allocations per element and teardown time:
+void Benchmarks::benchmarkArenaAllocation()
+{
+    QFETCH(bool, arena);
+    const QByteArray data = generateOrgFile(100000);
+    Parser parser;
+    parser.setArenaAllocation(arena);
+    qint64 allocations = 0;
+    qint64 elements = 0;
+    qint64 teardown = 0;
+    QBENCHMARK {
+        const qint64 before = allocationCount.loadRelaxed();
+        OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        allocations = allocationCount.loadRelaxed() - before;
+        elements = findElements<OrgElement>(element).count();
+        QElapsedTimer timer;
+        timer.start();
+        element.reset();
+        teardown = timer.nsecsElapsed();
+    }
+    qDebug() << "Elements:" << elements << "allocations per element:" << double(allocations) / elements
+             << "teardown (ms):" << teardown / 1000000.0;
+}
+
+void Benchmarks::benchmarkCompactClockSum_data()
+{
+    QTest::addColumn<bool>("compact");
+    QTest::newRow("tree") << false;
+    QTest::newRow("compact") << true;
+}
+
+//Sum up the clock times of a day in a large file, on the element tree and on the compact document:
+void Benchmarks::benchmarkCompactClockSum()
+{
+    QFETCH(bool, compact);
+    const int headlineCount = 100000;
+    const QByteArray data = generateOrgFile(headlineCount);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const CompactDocument document(element);
+    const TimeInterval interval(QDate(2015, 3, 27), QDate(2015, 3, 28));
+    int duration = 0;
+    QBENCHMARK {
+        duration = compact ? document.duration(0, interval) : Clock(element).duration(interval);
+    }
+    //Every headline has 45 minutes clocked on that day:
+    QCOMPARE(duration, headlineCount * 45 * 60);
+}
+
+void Benchmarks::benchmarkCompactFilter_data()
+{
+    benchmarkCompactClockSum_data();
+}
+
+//Find the TODO headlines with a tag in a large file, on the element tree and on the compact document:
+void Benchmarks::benchmarkCompactFilter()
+{
+    QFETCH(bool, compact);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const CompactDocument document(element);
+    const QString tag = QStringLiteral("project3");
+    int count = 0;
+    QBENCHMARK {
+        if (compact) {
+            auto const isMatch = [&document, &tag](int node) {
+                return document.caption(node).startsWith(QLatin1String("TODO")) && document.hasTag(node, tag);
+            };
+            count = document.findNodes(BinaryFormat::HeadlineNode, isMatch).count();
+        } else {
+            auto const isMatch = [&tag](const Headline::Pointer& headline) {
+                return headline->caption().startsWith(QLatin1String("TODO")) && headline->tags().count(tag) > 0;
+            };
+            count = findElements<Headline>(element, isMatch).count();
+        }
+    }
+    //Every seventh headline is tagged project3:
+    QCOMPARE(count, 14286);
+}
+
+//findElements as it was implemented before element_cast, with a dynamic cast of every element:
+template <typename T>
+QList<QSharedPointer<T>> findElementsByDynamicCast(const OrgElement::Pointer& element)
+{
+    QList<QSharedPointer<T>> matches;
+    if (auto const p = element.dynamicCast<T>()) {
+        matches.append(p);
+    }
+    for(auto const& child : element->children()) {
+        matches.append(findElementsByDynamicCast<T>(child));
+    }
+    return matches;
+}
+
+void Benchmarks::benchmarkFindElements_data()
+{
+    QTest::addColumn<bool>("elementCast");
+    QTest::newRow("dynamicCast") << false;
+    QTest::newRow("element_cast") << true;
+}
+
+//Find the completed clock lines of a large file:
+void Benchmarks::benchmarkFindElements()
+{
+    QFETCH(bool, elementCast);
+    const QByteArray data = generateOrgFile(10000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    int count = 0;
+    QBENCHMARK {
+        count = elementCast ? findElements<CompletedClockLine>(element).count()
+                            : findElementsByDynamicCast<CompletedClockLine>(element).count();
+    }
+    QCOMPARE(count, 20000);
+}
+
+void Benchmarks::benchmarkDeepNesting_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::newRow("500 levels") << 500;
+    QTest::newRow("2000 levels") << 2000;
+}
+
+//Parse an outline where every headline is nested in the previous one:
+void Benchmarks::benchmarkDeepNesting()
+{
+    QFETCH(int, depth);
+    QByteArray data;
+    for (int i = 0; i < depth; ++i) {
+        data += QByteArray(i + 1, '*') + " Headline " + QByteArray::number(i) + "\nSome text.\n";
+    }
+    const Parser parser;
+    int level = 0;
+    QBENCHMARK {
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        level = findElements<Headline>(element).last()->level();
+    }
+    QCOMPARE(level, depth);
+}
+
+//Count the elements of a subtree with a recursive walk over the copied child lists:
+int countElements(const OrgElement::Pointer& element)
+{
+    int count = 1;
+    for(auto const child : element->children()) {
+        count += countElements(child);
+    }
+    return count;
+}
+
+void Benchmarks::benchmarkUnclosedDrawers_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("2000 drawer titles") << 2000;
+    QTest::newRow("16000 drawer titles") << 16000;
+}
+
+//Parse a headline that contains drawer titles that are never closed. The time should grow linearly with the number
+//of lines:
+void Benchmarks::benchmarkUnclosedDrawers()
+{
+    QFETCH(int, count);
+    const QByteArray data = generateUnclosedDrawers(count);
+    const Parser parser;
+    int headlines = 0;
+    QBENCHMARK {
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        headlines = findElements<Headline>(element).count();
+    }
+    QCOMPARE(headlines, 2);
+}
+
+void Benchmarks::benchmarkTreeWalk_data()
+{
+    QTest::addColumn<QString>("walk");
+    QTest::newRow("children") << QStringLiteral("children");
+    QTest::newRow("preorder") << QStringLiteral("preorder");
+    QTest::newRow("postorder") << QStringLiteral("postorder");
+    QTest::newRow("findElements") << QStringLiteral("findElements");
+}
+
+//Visit all elements of a file with about one million lines:
+void Benchmarks::benchmarkTreeWalk()
+{
+    QFETCH(QString, walk);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const int expected = countElements(element);
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        if (walk == QLatin1String("children")) {
+            count = countElements(element);
+        } else if (walk == QLatin1String("preorder")) {
+            for (auto const& current : preorder(element)) {
+                Q_UNUSED(current)
+                ++count;
+            }
+        } else if (walk == QLatin1String("postorder")) {
+            for (auto const& current : postorder(element)) {
+                Q_UNUSED(current)
+                ++count;
+            }
+        } else {
+            count = findElements<OrgElement>(element).count();
+        }
+    }
+    QCOMPARE(count, expected);
+}
+
+void Benchmarks::benchmarkMemoryPerByte_data()
+{
+    QTest::addColumn<bool>("decoded");
+    QTest::newRow("source slices") << false;
+    QTest::newRow("decoded lines") << true;
+}
+
+//Report the memory of the element tree of a large file per byte of input. The decoded row adds a UTF-16 copy of
+//every line, caption, key and value, which is what the elements kept before they referenced the source. The heap
+//bytes in use do not depend on memory the allocator keeps from earlier iterations or rows, the resident memory
+//does, and is reported for platforms without heap statistics:
+void Benchmarks::benchmarkMemoryPerByte()
+{
+    QFETCH(bool, decoded);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    double heapRatio = 0;
+    double residentRatio = 0;
+    QBENCHMARK {
+        const qint64 heapBefore = heapMemory();
+        const qint64 residentBefore = residentMemory();
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        QVector<QString> copies;
+        if (decoded) {
+            for (auto const& current : preorder(element)) {
+                copies.append(current->line());
+                if (auto const headline = element_cast<Headline>(current)) {
+                    copies.append(headline->caption());
+                } else if (auto const entry = element_cast<AttributeLine>(current)) {
+                    copies.append(entry->key());
+                    copies.append(entry->value());
+                }
+            }
+        }
+        heapRatio = double(heapMemory() - heapBefore) / data.size();
+        residentRatio = double(qMax<qint64>(residentMemory() - residentBefore, 0)) / data.size();
+    }
+    qDebug() << "Input bytes:" << data.size() << "heap bytes per input byte:" << heapRatio
+             << "resident bytes per input byte:" << residentRatio;
+}
+
+void Benchmarks::benchmarkTagAtoms_data()
+{
+    QTest::addColumn<QString>("comparison");
+    QTest::newRow("tag sets") << QStringLiteral("sets");
+    QTest::newRow("tag strings") << QStringLiteral("strings");
+    QTest::newRow("tag atoms") << QStringLiteral("atoms");
+}
+
+//Count the headlines with a tag in a file with 100000 tagged headlines, and report the memory per headline:
+void Benchmarks::benchmarkTagAtoms()
+{
+    QFETCH(QString, comparison);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    const qint64 before = residentMemory();
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(data)).dynamicCast<OrgFile>();
+    const qint64 memory = qMax<qint64>(residentMemory() - before, 0);
+    const Headline::List headlines = findElements<Headline>(file);
+    const QString tag = QStringLiteral("project3");
+    const AtomTable::Atom atom = file->atomTable()->find(tag);
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        if (comparison == QLatin1String("sets")) {
+            for (auto const& headline : headlines) {
+                count += int(headline->tags().count(tag));
+            }
+        } else if (comparison == QLatin1String("strings")) {
+            for (auto const& headline : headlines) {
+                count += headline->hasTag(tag) ? 1 : 0;
+            }
+        } else {
+            for (auto const& headline : headlines) {
+                count += headline->hasTag(atom) ? 1 : 0;
+            }
+        }
+    }
+    QCOMPARE(count, 100000 / 7 + 1);
+    qDebug() << "Resident bytes per headline:" << double(memory) / headlines.count()
+             << "atoms:" << file->atomTable()->size();
+}
+
+void Benchmarks::benchmarkTagFilter_data()
+{
+    QTest::addColumn<bool>("bitsets");
+    QTest::newRow("parent walk") << false;
+    QTest::newRow("bitsets") << true;
+}
+
+//Find the headlines tagged :work: but not :project3:, directly or inherited, in a file with 100000 headlines. The
+//parent walk row tests the tag sets of every headline and its ancestors, as Tags::hasTag() did before:
+void Benchmarks::benchmarkTagFilter()
+{
+    QFETCH(bool, bitsets);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const Headline::List headlines = findElements<Headline>(element);
+    const QString work = QStringLiteral("work");
+    const QString project = QStringLiteral("project3");
+    auto const isTagged = [](const Headline* headline, const QString& tag) {
+        for (; headline; headline = element_cast<Headline>(headline->parent())) {
+            if (headline->tags().count(tag)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    int count = 0;
+    QBENCHMARK {
+        if (bitsets) {
+            count = Tags::filter(headlines, QStringList() << work, QStringList() << project).count();
+        } else {
+            count = 0;
+            for (auto const& headline : headlines) {
+                count += isTagged(headline.data(), work) && !isTagged(headline.data(), project) ? 1 : 0;
+            }
+        }
+    }
+    QVERIFY(count > 0);
+    qDebug() << "Matching headlines:" << count;
+}
+
+void Benchmarks::benchmarkTagQuery_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::newRow("predicate") << false;
+    QTest::newRow("tag index") << true;
+}
+
+//Find the headlines tagged :work: but not :project3: in a file with 100000 headlines, once with a predicate
+//evaluated for every headline and once with the posting lists of a tag index built in advance:
+void Benchmarks::benchmarkTagQuery()
+{
+    QFETCH(bool, indexed);
+    const QByteArray data = generateOrgFile(100000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const TagIndex index(element);
+    const QString work = QStringLiteral("work");
+    const QString project = QStringLiteral("project3");
+    int count = 0;
+    QBENCHMARK {
+        if (indexed) {
+            count = index.query(QStringList() << work, QStringList() << project).count();
+        } else {
+            count = findElements<Headline>(element, [&work, &project](const Headline::Pointer& headline) {
+                const Tags tags(headline);
+                return tags.hasTag(work) && !tags.hasTag(project);
+            }).count();
+        }
+    }
+    QVERIFY(count > 0);
+    qDebug() << "Matching headlines:" << count;
+}
+
+void Benchmarks::benchmarkPropertyResolution_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::newRow("tree walk") << false;
+    QTest::newRow("property index") << true;
+}
+
+//Resolve three properties for all headlines of a file with 1000 headlines, as a column report does. The tree walk
+//row collects the definitions of the file and of every ancestor for every query, as Properties::property() did
+//before. The property index row includes building the index:
+void Benchmarks::benchmarkPropertyResolution()
+{
+    QFETCH(bool, indexed);
+    const QByteArray data = generateOrgFile(1000);
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+    const Headline::List headlines = findElements<Headline>(element);
+    const QStringList keys = QStringList() << QStringLiteral("ID") << QStringLiteral("Effort")
+                                           << QStringLiteral("Effort_ALL");
+    auto const walk = [](const Headline::Pointer& headline, const QString& key) {
+        Properties::Vector definitions;
+        for(auto const& attribute : Attributes(headline).fileAttributes(QStringLiteral("PROPERTY"))) {
+            const Property property = Properties::parseAttributeAsProperty(attribute);
+            if (property.key() == key) {
+                definitions << property;
+            }
+        }
+        Properties::Vector drawers;
+        for (OrgElement* current = headline.data(); current; current = current->parent()) {
+            Properties::Vector own;
+            for(auto const& entry : findElements<PropertyDrawerEntry>(current, 2)) {
+                if (entry->key() == key) {
+                    own << entry->property();
+                }
+            }
+            drawers = own + drawers;
+        }
+        return Properties::propertyValue(key, definitions + drawers);
+    };
+    qint64 length = 0;
+    QBENCHMARK {
+        length = 0;
+        if (indexed) {
+            const PropertyIndex::Pointer index(new PropertyIndex(element));
+            for(auto const& headline : headlines) {
+                for(auto const& key : keys) {
+                    length += Properties(headline, index).property(key).size();
+                }
+            }
+        } else {
+            for(auto const& headline : headlines) {
+                for(auto const& key : keys) {
+                    length += walk(headline, key).size();
+                }
+            }
+        }
+    }
+    QVERIFY(length > 0);
+    qDebug() << "Resolved characters:" << length;
+}
+
 QTEST_APPLESS_MAIN(Benchmarks)
 
 #include "tst_Benchmarks.moc"
@@ -20,6 +20,8 @@
 #include <QCoreApplication>
 
 #include <OrgFileContent.h>
+#include <LineClassifier.h>
+#include <LineScanner.h>
 #include <Headline.h>
 #include <Parser.h>
 #include <Writer.h>
@@ -36,7 +38,20 @@
 #include <DrawerEntry.h>
 #include <PropertyDrawer.h>
 #include <PropertyDrawerEntry.h>
+#include <DrawerClosingEntry.h>
 #include <FindElements.h>
+#include <Traversal.h>
+#include <OrgEventHandler.h>
+#include <ParseCache.h>
+#include <BinaryFormat.h>
+#include <BinaryDocument.h>
+#include <CompactDocument.h>
+#include <Arena.h>
+#include <SourceText.h>
+#include <AtomTable.h>
+#include <TagSet.h>
+#include <TagIndex.h>
+#include <PropertyIndex.h>
 
 #include "TestHelpers.h"
 
@@ -55,11 +70,46 @@ public:
 
 private Q_SLOTS:
     void testOrgFileContent();
+    void testOrgFileContentCursor();
+    void testLineClassifier_data();
+    void testLineClassifier();
+    void testHeadlineTags();
+    void testLineScanner_data();
+    void testLineScanner();
     void testParseAttributesAsProperty_data();
     void testParseAttributesAsProperty();
     void testPropertyOperations();
     void testParserAndIdentity_data();
     void testParserAndIdentity();
+    void testParseEntryPoints_data();
+    void testParseEntryPoints();
+    void testUnclosedDrawers();
+    void testFileSettings();
+    void testConcurrentParsing();
+    void testParseBatch();
+    void testParallelParsing_data();
+    void testParallelParsing();
+    void testEventParsing_data();
+    void testEventParsing();
+    void testLazyParsing_data();
+    void testLazyParsing();
+    void testReparse();
+    void testRandomReparse();
+    void testParseCache();
+    void testBinaryFormat_data();
+    void testBinaryFormat();
+    void testInvalidBinaryData();
+    void testArenaAllocation();
+    void testCompactDocument_data();
+    void testCompactDocument();
+    void testElementCast();
+    void testElementLevels();
+    void testTraversal();
+    void testSourceText();
+    void testAtomTable();
+    void testTagSets();
+    void testTagIndex();
+    void testPropertyIndex();
 };
 
 ParserTests::ParserTests()
@@ -81,6 +131,183 @@ void ParserTests::testOrgFileContent()
     QVERIFY(content.atEnd());
 }
 
+void ParserTests::testOrgFileContentCursor()
+{
+    const QByteArray data("* A\n  :LOGBOOK:\n\nText\n");
+    OrgFileContent content{QByteArrayView(data)};
+    QCOMPARE(content.getLine(), FL1("* A"));
+    const qsizetype start = content.position();
+    QCOMPARE(start, qsizetype(1));
+    QCOMPARE(content.getLine(), FL1("  :LOGBOOK:"));
+    const QString empty = content.getLine();
+    QVERIFY(!empty.isNull() && empty.isEmpty());
+    //Returning the line that was read last moves the cursor back:
+    content.ungetLine(empty);
+    QCOMPARE(content.position(), qsizetype(2));
+    QCOMPARE(content.getLine(), empty);
+    QCOMPARE(content.getLine(), FL1("Text"));
+    QVERIFY(content.atEnd());
+    //Backtracking returns the same lines again:
+    content.setPosition(start);
+    QVERIFY(!content.atEnd());
+    LineClassifier::Type type;
+    QCOMPARE(content.getLine(&type), FL1("  :LOGBOOK:"));
+    QCOMPARE(int(type), int(LineClassifier::Drawer));
+    //Lines that were not read last are pushed back:
+    const QString other(FL1("other"));
+    content.ungetLine(other);
+    QCOMPARE(content.getLine(), other);
+    QCOMPARE(content.getLine(), empty);
+    QCOMPARE(content.getLine(), FL1("Text"));
+    QVERIFY(content.atEnd());
+    QVERIFY(content.getLine().isNull());
+    //A streamed content returns the same lines, and keeps no line index:
+    OrgFileContent streamed = OrgFileContent::stream(data);
+    QCOMPARE(streamed.getLine(), FL1("* A"));
+    const QString title = streamed.getLine(&type);
+    QCOMPARE(title, FL1("  :LOGBOOK:"));
+    QCOMPARE(int(type), int(LineClassifier::Drawer));
+    QCOMPARE(streamed.drawerEnd(), qsizetype(4));
+    QCOMPARE(streamed.position(), qsizetype(2));
+    //The line that was read last can be returned:
+    streamed.ungetLine(title);
+    QCOMPARE(streamed.position(), qsizetype(1));
+    QCOMPARE(streamed.getLine(), title);
+    QCOMPARE(streamed.getLine(), empty);
+    QCOMPARE(streamed.getLine(), FL1("Text"));
+    QVERIFY(streamed.atEnd());
+    QVERIFY(streamed.lineIndex().isEmpty());
+}
+
+void ParserTests::testLineClassifier_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("type");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("headline") << FL1("** Headline") << int(LineClassifier::Headline) << true;
+    QTest::newRow("bold text") << FL1("*bold* text") << int(LineClassifier::Headline) << false;
+    QTest::newRow("indented star") << FL1("  * list item") << int(LineClassifier::Text) << false;
+    QTest::newRow("clock line") << FL1("   CLOCK: [2014-09-20 Sat 14:00]--[2014-09-20 Sat 14:10] =>  0:10")
+                                << int(LineClassifier::Clock) << true;
+    QTest::newRow("incomplete clock line") << FL1("CLOCK: [2014-09-20 Sat 14:30]") << int(LineClassifier::Clock) << true;
+    QTest::newRow("not a clock line") << FL1("  CLOCKS are ticking") << int(LineClassifier::Clock) << false;
+    QTest::newRow("file attribute") << FL1("#+DRAWERS: MyDrawers TestDrawer") << int(LineClassifier::FileAttribute) << true;
+    QTest::newRow("empty file attribute") << FL1("#+EMPTY_ATTRIBUTE: ") << int(LineClassifier::FileAttribute) << true;
+    QTest::newRow("comment") << FL1("# A comment: not an attribute") << int(LineClassifier::FileAttribute) << false;
+    QTest::newRow("attribute in text") << FL1("Text with #+KEY: value") << int(LineClassifier::Text) << false;
+    QTest::newRow("drawer title") << FL1("  :PROPERTIES:") << int(LineClassifier::Drawer) << true;
+    QTest::newRow("drawer title with text") << FL1("  :TestDrawer: Extra value") << int(LineClassifier::Drawer) << false;
+    QTest::newRow("drawer title in first column") << FL1(":PROPERTIES:") << int(LineClassifier::Drawer) << false;
+    QTest::newRow("empty line") << QString() << int(LineClassifier::Text) << false;
+    QTest::newRow("text") << FL1("  Some text.") << int(LineClassifier::Text) << false;
+}
+
+void ParserTests::testLineClassifier()
+{
+    QFETCH(QString, line);
+    QFETCH(int, type);
+    QFETCH(bool, valid);
+
+    QCOMPARE(int(LineClassifier::classify(line)), type);
+    int level;
+    QStringView first;
+    QStringView second;
+    switch (type) {
+    case LineClassifier::Headline:
+        QCOMPARE(LineClassifier::matchHeadline(line, &level, &first), valid);
+        break;
+    case LineClassifier::Clock:
+        QCOMPARE(LineClassifier::matchClockLine(line, &first, &second), valid);
+        break;
+    case LineClassifier::FileAttribute:
+        QCOMPARE(LineClassifier::matchFileAttribute(line, &first, &second), valid);
+        break;
+    case LineClassifier::Drawer:
+        QCOMPARE(LineClassifier::matchDrawerTitle(line, &first), valid);
+        break;
+    default:
+        QVERIFY(!valid);
+    }
+}
+
+void ParserTests::testHeadlineTags()
+{
+    const QString line(FL1("** TODO headline_1_2 \t:TEST:VERIFY:  "));
+    int level = 0;
+    QStringView description;
+    QVERIFY(LineClassifier::matchHeadline(line, &level, &description));
+    QCOMPARE(level, 2);
+    QStringView caption;
+    QStringView tags;
+    QVERIFY(LineClassifier::matchTags(description, &caption, &tags));
+    QCOMPARE(caption.toString(), FL1("TODO headline_1_2"));
+    QCOMPARE(tags.toString(), FL1("TEST:VERIFY"));
+    //A colon in the caption does not start the tags:
+    QVERIFY(!LineClassifier::matchTags(QStringView(FL1("Meeting at 10:00")), &caption, &tags));
+}
+
+void ParserTests::testLineScanner_data()
+{
+    QTest::addColumn<QByteArray>("input");
+    const QDir testData(FL1(":/TestData/Parser"));
+    for(auto const& name : testData.entryList(QStringList() << FL1("*.org"), QDir::Files)) {
+        QFile file(testData.filePath(name));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QTest::newRow(qPrintable(name)) << file.readAll();
+    }
+    QTest::newRow("generated") << generateOrgFile(100);
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("line breaks") << QByteArray("\n\r\n\n");
+    QTest::newRow("no final line break") << QByteArray("\xEF\xBB\xBF* Headline\r\n  :PROPERTIES:\r\n  CLOCK: ");
+    QTest::newRow("byte order mark only") << QByteArray("\xEF\xBB\xBF");
+}
+
+//Verify that all line scanner implementations split the input like QTextStream, and agree on the line types:
+void ParserTests::testLineScanner()
+{
+    QFETCH(QByteArray, input);
+
+    QTextStream stream(input);
+    QStringList lines;
+    while (!stream.atEnd()) {
+        lines.append(stream.readLine());
+    }
+    const LineScanner::LineIndex reference = LineScanner::scan(input, LineScanner::Scalar);
+    QCOMPARE(reference.size(), lines.size());
+    for (int i = 0; i < lines.size(); ++i) {
+        const LineScanner::Line& line = reference.at(i);
+        QCOMPARE(QString::fromUtf8(input.mid(line.offset, line.length)), lines.at(i));
+        //The scanner only refines the candidate type of the classifier:
+        const LineClassifier::Type type = LineClassifier::classify(lines.at(i));
+        QVERIFY(line.type == type || line.type == LineClassifier::Text);
+    }
+    for (auto implementation : { LineScanner::SSE2, LineScanner::AVX2 }) {
+        if (!LineScanner::isSupported(implementation)) {
+            continue;
+        }
+        const LineScanner::LineIndex index = LineScanner::scan(input, implementation);
+        QCOMPARE(index.size(), reference.size());
+        for (int i = 0; i < index.size(); ++i) {
+            QCOMPARE(index.at(i).offset, reference.at(i).offset);
+            QCOMPARE(index.at(i).length, reference.at(i).length);
+            QCOMPARE(int(index.at(i).type), int(reference.at(i).type));
+        }
+    }
+    //Reading one line at a time returns the same lines:
+    qsizetype offset = 0;
+    LineScanner::Line line;
+    int count = 0;
+    while (LineScanner::next(input, &offset, &line)) {
+        QVERIFY(count < reference.size());
+        QCOMPARE(line.offset, reference.at(count).offset);
+        QCOMPARE(line.length, reference.at(count).length);
+        QCOMPARE(int(line.type), int(reference.at(count).type));
+        ++count;
+    }
+    QCOMPARE(count, reference.size());
+}
+
 void ParserTests::testParseAttributesAsProperty_data()
 {
     QTest::addColumn<Property>("input");
@@ -545,6 +772,1366 @@ void ParserTests::testParserAndIdentity()
     }
 }
 
+void ParserTests::testParseEntryPoints_data()
+{
+    QTest::addColumn<QString>("filename");
+    const QDir testData(FL1(":/TestData/Parser"));
+    for(auto const& name : testData.entryList(QStringList() << FL1("*.org"), QDir::Files)) {
+        QTest::newRow(qPrintable(name)) << testData.filePath(name);
+    }
+}
+
+//Verify that parsing from a text stream, a UTF-8 buffer and a (mapped) file produces the same element tree:
+void ParserTests::testParseEntryPoints()
+{
+    QFETCH(QString, filename);
+
+    QFile orgFile(filename);
+    QVERIFY(orgFile.open(QIODevice::ReadOnly));
+    const QByteArray input = orgFile.readAll();
+    QBuffer buffer;
+    buffer.setData(input);
+    buffer.open(QBuffer::ReadOnly);
+    QTextStream stream(&buffer);
+    Parser parser;
+    const OrgElement::Pointer fromStream = parser.parse(&stream, filename);
+    const OrgElement::Pointer fromBuffer = parser.parse(QByteArrayView(input), filename);
+    const OrgElement::Pointer fromFile = parser.parseFile(filename);
+    QCOMPARE(fromBuffer->describe(), fromStream->describe());
+    QCOMPARE(fromFile->describe(), fromStream->describe());
+    QByteArray output;
+    QBuffer outputBuffer(&output);
+    outputBuffer.open(QBuffer::WriteOnly);
+    QTextStream outputStream(&outputBuffer);
+    Writer writer;
+    writer.writeTo(&outputStream, fromBuffer);
+    outputStream.flush();
+    QCOMPARE(output, input);
+}
+
+//Unclosed drawers are regular lines. Verify that looking ahead for their ends scans every line at most once:
+void ParserTests::testUnclosedDrawers()
+{
+    Parser parser;
+    for (int count : { 2000, 16000 }) {
+        const QByteArray input = generateUnclosedDrawers(count);
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(input));
+        QVERIFY(findElements<Drawer>(element).isEmpty());
+        QCOMPARE(findElements<Headline>(element).count(), 2);
+        QCOMPARE(findElements<OrgLine>(element).count(), 3 * count);
+        QByteArray output;
+        QBuffer outputBuffer(&output);
+        outputBuffer.open(QBuffer::WriteOnly);
+        QTextStream outputStream(&outputBuffer);
+        Writer writer;
+        writer.writeTo(&outputStream, element);
+        outputStream.flush();
+        QCOMPARE(output, input);
+        //Look for the end of every drawer title, as the parser does:
+        OrgFileContent content{QByteArrayView(input)};
+        int titles = 0;
+        while (!content.atEnd()) {
+            LineClassifier::Type type;
+            content.getLine(&type);
+            if (type == LineClassifier::Drawer) {
+                QCOMPARE(content.drawerEnd(), qsizetype(-1));
+                ++titles;
+            }
+        }
+        QCOMPARE(titles, 2 * count);
+        QVERIFY(content.lookaheadLines() <= content.lineIndex().size());
+        //The same for a streamed content, which scans the buffer instead of the line index:
+        OrgFileContent streamed = OrgFileContent::stream(input);
+        while (!streamed.atEnd()) {
+            LineClassifier::Type type;
+            streamed.getLine(&type);
+            if (type == LineClassifier::Drawer) {
+                QCOMPARE(streamed.drawerEnd(), qsizetype(-1));
+            }
+        }
+        QCOMPARE(streamed.lookaheadLines(), content.lookaheadLines());
+    }
+}
+
+void ParserTests::testFileSettings()
+{
+    const QByteArray input("#+DRAWERS: LOGBOOK  Notes\n"
+                           "#+TODO: TODO(t) NEXT | DONE(d) CANCELED\n"
+                           "#+SEQ_TODO: WAITING FINISHED\n"
+                           "#+TAGS: { @work(w) @home(h) } laptop\n"
+                           "#+FILETAGS: :project:review:\n"
+                           "#+CATEGORY: Tests\n"
+                           "#+CATEGORY: Ignored\n"
+                           "#+PROPERTY: Effort_ALL 0 0:10 0:30\n"
+                           "#+PROPERTY: Effort_ALL+ 1:00\n"
+                           "* Headline\n"
+                           "  :Notes:\n"
+                           "  :END:\n");
+    Parser parser;
+    const auto file = parser.parse(QByteArrayView(input)).dynamicCast<OrgFile>();
+    QVERIFY(file);
+    const FileSettings& settings = file->fileSettings();
+    QCOMPARE(settings.drawerNames(), QStringList() << FL1("PROPERTIES") << FL1("LOGBOOK") << FL1("Notes"));
+    QVERIFY(settings.isDrawerName(FL1("Notes")));
+    QVERIFY(!settings.isDrawerName(FL1("END")));
+    QCOMPARE(settings.todoKeywords(), QStringList() << FL1("TODO") << FL1("NEXT") << FL1("WAITING"));
+    QCOMPARE(settings.doneKeywords(), QStringList() << FL1("DONE") << FL1("CANCELED") << FL1("FINISHED"));
+    QCOMPARE(settings.tags(), QStringList() << FL1("@work") << FL1("@home") << FL1("laptop"));
+    QCOMPARE(settings.fileTags(), QStringList() << FL1("project") << FL1("review"));
+    QCOMPARE(settings.category(), FL1("Tests"));
+    QCOMPARE(settings.properties().count(), 2);
+    QCOMPARE(Properties::propertyValue(FL1("Effort_ALL"), settings.properties()), FL1("0 0:10 0:30 1:00"));
+    //The drawer name from the settings was used while parsing:
+    QCOMPARE(findElements<Drawer>(file).count(), 1);
+    //Defaults:
+    const FileSettings defaults;
+    QCOMPARE(defaults.drawerNames(), QStringList() << FL1("PROPERTIES"));
+    QCOMPARE(defaults.todoKeywords(), QStringList() << FL1("TODO"));
+    QCOMPARE(defaults.doneKeywords(), QStringList() << FL1("DONE"));
+    QVERIFY(defaults.category().isNull());
+    //Attributes use the settings of parsed files, and the attribute lines of files built programmatically:
+    QCOMPARE(Attributes(file).drawerNames(), settings.drawerNames());
+    const OrgFile::Pointer built(new OrgFile);
+    FileAttributeLine::Pointer drawers(new FileAttributeLine(built.data()));
+    drawers->setProperty(Property(FL1("DRAWERS"), FL1("Notes")));
+    built->addChild(drawers);
+    QCOMPARE(Attributes(built).drawerNames(), QStringList() << FL1("PROPERTIES") << FL1("Notes"));
+}
+
+namespace {
+
+QByteArray writeToByteArray(const OrgElement::Pointer& element)
+{
+    QByteArray output;
+    QBuffer outputBuffer(&output);
+    outputBuffer.open(QBuffer::WriteOnly);
+    QTextStream outputStream(&outputBuffer);
+    Writer writer;
+    writer.writeTo(&outputStream, element);
+    outputStream.flush();
+    return output;
+}
+
+}
+
+//Verify that one Parser can be used by many threads at the same time:
+void ParserTests::testConcurrentParsing()
+{
+    QVector<QByteArray> inputs;
+    const QDir testData(FL1(":/TestData/Parser"));
+    for(auto const& name : testData.entryList(QStringList() << FL1("*.org"), QDir::Files)) {
+        QFile file(testData.filePath(name));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        inputs.append(file.readAll());
+    }
+    inputs.append(generateOrgFile(200));
+    const Parser parser;
+    QVector<QByteArray> expected;
+    for(auto const& input : inputs) {
+        expected.append(writeToByteArray(parser.parse(QByteArrayView(input))));
+    }
+    const int threadCount = 16;
+    const int iterations = 20;
+    QVector<int> mismatches(threadCount, 0);
+    QVector<QThread*> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.append(QThread::create([&parser, &inputs, &expected, &mismatches, i]() {
+            for (int iteration = 0; iteration < iterations; ++iteration) {
+                //Start at different files in every thread:
+                for (int j = 0; j < inputs.count(); ++j) {
+                    const int index = (i + j) % inputs.count();
+                    const OrgElement::Pointer element = parser.parse(QByteArrayView(inputs.at(index)));
+                    if (writeToByteArray(element) != expected.at(index)) {
+                        ++mismatches[i];
+                    }
+                }
+            }
+        }));
+    }
+    for(auto thread : threads) {
+        thread->start();
+    }
+    for(auto thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        QCOMPARE(mismatches.at(i), 0);
+    }
+}
+
+//Verify that batches return the results in input order, and report errors per file:
+namespace {
+
+//Counts the headlines of one file:
+class HeadlineCounter : public OrgEventHandler
+{
+public:
+    void onHeadline(int, QStringView, const QStringList&, QStringView) override
+    {
+        ++headlines;
+    }
+
+    int headlines = 0;
+};
+
+}
+
+void ParserTests::testParseBatch()
+{
+    const QDir testData(FL1(":/TestData/Parser"));
+    QStringList fileNames;
+    for(auto const& name : testData.entryList(QStringList() << FL1("*.org"), QDir::Files)) {
+        fileNames << testData.filePath(name);
+    }
+    const QString missing(FL1("/does/not/exist.org"));
+    fileNames.insert(1, missing);
+    const Parser parser;
+    for (int threadCount : { 1, 3, 0 }) {
+        const ParseBatch::Results results = parser.parseFiles(fileNames, threadCount);
+        QCOMPARE(results.count(), fileNames.count());
+        for (int i = 0; i < fileNames.count(); ++i) {
+            const ParseBatch::Result& result = results.at(i);
+            QCOMPARE(result.fileName, fileNames.at(i));
+            if (result.fileName == missing) {
+                QVERIFY(!result.isValid());
+                QVERIFY(!result.error.isEmpty());
+            } else {
+                QVERIFY2(result.isValid(), qPrintable(result.error));
+                QCOMPARE(result.element->describe(), parser.parseFile(fileNames.at(i))->describe());
+            }
+        }
+    }
+    //Parsing for events uses one handler per file:
+    ParseBatch batch(parser);
+    batch.setThreadCount(3);
+    std::vector<HeadlineCounter> counters(fileNames.count());
+    const QStringList errors = batch.parseFiles(fileNames, [&counters](int index) {
+        return &counters[index];
+    });
+    QCOMPARE(errors.count(), fileNames.count());
+    for (int i = 0; i < fileNames.count(); ++i) {
+        QCOMPARE(errors.at(i).isEmpty(), fileNames.at(i) != missing);
+        if (fileNames.at(i) != missing) {
+            QCOMPARE(counters.at(i).headlines, findElements<Headline>(parser.parseFile(fileNames.at(i))).count());
+        }
+    }
+}
+
+void ParserTests::testParallelParsing_data()
+{
+    orgFileInputs_data();
+    QTest::newRow("unclosed drawer before chunk boundary")
+            << QByteArray("* A\n  :PROPERTIES:\n  :ID: 1\n* B\n  :PROPERTIES:\n  :ID: 2\n");
+}
+
+//Verify that splitting files at level 1 headlines and parsing the chunks in parallel does not change the result:
+void ParserTests::testParallelParsing()
+{
+    QFETCH(QByteArray, input);
+
+    const Parser sequential;
+    const OrgElement::Pointer expected = sequential.parse(QByteArrayView(input));
+    Parser parallel;
+    parallel.setParallelParsing(true);
+    //Every level 1 headline starts a chunk:
+    parallel.setChunkSize(1);
+    const OrgElement::Pointer element = parallel.parse(QByteArrayView(input));
+    QCOMPARE(element->describe(), expected->describe());
+    QCOMPARE(writeToByteArray(element), input);
+    QCOMPARE(element.dynamicCast<OrgFile>()->fileSettings().drawerNames(),
+             expected.dynamicCast<OrgFile>()->fileSettings().drawerNames());
+}
+
+namespace {
+
+//Records the events in a form that can be compared with the element tree:
+class EventRecorder : public OrgEventHandler
+{
+public:
+    void onHeadline(int level, QStringView caption, const QStringList&, QStringView line) override
+    {
+        levels.append(level);
+        headlines << QString::fromLatin1("%1 %2").arg(levels.count()).arg(caption.trimmed().toString());
+        record(line);
+    }
+    void onHeadlineEnd(int level) override
+    {
+        QCOMPARE(levels.takeLast(), level);
+    }
+    void onClockLine(const QDateTime&, const QDateTime&, QStringView line) override
+    {
+        ++clockLines;
+        record(line);
+    }
+    void onFileAttribute(const Property&, QStringView line) override
+    {
+        ++fileAttributes;
+        record(line);
+    }
+    void onDrawerBegin(QStringView, QStringView line) override
+    {
+        ++drawers;
+        record(line);
+    }
+    void onDrawerEntry(const Property&, QStringView line) override
+    {
+        ++drawerEntries;
+        record(line);
+    }
+    void onDrawerEnd(QStringView line) override
+    {
+        if (!line.isNull()) {
+            ++drawerEntries;
+            record(line);
+        }
+    }
+    void onLine(QStringView line) override
+    {
+        record(line);
+    }
+
+    void record(QStringView line)
+    {
+        text += line.toUtf8() + '\n';
+    }
+
+    QVector<int> levels;
+    QStringList headlines;
+    int clockLines = 0;
+    int fileAttributes = 0;
+    int drawers = 0;
+    int drawerEntries = 0;
+    QByteArray text;
+};
+
+}
+
+void ParserTests::testEventParsing_data()
+{
+    orgFileInputs_data();
+    QTest::newRow("drawers before the first headline")
+            << QByteArray("#+DRAWERS: Notes\n:Notes:\n:Key: value\n:END:\nText\n* A\n  :Notes:\n");
+}
+
+//Verify that the events describe the same structure as the element tree:
+void ParserTests::testEventParsing()
+{
+    QFETCH(QByteArray, input);
+
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(input));
+    EventRecorder recorder;
+    parser.parse(QByteArrayView(input), &recorder);
+    QVERIFY(recorder.levels.isEmpty());
+    QCOMPARE(recorder.text, writeToByteArray(element));
+    QStringList headlines;
+    for(auto const& headline : findElements<Headline>(element)) {
+        headlines << QString::fromLatin1("%1 %2").arg(headline->level()).arg(headline->caption().trimmed());
+    }
+    QCOMPARE(recorder.headlines, headlines);
+    QCOMPARE(recorder.clockLines, findElements<ClockLine>(element).count());
+    QCOMPARE(recorder.fileAttributes, findElements<FileAttributeLine>(element).count());
+    QCOMPARE(recorder.drawers, findElements<Drawer>(element).count());
+    QCOMPARE(recorder.drawerEntries, findElements<DrawerEntry>(element).count());
+}
+
+namespace {
+
+//Collect the outline of a lazily parsed file, without parsing the sections of the headlines:
+void collectOutline(const Headline::List& headlines, QStringList* outline)
+{
+    for(auto const& headline : headlines) {
+        *outline << QString::fromLatin1("%1 %2").arg(headline->level()).arg(headline->caption());
+        collectOutline(headline->headlines(), outline);
+    }
+}
+
+}
+
+void ParserTests::testLazyParsing_data()
+{
+    orgFileInputs_data();
+    QTest::newRow("sections with drawers and clocks")
+            << QByteArray("* A\n"
+                          "  :LOGBOOK:\n"
+                          "  CLOCK: [2015-03-26 Thu 10:00]--[2015-03-26 Thu 10:30] =>  0:30\n"
+                          "  :END:\n"
+                          "  CLOCK: [2015-03-27 Fri 09:00]--[2015-03-27 Fri 09:45] =>  0:45\n"
+                          "  :PROPERTIES:\n"
+                          "  :ID: 1\n"
+                          "  :END:\n"
+                          "** A1\n"
+                          "  CLOCK: [2015-03-28 Sat 09:00]\n"
+                          "  :LOGBOOK:\n"
+                          "* B\n"
+                          "  Text\n");
+}
+
+//Verify that parsing the sections of headlines on first access does not change the result:
+void ParserTests::testLazyParsing()
+{
+    QFETCH(QByteArray, input);
+
+    const Parser parser;
+    const OrgElement::Pointer expected = parser.parse(QByteArrayView(input));
+    Parser lazy;
+    lazy.setLazyParsing(true);
+    OrgElement::Pointer element;
+    {
+        //The lazily parsed headlines do not refer to the buffer:
+        QByteArray buffer = input;
+        element = lazy.parse(QByteArrayView(buffer));
+        buffer.fill('x');
+    }
+    Headline::List topLevel;
+    for(auto const& child : element->children()) {
+        if (auto const headline = child.dynamicCast<Headline>()) {
+            topLevel.append(headline);
+        }
+    }
+    QStringList outline;
+    collectOutline(topLevel, &outline);
+    QStringList expectedOutline;
+    for(auto const& headline : findElements<Headline>(expected)) {
+        expectedOutline << QString::fromLatin1("%1 %2").arg(headline->level()).arg(headline->caption());
+    }
+    QCOMPARE(outline, expectedOutline);
+    //Walking the outline did not parse the sections, which are the children before the first sub-headline:
+    const Headline::List expectedTopLevel = findElements<Headline>(expected, 1);
+    QCOMPARE(topLevel.count(), expectedTopLevel.count());
+    for (int i = 0; i < topLevel.count(); ++i) {
+        const OrgElement::List children = expectedTopLevel.at(i)->children();
+        const bool hasSection = !children.isEmpty() && children.first().dynamicCast<Headline>().isNull();
+        QCOMPARE(topLevel.at(i)->hasLazyChildren(), hasSection);
+    }
+    QCOMPARE(element->describe(), expected->describe());
+    QCOMPARE(writeToByteArray(element), input);
+    for(auto const& headline : topLevel) {
+        QVERIFY(!headline->hasLazyChildren());
+    }
+}
+
+//Verify that editing a line only replaces the subtree that contains it:
+void ParserTests::testReparse()
+{
+    const QByteArray input("#+DRAWERS: LOGBOOK\n* A\n** A1\nText\n** A2\n* B\n  :LOGBOOK:\n  :END:\n");
+    const Parser parser;
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(input)).dynamicCast<OrgFile>();
+    QVERIFY(file);
+    const OrgElement::List before = file->children();
+    const Headline::Pointer a = before.at(1).dynamicCast<Headline>();
+    QVERIFY(a);
+    const OrgElement::Pointer a1 = a->children().at(0);
+    const OrgElement::Pointer a2 = a->children().at(1);
+    const PropertyIndex index(file);
+    QVERIFY(!index.isStale());
+    //Line 3 is the text of A1, the new subtree is A1:
+    const OrgElement::Pointer replaced = parser.reparse(file, 3, 1, FL1("Other text"));
+    QCOMPARE(replaced.dynamicCast<Headline>()->caption(), FL1("A1"));
+    QCOMPARE(replaced->parent(), static_cast<OrgElement*>(a.data()));
+    QCOMPARE(replaced->childIndex(), 0);
+    //The old subtree is detached, and indexes of the file are stale:
+    QVERIFY(!a1->parent());
+    QCOMPARE(a1->childIndex(), -1);
+    QCOMPARE(a1->level(), 0);
+    QVERIFY(index.isStale());
+    try {
+        index.resolve(a2.data(), FL1("ID"), nullptr);
+        QFAIL("A stale index must not be queried");
+    } catch (const RuntimeException&) {
+    }
+    QCOMPARE(file->children(), before);
+    QCOMPARE(a->children().at(1), a2);
+    QCOMPARE(writeToByteArray(file),
+             QByteArray("#+DRAWERS: LOGBOOK\n* A\n** A1\nOther text\n** A2\n* B\n  :LOGBOOK:\n  :END:\n"));
+    //Turning A2 into a level 1 headline changes the structure of A:
+    parser.reparse(file, 4, 1, FL1("* A2"));
+    QCOMPARE(file->describe(), parser.parse(QByteArrayView(writeToByteArray(file)))->describe());
+    QCOMPARE(findElements<Headline>(file, 1).count(), 3);
+    //Removing the drawer declaration reparses the whole file:
+    QCOMPARE(parser.reparse(file, 0, 1, QString()), file.staticCast<OrgElement>());
+    QVERIFY(findElements<Drawer>(file).isEmpty());
+    try {
+        parser.reparse(file, 5, 10, QString());
+        QFAIL("Lines outside of the file must be rejected");
+    } catch (const RuntimeException&) {
+    }
+}
+
+//Verify that random edits give the same element tree as parsing the edited file:
+void ParserTests::testRandomReparse()
+{
+    const QStringList pool = QStringList()
+            << FL1("* Level 1") << FL1("** Level 2 :tag:") << FL1("*** Level 3") << FL1("Text") << FL1("")
+            << FL1("  :PROPERTIES:") << FL1("  :LOGBOOK:") << FL1("  :ID: 42") << FL1("  :END:")
+            << FL1("  CLOCK: [2015-03-26 Thu 10:00]--[2015-03-26 Thu 10:30] =>  0:30") << FL1("#+DRAWERS: NOTES");
+    QStringList lines = QString::fromUtf8(generateOrgFile(30)).split(QLatin1Char('\n'));
+    lines.removeLast();
+    const Parser parser;
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(lines.join(QLatin1Char('\n')).toUtf8() + '\n'))
+            .dynamicCast<OrgFile>();
+    QRandomGenerator random(42);
+    for (int i = 0; i < 500; ++i) {
+        const int firstLine = random.bounded(int(lines.count()) + 1);
+        const int lineCount = random.bounded(qMin(3, int(lines.count()) - firstLine) + 1);
+        QStringList newLines;
+        for (int j = random.bounded(3); j > 0; --j) {
+            newLines << pool.at(random.bounded(int(pool.count())));
+        }
+        parser.reparse(file, firstLine, lineCount, newLines.join(QLatin1Char('\n')));
+        for (int j = 0; j < lineCount; ++j) {
+            lines.removeAt(firstLine);
+        }
+        for (int j = 0; j < newLines.count(); ++j) {
+            lines.insert(firstLine + j, newLines.at(j));
+        }
+        QByteArray expected;
+        for(auto const& line : lines) {
+            expected += line.toUtf8() + '\n';
+        }
+        QCOMPARE(writeToByteArray(file), expected);
+        QCOMPARE(file->describe(), parser.parse(QByteArrayView(expected))->describe());
+    }
+}
+
+//Verify that cached files are loaded as they were parsed, and that stale entries are never used:
+void ParserTests::testParseCache()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const ParseCache cache(directory.filePath(FL1("cache")));
+    const Parser parser;
+    const QString fileName = directory.filePath(FL1("test.org"));
+    auto const write = [&fileName](const QByteArray& content) {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    };
+    const QByteArray content = generateOrgFile(20) + generateUnclosedDrawers(5);
+    write(content);
+    const OrgElement::Pointer parsed = cache.parseFile(parser, fileName);
+    QCOMPARE(QDir(cache.directory()).entryList(QDir::Files).count(), 1);
+    const OrgElement::Pointer loaded = cache.parseFile(parser, fileName);
+    QVERIFY(loaded != parsed);
+    QCOMPARE(loaded->describe(), parsed->describe());
+    QCOMPARE(writeToByteArray(loaded), content);
+    QCOMPARE(loaded.dynamicCast<OrgFile>()->fileSettings().drawerNames(),
+             parsed.dynamicCast<OrgFile>()->fileSettings().drawerNames());
+    //A change that keeps the size and the modification time is detected by the content hash:
+    const QDateTime modified = QFileInfo(fileName).lastModified();
+    QByteArray changed = content;
+    changed.replace("Headline 1\t", "Headline X\t");
+    QCOMPARE(changed.size(), content.size());
+    write(changed);
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+    QCOMPARE(QFileInfo(fileName).lastModified(), modified);
+    QCOMPARE(writeToByteArray(cache.parseFile(parser, fileName)), changed);
+    //Other changes:
+    write(content + "* New headline\n");
+    QCOMPARE(writeToByteArray(cache.parseFile(parser, fileName)), content + "* New headline\n");
+    write(content);
+    QCOMPARE(writeToByteArray(cache.parseFile(parser, fileName)), content);
+    //A batch loads its files from the cache:
+    const QString otherName = directory.filePath(FL1("other.org"));
+    {
+        QFile file(otherName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    }
+    ParseBatch batch(parser);
+    batch.setCache(&cache);
+    const ParseBatch::Results results = batch.parseFiles(QStringList() << fileName << otherName);
+    QCOMPARE(results.count(), 2);
+    for(auto const& result : results) {
+        QVERIFY(result.isValid());
+        QCOMPARE(writeToByteArray(result.element), content);
+    }
+    QCOMPARE(QDir(cache.directory()).entryList(QDir::Files).count(), 2);
+}
+
+void ParserTests::testBinaryFormat_data()
+{
+    orgFileInputs_data();
+    QTest::newRow("empty file") << QByteArray();
+    QTest::newRow("long line") << "* A\n" + QByteArray(70000, 'x') + "\n";
+    QTest::newRow("deep headline") << QByteArray(300, '*') + " Deep\t:tag:\n";
+    QTest::newRow("non-ASCII text")
+            << QByteArray("* \xc3\x9c""berschrift\t:gr\xc3\xbc\xc3\x9f""e:\n  \xe6\x97\xa5\xe6\x9c\xac\n");
+    QTest::newRow("clock times at the ends of the range")
+            << QByteArray("* A\n  CLOCK: [1970-01-01 Thu 00:00]--[2038-01-19 Tue 03:14] => 596523:14\n");
+}
+
+//Verify that serialized element trees are restored exactly, and can be read in place:
+void ParserTests::testBinaryFormat()
+{
+    QFETCH(QByteArray, input);
+
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(input), FL1("test.org"));
+    const QByteArray data = BinaryFormat::serialize(element);
+    const OrgElement::Pointer restored = BinaryFormat::deserialize(QByteArrayView(data));
+    QCOMPARE(restored->describe(), element->describe());
+    QCOMPARE(writeToByteArray(restored), input);
+    const OrgFile::Pointer file = restored.dynamicCast<OrgFile>();
+    QVERIFY(file);
+    QCOMPARE(file->fileName(), FL1("test.org"));
+    QCOMPARE(file->fileSettings().attributes(), element.dynamicCast<OrgFile>()->fileSettings().attributes());
+    QCOMPARE(file->fileSettings().drawerNames(), element.dynamicCast<OrgFile>()->fileSettings().drawerNames());
+    auto const clockLines = findElements<CompletedClockLine>(element);
+    auto const restoredClockLines = findElements<CompletedClockLine>(restored);
+    QCOMPARE(restoredClockLines.count(), clockLines.count());
+    for (int i = 0; i < clockLines.count(); ++i) {
+        QCOMPARE(restoredClockLines.at(i)->startTime(), clockLines.at(i)->startTime());
+        QCOMPARE(restoredClockLines.at(i)->endTime(), clockLines.at(i)->endTime());
+    }
+    auto const entries = findElements<DrawerEntry>(element);
+    auto const restoredEntries = findElements<DrawerEntry>(restored);
+    QCOMPARE(restoredEntries.count(), entries.count());
+    for (int i = 0; i < entries.count(); ++i) {
+        QCOMPARE(restoredEntries.at(i)->property(), entries.at(i)->property());
+    }
+    //Read the headlines in place, in preorder:
+    const BinaryDocument document(data);
+    QCOMPARE(document.nodeCount(), findElements<OrgElement>(element).count());
+    const Headline::List headlines = findElements<Headline>(element);
+    int headline = 0;
+    for (int node = 0; node < document.nodeCount(); ++node) {
+        if (document.type(node) == BinaryFormat::HeadlineNode) {
+            QVERIFY(headline < headlines.count());
+            QCOMPARE(document.caption(node), headlines.at(headline)->caption());
+            QCOMPARE(document.tags(node).count(), int(headlines.at(headline)->tags().size()));
+            ++headline;
+        }
+    }
+    QCOMPARE(headline, headlines.count());
+    int children = 0;
+    for (int child = document.firstChild(0); child >= 0; child = document.nextSibling(child)) {
+        QCOMPARE(document.parent(child), 0);
+        ++children;
+    }
+    QCOMPARE(children, element->children().count());
+}
+
+//Verify that invalid data is rejected:
+void ParserTests::testInvalidBinaryData()
+{
+    const Parser parser;
+    const QByteArray data = BinaryFormat::serialize(parser.parse(QByteArrayView(generateOrgFile(10))));
+    QVERIFY(!BinaryFormat::deserialize(QByteArrayView(data)).isNull());
+    const QList<QByteArray> invalid = QList<QByteArray>()
+            << QByteArray()
+            << QByteArray("Not an OrgModeParser file")
+            << data.left(data.size() / 2)
+            << QByteArray(data).replace(4, 1, QByteArray(1, char(BinaryFormat::Version + 1)))
+            //The parent of the second node:
+            << QByteArray(data).replace(BinaryFormat::HeaderSize + BinaryFormat::NodeSize + 4, 1, QByteArray(1, 7));
+    for(auto const& bytes : invalid) {
+        try {
+            BinaryFormat::deserialize(QByteArrayView(bytes));
+            QFAIL("Invalid data must be rejected");
+        } catch (const RuntimeException&) {
+        }
+    }
+}
+
+//Verify that elements allocated in an arena keep it alive, and that parse results are not affected:
+void ParserTests::testArenaAllocation()
+{
+    const QByteArray input = generateOrgFile(200) + generateUnclosedDrawers(20);
+    const Parser parser;
+    const OrgElement::Pointer expected = parser.parse(QByteArrayView(input));
+    Parser arenaParser;
+    arenaParser.setArenaAllocation(true);
+    arenaParser.setParallelParsing(true);
+    arenaParser.setChunkSize(1024);
+    OrgElement::Pointer element = arenaParser.parse(QByteArrayView(input));
+    QVERIFY(!Arena::current());
+    QCOMPARE(element->describe(), expected->describe());
+    QCOMPARE(writeToByteArray(element), input);
+    //Elements stay valid after the rest of the parse result has been destroyed:
+    const Headline::Pointer headline = findElements<Headline>(element).last();
+    element.reset();
+    QCOMPARE(headline->caption(), findElements<Headline>(expected).last()->caption());
+    QCOMPARE(headline->children().count(), findElements<Headline>(expected).last()->children().count());
+    //Elements are only allocated in an arena while a scope is active:
+    Arena* arena = new Arena(256);
+    {
+        const Arena::Scope scope(arena);
+        QCOMPARE(Arena::current(), arena);
+        const OrgElement::Pointer line(new OrgLine(FL1("A line")));
+        //The line and the private data of OrgElement:
+        QCOMPARE(arena->allocationCount(), 2);
+        QCOMPARE(Arena::owner(line.data()), arena);
+        {
+            const Arena::Scope heap(nullptr);
+            const OrgElement::Pointer other(new OrgLine(FL1("Another line")));
+            QCOMPARE(arena->allocationCount(), 2);
+            QVERIFY(!Arena::owner(other.data()));
+        }
+        //Parsers without arena allocation do not use the arena of the caller:
+        const OrgElement::Pointer parsed = parser.parse(QByteArrayView(input));
+        QCOMPARE(arena->allocationCount(), 2);
+        QVERIFY(!Arena::owner(parsed.data()));
+        QCOMPARE(Arena::current(), arena);
+        //Lazy sections and reparsed elements are not allocated in the arena of the caller:
+        Parser lazyParser;
+        lazyParser.setLazyParsing(true);
+        lazyParser.setArenaAllocation(true);
+        const OrgFile::Pointer file = lazyParser.parse(QByteArrayView(input)).dynamicCast<OrgFile>();
+        QVERIFY(file);
+        QCOMPARE(arena->allocationCount(), 2);
+        Headline::Pointer lazy;
+        for (auto const& child : file->children()) {
+            if ((lazy = child.dynamicCast<Headline>())) {
+                break;
+            }
+        }
+        QVERIFY(lazy && lazy->hasLazyChildren());
+        QVERIFY(!lazy->children().isEmpty());
+        QVERIFY(!lazy->hasLazyChildren());
+        QCOMPARE(arena->allocationCount(), 2);
+        //The text of the first headline:
+        lazyParser.reparse(file, 13, 1, FL1("   Other text"));
+        QCOMPARE(arena->allocationCount(), 2);
+        QCOMPARE(Arena::current(), arena);
+    }
+    QVERIFY(!Arena::current());
+}
+
+void ParserTests::testCompactDocument_data()
+{
+    orgFileInputs_data();
+    QTest::newRow("open drawers")
+            << QByteArray("* A\n"
+                          "  :PROPERTIES:\n"
+                          "  :ID: 1\n"
+                          "** A1\n"
+                          "  :LOGBOOK:\n"
+                          "  CLOCK: [2015-03-26 Thu 10:00]--[2015-03-26 Thu 10:30] =>  0:30\n"
+                          "* B\n"
+                          "  :LOGBOOK:\n"
+                          "  CLOCK: [2015-03-27 Fri 09:00]\n");
+}
+
+//Verify that compact documents are identical when parsed or converted, and that queries match the element tree:
+void ParserTests::testCompactDocument()
+{
+    QFETCH(QByteArray, input);
+
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(input), FL1("test.org"));
+    const CompactDocument converted(element);
+    const CompactDocument parsed = parser.parseCompact(QByteArrayView(input), FL1("test.org"));
+    const OrgElement::List elements = findElements<OrgElement>(element);
+    QCOMPARE(converted.nodeCount(), elements.count());
+    QCOMPARE(parsed.nodeCount(), converted.nodeCount());
+    for (int node = 0; node < converted.nodeCount(); ++node) {
+        QCOMPARE(int(parsed.type(node)), int(converted.type(node)));
+        QCOMPARE(parsed.parent(node), converted.parent(node));
+        QCOMPARE(parsed.subtreeEnd(node), converted.subtreeEnd(node));
+        QCOMPARE(parsed.depth(node), elements.at(node)->level());
+        QCOMPARE(converted.depth(node), elements.at(node)->level());
+        if (node > 0) {
+            QCOMPARE(parsed.line(node).toString(), elements.at(node)->line());
+        }
+    }
+    for (const CompactDocument* document : {&converted, &parsed}) {
+        const OrgElement::Pointer restored = document->toElement();
+        QCOMPARE(restored->describe(), element->describe());
+        QCOMPARE(writeToByteArray(restored), input);
+        QCOMPARE(restored.dynamicCast<OrgFile>()->fileSettings().attributes(),
+                 element.dynamicCast<OrgFile>()->fileSettings().attributes());
+        QCOMPARE(document->name(0).toString(), FL1("test.org"));
+    }
+    //Clock times, in open and bounded intervals:
+    const QList<TimeInterval> intervals = QList<TimeInterval>()
+            << TimeInterval()
+            << TimeInterval(QDate(2015, 3, 27), QDate(2015, 3, 28))
+            << TimeInterval(QDateTime(QDate(2015, 3, 26), QTime(10, 15)), QDateTime());
+    for (const TimeInterval& interval : intervals) {
+        QCOMPARE(parsed.duration(0, interval), Clock(element).duration(interval));
+    }
+    auto const headlines = findElements<Headline>(element);
+    const QVector<int> nodes = parsed.findNodes(BinaryFormat::HeadlineNode);
+    QCOMPARE(nodes.count(), headlines.count());
+    for (int i = 0; i < nodes.count(); ++i) {
+        QCOMPARE(parsed.caption(nodes.at(i)).toString(), headlines.at(i)->caption());
+        QCOMPARE(parsed.tags(nodes.at(i)).count(), int(headlines.at(i)->tags().size()));
+        for (const QString& tag : headlines.at(i)->tags()) {
+            QVERIFY(parsed.hasTag(nodes.at(i), tag));
+        }
+        for (const TimeInterval& interval : intervals) {
+            QCOMPARE(parsed.itemDuration(nodes.at(i), interval), Clock(headlines.at(i)).itemDuration(interval));
+            QCOMPARE(parsed.duration(nodes.at(i), interval), Clock(headlines.at(i)).duration(interval));
+        }
+    }
+    auto const isTODO = [&parsed](int node) { return parsed.caption(node).startsWith(QLatin1String("TODO")); };
+    auto const isTODOHeadline = [](const Headline::Pointer& headline) {
+        return headline->caption().startsWith(QLatin1String("TODO"));
+    };
+    QCOMPARE(parsed.findNodes(BinaryFormat::HeadlineNode, isTODO).count(),
+             findElements<Headline>(element, isTODOHeadline).count());
+}
+
+//Verify that element_cast finds the same elements as a dynamic cast:
+template <typename T>
+void verifyElementCast(const OrgElement::List& elements)
+{
+    int count = 0;
+    for (auto const& element : elements) {
+        QCOMPARE(element_cast<T>(element).data(), element.dynamicCast<T>().data());
+        QCOMPARE(element_cast<T>(element.data()), dynamic_cast<T*>(element.data()));
+        if (element_cast<T>(element)) {
+            ++count;
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void ParserTests::testElementCast()
+{
+    const QByteArray input = generateOrgFile(10) + "* Incomplete\n  CLOCK: [2015-03-27 Fri 10:00]\n";
+    const Parser parser;
+    const OrgElement::Pointer element = parser.parse(QByteArrayView(input));
+    const OrgElement::List elements = findElements<OrgElement>(element);
+    verifyElementCast<OrgFile>(elements);
+    verifyElementCast<Headline>(elements);
+    verifyElementCast<OrgLine>(elements);
+    verifyElementCast<ClockLine>(elements);
+    verifyElementCast<CompletedClockLine>(elements);
+    verifyElementCast<Drawer>(elements);
+    verifyElementCast<PropertyDrawer>(elements);
+    verifyElementCast<AttributeLine>(elements);
+    verifyElementCast<FileAttributeLine>(elements);
+    verifyElementCast<DrawerEntry>(elements);
+    verifyElementCast<PropertyDrawerEntry>(elements);
+    QCOMPARE(int(element->kind()), int(OrgElement::OrgFileKind));
+    QVERIFY(element->isKindOf(OrgElement::OrgElementKind));
+    //The closing entries of the two drawers of every headline:
+    auto const closingEntries = findElements<DrawerClosingEntry>(element);
+    QCOMPARE(closingEntries.count(), 20);
+    for (auto const& entry : closingEntries) {
+        QCOMPARE(int(entry->kind()), int(OrgElement::DrawerClosingEntryKind));
+        QVERIFY(entry->isKindOf(OrgElement::DrawerEntryKind));
+        QVERIFY(entry->isKindOf(OrgElement::AttributeLineKind));
+        QVERIFY(!entry->isKindOf(OrgElement::PropertyDrawerEntryKind));
+        QVERIFY(!element_cast<Headline>(entry.data()));
+        QCOMPARE(entry->line().trimmed(), FL1(":END:"));
+    }
+}
+
+//Verify that the levels of elements are updated when elements and their subtrees are moved:
+void ParserTests::testElementLevels()
+{
+    auto const verifyLevels = [](const OrgElement::Pointer& root) {
+        for (auto const& element : findElements<OrgElement>(root)) {
+            int level = 0;
+            for (const OrgElement* parent = element->parent(); parent; parent = parent->parent()) {
+                ++level;
+            }
+            QCOMPARE(element->level(), level);
+        }
+    };
+    for (const bool lazy : {false, true}) {
+        Parser parser;
+        parser.setLazyParsing(lazy);
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(generateOrgFile(20)));
+        verifyLevels(element);
+        //Headline 0 contains headline 1, which contains headline 2. Move it below headline 5, a level 3 headline:
+        OrgElement::List children = element->children();
+        //Collect the headlines without loading the sections of lazily parsed headlines:
+        Headline::List headlines;
+        std::function<void(const Headline::List&)> collect = [&headlines, &collect](const Headline::List& outline) {
+            for (auto const& headline : outline) {
+                headlines.append(headline);
+                collect(headline->headlines());
+            }
+        };
+        Headline::List topLevel;
+        for (auto const& child : children) {
+            if (auto const headline = element_cast<Headline>(child)) {
+                topLevel.append(headline);
+            }
+        }
+        collect(topLevel);
+        const Headline::Pointer moved = headlines.at(0);
+        QCOMPARE(headlines.at(5)->level(), 3);
+        children.removeOne(moved);
+        element->setChildren(children);
+        headlines.at(5)->addChild(moved);
+        QCOMPARE(moved->level(), 4);
+        QCOMPARE(headlines.at(2)->level(), 6);
+        verifyLevels(element);
+        //Detach the subtree:
+        moved->setParent(nullptr);
+        QCOMPARE(moved->level(), 0);
+        QCOMPARE(headlines.at(1)->level(), 1);
+        verifyLevels(moved);
+    }
+}
+
+//Collect the elements of the subtree of element in preorder and postorder, using children():
+void collectElements(const OrgElement::Pointer& element, OrgElement::List* preorder, OrgElement::List* postorder)
+{
+    preorder->append(element);
+    for (auto const& child : element->children()) {
+        collectElements(child, preorder, postorder);
+    }
+    postorder->append(element);
+}
+
+//Verify that the traversal ranges visit the same elements as a recursive walk over the children:
+void ParserTests::testTraversal()
+{
+    for (const bool lazy : {false, true}) {
+        Parser parser;
+        parser.setLazyParsing(lazy);
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(generateOrgFile(20)));
+        OrgElement::List preorderRange;
+        for (auto const& current : preorder(element)) {
+            preorderRange.append(current);
+        }
+        OrgElement::List postorderRange;
+        for (auto const& current : postorder(element)) {
+            postorderRange.append(current);
+        }
+        OrgElement::List expectedPreorder;
+        OrgElement::List expectedPostorder;
+        collectElements(element, &expectedPreorder, &expectedPostorder);
+        QCOMPARE(preorderRange, expectedPreorder);
+        QCOMPARE(postorderRange, expectedPostorder);
+        for (auto const& current : expectedPreorder) {
+            const OrgElement::List children = current->children();
+            const OrgElement::ChildSpan span = current->childSpan();
+            QCOMPARE(span.size(), children.count());
+            for (int index = 0; index < span.size(); ++index) {
+                QCOMPARE(span.at(index), children.at(index));
+                QCOMPARE(span.at(index)->childIndex(), index);
+            }
+        }
+        //Subtrees of a headline:
+        const Headline::Pointer headline = findElements<Headline>(element).at(3);
+        OrgElement::List subtree;
+        for (auto const& current : preorder(headline)) {
+            subtree.append(current);
+        }
+        QCOMPARE(subtree, findElements<OrgElement>(headline));
+        QCOMPARE(postorder(headline).begin()->data(), findElements<OrgElement>(headline).value(2).data());
+        //Skip the content of the headlines, this visits only the file, its lines and the top level headlines:
+        const PreorderRange range(element);
+        OrgElement::List skipped;
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            skipped.append(*it);
+            if ((*it)->isKindOf(OrgElement::HeadlineKind)) {
+                it.skipSubtree();
+            }
+        }
+        QCOMPARE(skipped, findElements<OrgElement>(element, 1));
+    }
+    //An empty range:
+    QVERIFY(preorder(OrgElement::Pointer()).begin() == preorder(OrgElement::Pointer()).end());
+}
+
+void ParserTests::testSourceText()
+{
+    //Null and empty text are different, but equal, as for QString:
+    QVERIFY(SourceText().isNull());
+    QVERIFY(SourceText(QString()).toString().isNull());
+    QVERIFY(!SourceText(FL1("")).isNull());
+    QVERIFY(!SourceText(FL1("")).toString().isNull());
+    QVERIFY(SourceText() == SourceText(FL1("")));
+    QVERIFY(SourceText(FL1("text")) == SourceText(QByteArray("some text"), 5, 4));
+    QCOMPARE(SourceText(QByteArray("some text"), 5, 4).toString(), FL1("text"));
+
+    const QByteArray data("* Überschrift ünd mehr\t:tag:\n:PROPERTIES:\n:Schlüssel+: Wert ä\n:END:\n\n"
+                          "* Invalid \xff caption\n");
+    for (const bool lazy : {false, true}) {
+        Parser parser;
+        parser.setLazyParsing(lazy);
+        const OrgElement::Pointer element = parser.parse(QByteArrayView(data));
+        const Headline::List headlines = findElements<Headline>(element);
+        QCOMPARE(headlines.count(), 2);
+        //The caption is a slice of the line of the headline, which is a slice of the source:
+        const Headline::Pointer headline = headlines.at(0);
+        QCOMPARE(headline->caption(), QString::fromUtf8("Überschrift ünd mehr"));
+        QCOMPARE(headline->captionView().toString(), headline->caption());
+        const QUtf8StringView line = headline->lineView();
+        QVERIFY(headline->captionView().data() > line.data());
+        QVERIFY(headline->captionView().data() < line.data() + line.size());
+        QCOMPARE(headline->line(), QString::fromUtf8("* Überschrift ünd mehr\t:tag:"));
+        auto const entries = findElements<PropertyDrawerEntry>(element);
+        QCOMPARE(entries.count(), 1);
+        const Property property = entries.at(0)->property();
+        QCOMPARE(property.key(), QString::fromUtf8("Schlüssel"));
+        QCOMPARE(property.value(), QString::fromUtf8("Wert ä"));
+        QCOMPARE(property.keyView().toString(), property.key());
+        QCOMPARE(int(property.operation()), int(Property::Property_Add));
+        //Empty lines are not null:
+        auto const lines = findElements<OrgLine>(element);
+        QVERIFY(std::any_of(lines.begin(), lines.end(), [](const OrgLine::Pointer& line) {
+            return line->line().isEmpty() && !line->line().isNull() && line->isValid();
+        }));
+        //Invalid UTF-8 is decoded like before, the caption is copied:
+        QCOMPARE(headlines.at(1)->caption(), QString::fromUtf8("Invalid \xff caption"));
+        QCOMPARE(headlines.at(1)->line(), QString::fromUtf8("* Invalid \xff caption"));
+    }
+    //Lines that are set as strings keep their own copy:
+    Headline headline;
+    headline.setLine(FL1("* Copy"));
+    headline.setCaption(FL1("Copy"));
+    QCOMPARE(headline.line(), FL1("* Copy"));
+    QCOMPARE(headline.captionView().toString(), FL1("Copy"));
+    QVERIFY(OrgLine().line().isNull());
+}
+
+void ParserTests::testAtomTable()
+{
+    AtomTable table;
+    QCOMPARE(table.intern(QString()), AtomTable::InvalidAtom);
+    const AtomTable::Atom work = table.intern(FL1("work"));
+    const AtomTable::Atom home = table.intern(FL1("home"));
+    QVERIFY(work != home);
+    QCOMPARE(table.intern(FL1("work")), work);
+    QCOMPARE(table.find(FL1("home")), home);
+    QCOMPARE(table.find(FL1("none")), AtomTable::InvalidAtom);
+    QCOMPARE(table.string(home), FL1("home"));
+    QCOMPARE(table.sourceText(home).toString(), FL1("home"));
+    QCOMPARE(table.size(), 2);
+
+    //The elements of a parse result share the table of the document, in every parse mode:
+    const QByteArray data = generateOrgFile(20);
+    for (const QString mode : {FL1("sequential"), FL1("lazy"), FL1("parallel")}) {
+        Parser parser;
+        parser.setLazyParsing(mode == FL1("lazy"));
+        parser.setParallelParsing(mode == FL1("parallel"));
+        parser.setChunkSize(64);
+        const OrgFile::Pointer file = parser.parse(QByteArrayView(data)).dynamicCast<OrgFile>();
+        QVERIFY(file);
+        const AtomTable::Pointer atoms = file->atomTable();
+        QVERIFY(atoms != AtomTable::current());
+        const AtomTable::Atom workTag = atoms->find(FL1("work"));
+        QVERIFY(workTag != AtomTable::InvalidAtom);
+        const Headline::List headlines = findElements<Headline>(file);
+        QCOMPARE(headlines.count(), 20);
+        for (auto const& headline : headlines) {
+            QCOMPARE(headline->atomTable(), atoms);
+            QVERIFY(headline->hasTag(workTag));
+            QVERIFY(headline->hasTag(FL1("work")));
+            QVERIFY(!headline->hasTag(FL1("home")));
+            QCOMPARE(int(headline->tagAtoms().count()), 2);
+        }
+        const AtomTable::Atom logbook = atoms->find(FL1("LOGBOOK"));
+        for (auto const& drawer : findElements<Drawer>(file)) {
+            QCOMPARE(drawer->atomTable(), atoms);
+            QVERIFY(drawer->nameAtom() == logbook || drawer->name() == FL1("PROPERTIES"));
+        }
+        const AtomTable::Atom id = atoms->find(FL1("ID"));
+        int ids = 0;
+        for (auto const& entry : findElements<PropertyDrawerEntry>(file)) {
+            ids += entry->keyAtom() == id ? 1 : 0;
+        }
+        QCOMPARE(ids, 20);
+        QCOMPARE(Properties(headlines.at(3)).property(FL1("ID")), FL1("3"));
+        //Reparsed elements are part of the same document:
+        const qsizetype offset = data.indexOf("** TODO Headline 4");
+        const int line = int(data.left(offset).count('\n'));
+        const OrgElement::Pointer reparsed = parser.reparse(file, line, 1, FL1("** TODO Headline 4\t:home:"));
+        const Headline::Pointer headline = element_cast<Headline>(reparsed);
+        QVERIFY(headline);
+        QCOMPARE(headline->atomTable(), atoms);
+        QVERIFY(headline->hasTag(atoms->find(FL1("home"))));
+    }
+    //Elements that are created outside of a file use a table of their tree:
+    Headline headline;
+    headline.setTags(Headline::Tags{FL1("b"), FL1("a")});
+    headline.addTag(FL1("a"));
+    QVERIFY(headline.atomTable());
+    QVERIFY(headline.atomTable() != Headline().atomTable());
+    QCOMPARE(headline.tags(), (Headline::Tags{FL1("a"), FL1("b")}));
+    headline.removeTag(FL1("b"));
+    QVERIFY(headline.hasTag(FL1("a")));
+    QVERIFY(!headline.hasTag(FL1("b")));
+    QCOMPARE(int(headline.tagAtoms().count()), 1);
+    //Their atoms move to the table of the file they are added to:
+    const Headline::Pointer detached(new Headline);
+    detached->setTags(Headline::Tags{FL1("x"), FL1("y")});
+    const Drawer::Pointer drawer(new Drawer(detached.data()));
+    drawer->setName(FL1("NOTES"));
+    detached->addChild(drawer);
+    const OrgFile::Pointer file(new OrgFile);
+    file->atomTable()->intern(FL1("y"));
+    file->addChild(detached);
+    QCOMPARE(detached->atomTable(), file->atomTable());
+    QCOMPARE(drawer->atomTable(), file->atomTable());
+    QCOMPARE(detached->tags(), (Headline::Tags{FL1("x"), FL1("y")}));
+    QVERIFY(detached->hasTag(file->atomTable()->find(FL1("x"))));
+    QVERIFY(detached->hasTag(file->atomTable()->find(FL1("y"))));
+    QCOMPARE(drawer->nameAtom(), file->atomTable()->find(FL1("NOTES")));
+    QCOMPARE(drawer->name(), FL1("NOTES"));
+    //Removing them from the file keeps their strings:
+    file->setChildren(OrgElement::List());
+    QVERIFY(detached->atomTable() != file->atomTable());
+    QVERIFY(detached->hasTag(FL1("y")));
+    QCOMPARE(drawer->name(), FL1("NOTES"));
+}
+
+void ParserTests::testTagSets()
+{
+    TagSet first;
+    first.insert(1);
+    first.insert(70);
+    first.insert(200);
+    TagSet second;
+    second.insert(1);
+    second.insert(2);
+    QVERIFY(first.contains(70));
+    QVERIFY(!first.contains(71));
+    QVERIFY(!first.contains(AtomTable::InvalidAtom));
+    QCOMPARE(first.count(), 3);
+    QCOMPARE((first | second).count(), 4);
+    QCOMPARE((first & second).atoms(), QVector<AtomTable::Atom>() << 1);
+    QCOMPARE((first - second).atoms(), QVector<AtomTable::Atom>() << 70 << 200);
+    QVERIFY(first.intersects(second));
+    QVERIFY(!first.containsAll(second));
+    QVERIFY((first | second).containsAll(first));
+    first.remove(200);
+    first.remove(70);
+    first.insert(2);
+    QVERIFY(first == second);
+    QVERIFY((first - second).isEmpty());
+
+    const QByteArray data("#+FILETAGS: :project:\n"
+                          "* Work\t:work:\n"
+                          "** Meeting\n"
+                          "*** Notes\t:notes:\n"
+                          "* Home\t:home:\n"
+                          "** Garden\t:work:\n");
+    Parser parser;
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(data)).dynamicCast<OrgFile>();
+    QVERIFY(file);
+    const Headline::List headlines = findElements<Headline>(file);
+    QCOMPARE(headlines.count(), 5);
+    const Headline::Pointer work = headlines.at(0);
+    const Headline::Pointer meeting = headlines.at(1);
+    const Headline::Pointer notes = headlines.at(2);
+    const Headline::Pointer home = headlines.at(3);
+    const Headline::Pointer garden = headlines.at(4);
+    QCOMPARE(work->inheritedTags(), Headline::Tags{FL1("project")});
+    QCOMPARE(notes->inheritedTags(), (Headline::Tags{FL1("project"), FL1("work")}));
+    QCOMPARE(notes->tags(), Headline::Tags{FL1("notes")});
+    QVERIFY(Tags(meeting).hasTag(FL1("work")));
+    QVERIFY(Tags(meeting).hasTag(FL1("project")));
+    QVERIFY(!Tags(meeting).hasTag(FL1("home")));
+    auto const captions = [](const Headline::List& headlines) {
+        QStringList result;
+        for(auto const& headline : headlines) {
+            result.append(headline->caption());
+        }
+        return result;
+    };
+    QCOMPARE(captions(Tags::filter(headlines, QStringList() << FL1("work"), QStringList() << FL1("home"))),
+             QStringList() << FL1("Work") << FL1("Meeting") << FL1("Notes"));
+    QCOMPARE(captions(Tags::filter(headlines, QStringList() << FL1("work") << FL1("home"))),
+             QStringList() << FL1("Garden"));
+    QVERIFY(Tags::filter(headlines, QStringList() << FL1("unknown")).isEmpty());
+    //Changing tags updates the inherited tags of the sub-headlines:
+    meeting->addTag(FL1("urgent"));
+    QVERIFY(Tags(notes).hasTag(FL1("urgent")));
+    work->removeTag(FL1("work"));
+    QVERIFY(!Tags(notes).hasTag(FL1("work")));
+    QVERIFY(Tags(notes).hasTag(FL1("project")));
+    //Moving a headline updates its subtree:
+    OrgElement::List children = work->children();
+    children.removeOne(meeting);
+    work->setChildren(children);
+    garden->addChild(meeting);
+    QVERIFY(Tags(notes).hasTag(FL1("home")));
+    QVERIFY(Tags(notes).hasTag(FL1("work")));
+    QVERIFY(Tags(notes).hasTag(FL1("urgent")));
+    //Changing the file tags updates all headlines:
+    file->setFileSettings(FileSettings());
+    QVERIFY(!Tags(notes).hasTag(FL1("project")));
+    QVERIFY(!Tags(work).hasTag(FL1("project")));
+}
+
+void ParserTests::testTagIndex()
+{
+    typedef TagIndex::PostingList Postings;
+    QCOMPARE(TagIndex::intersect(Postings() << 1 << 3 << 5, Postings() << 3 << 4 << 5), Postings() << 3 << 5);
+    QCOMPARE(TagIndex::unite(Postings() << 1 << 3, Postings() << 2 << 3), Postings() << 1 << 2 << 3);
+    QCOMPARE(TagIndex::subtract(Postings() << 1 << 2 << 3, Postings() << 2), Postings() << 1 << 3);
+
+    const QByteArray data("#+FILETAGS: :project:\n"
+                          "* Work\t:work:\n"
+                          "** Meeting\n"
+                          "*** Notes\t:notes:\n"
+                          "* Home\t:home:\n"
+                          "** Garden\t:work:\n");
+    Parser parser;
+    const OrgFile::Pointer file = parser.parse(QByteArrayView(data)).dynamicCast<OrgFile>();
+    QVERIFY(file);
+    TagIndex index(file);
+    QCOMPARE(index.headlineCount(), 5);
+    const Headline::Pointer meeting = index.headline(1);
+    QCOMPARE(meeting->caption(), FL1("Meeting"));
+    QCOMPARE(index.position(meeting), 1);
+    QCOMPARE(index.postings(FL1("work"), TagIndex::Direct), Postings() << 0 << 4);
+    QCOMPARE(index.postings(FL1("work"), TagIndex::Inherited), Postings() << 1 << 2);
+    QCOMPARE(index.postings(FL1("work")), Postings() << 0 << 1 << 2 << 4);
+    QCOMPARE(index.postings(FL1("project")).count(), 5);
+    QVERIFY(index.postings(FL1("unknown")).isEmpty());
+    QCOMPARE(index.query(QStringList() << FL1("work"), QStringList() << FL1("home")), Postings() << 0 << 1 << 2);
+    QCOMPARE(index.query(QStringList() << FL1("work") << FL1("home")), Postings() << 4);
+    QCOMPARE(index.query(QStringList(), QStringList() << FL1("work")), Postings() << 3);
+    QVERIFY(index.query(QStringList() << FL1("work") << FL1("unknown")).isEmpty());
+    //The results match the ones of Tags::filter():
+    QCOMPARE(index.headlines(index.query(QStringList() << FL1("work"), QStringList() << FL1("home"))),
+             Tags::filter(findElements<Headline>(file), QStringList() << FL1("work"), QStringList() << FL1("home")));
+    //Updating a headline refreshes the postings of its subtree:
+    meeting->addTag(FL1("urgent"));
+    QVERIFY(index.postings(FL1("urgent")).isEmpty());
+    index.update(meeting);
+    QCOMPARE(index.postings(FL1("urgent"), TagIndex::Direct), Postings() << 1);
+    QCOMPARE(index.postings(FL1("urgent"), TagIndex::Inherited), Postings() << 2);
+    meeting->removeTag(FL1("urgent"));
+    index.update(meeting);
+    QVERIFY(!index.tags().contains(FL1("urgent")));
+    QCOMPARE(index.postings(FL1("work")), Postings() << 0 << 1 << 2 << 4);
+    //Merged indexes continue the positions:
+    const OrgElement::Pointer other = parser.parse(QByteArrayView(data));
+    TagIndex merged(other);
+    merged.merge(index);
+    QCOMPARE(merged.headlineCount(), 10);
+    QCOMPARE(merged.postings(FL1("home")), Postings() << 3 << 4 << 8 << 9);
+    QCOMPARE(merged.position(meeting), 6);
+    //Indexes that share headlines are not merged:
+    try {
+        merged.merge(index);
+        QFAIL("Merging indexes that share headlines should throw an exception!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+    try {
+        index.merge(index);
+        QFAIL("Merging an index into itself should throw an exception!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+    QCOMPARE(index.headlineCount(), 5);
+    QCOMPARE(merged.headlineCount(), 10);
+    //Headlines that are not part of the index are rejected:
+    try {
+        index.update(Headline::Pointer(new Headline));
+        QFAIL("Updating a headline that is not in the index should throw an exception!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+}
+
+void ParserTests::testPropertyIndex()
+{
+    const QByteArray data("#+PROPERTY: var  foo=1\n"
+                          "#+PROPERTY: var+ bar=2\n"
+                          "* Classic\n"
+                          "  :PROPERTIES:\n"
+                          "  :GENRES:   Classic\n"
+                          "  :END:\n"
+                          "** Baroque\n"
+                          "   :PROPERTIES:\n"
+                          "   :GENRES+: Baroque\n"
+                          "   :var: local\n"
+                          "   :END:\n"
+                          "*** Goldberg Variations\n"
+                          "    Some text.\n"
+                          "* Pop\n");
+    Parser parser;
+    const OrgElement::Pointer file = parser.parse(QByteArrayView(data));
+    const Headline::List headlines = findElements<Headline>(file);
+    QCOMPARE(headlines.count(), 4);
+    const PropertyIndex::Pointer index(new PropertyIndex(file));
+    QCOMPARE(index->document(), file.data());
+    QCOMPARE(index->fileProperties().count(), 2);
+    QCOMPARE(index->definitions(headlines.at(1).data()).count(), 2);
+    QVERIFY(index->definitions(headlines.at(2).data()).isEmpty());
+    QCOMPARE(index->property(file.data(), FL1("var")), FL1("foo=1 bar=2"));
+    QCOMPARE(index->property(headlines.at(0).data(), FL1("GENRES")), FL1("Classic"));
+    QCOMPARE(index->property(headlines.at(1).data(), FL1("GENRES")), FL1("Classic Baroque"));
+    QCOMPARE(index->property(headlines.at(1).data(), FL1("var")), FL1("local"));
+    QCOMPARE(index->property(headlines.at(3).data(), FL1("var")), FL1("foo=1 bar=2"));
+    //Elements without property drawers inherit the values of their closest ancestors:
+    const OrgLine::Pointer text = findElements<OrgLine>(headlines.at(2)).value(0);
+    QVERIFY(text);
+    QCOMPARE(index->property(text.data(), FL1("GENRES")), FL1("Classic Baroque"));
+    //Memoized values are returned for repeated queries:
+    QCOMPARE(index->property(headlines.at(2).data(), FL1("GENRES")), FL1("Classic Baroque"));
+    QCOMPARE(index->property(headlines.at(2).data(), FL1("GENRES")), FL1("Classic Baroque"));
+    QString value;
+    QVERIFY(!index->resolve(headlines.at(3).data(), FL1("GENRES"), &value));
+    QVERIFY(value.isNull());
+    try {
+        index->property(headlines.at(3).data(), FL1("GENRES"));
+        QFAIL("Retrieving a non-existant property should throw an exception!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+    //Properties share the index, or build one for the document of the element:
+    QCOMPARE(Properties(headlines.at(2), index).property(FL1("GENRES")), FL1("Classic Baroque"));
+    QCOMPARE(Properties(headlines.at(2)).property(FL1("GENRES")), FL1("Classic Baroque"));
+    //Elements of other documents are rejected:
+    const OrgElement::Pointer other = parser.parse(QByteArrayView(data));
+    try {
+        index->property(other.data(), FL1("var"));
+        QFAIL("Querying an element of another document should throw an exception!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+    //Files keep the index that is shared by the Properties of their elements, until they are changed:
+    const OrgFile::Pointer orgFile = file.dynamicCast<OrgFile>();
+    QVERIFY(orgFile);
+    const PropertyIndex::Pointer shared = orgFile->propertyIndex();
+    QCOMPARE(orgFile->propertyIndex(), shared);
+    QCOMPARE(Properties(headlines.at(2)).property(FL1("var")), FL1("local"));
+    orgFile->markChanged();
+    QVERIFY(shared->isStale());
+    QVERIFY(orgFile->propertyIndex() != shared);
+    QVERIFY(!orgFile->propertyIndex()->isStale());
+
+    //File properties apply to the elements of their file, not to the other files of a document:
+    const OrgFile::Pointer toplevel(new OrgFile);
+    const QByteArray firstData("#+PROPERTY: var first\n* First\n");
+    const QByteArray secondData("#+PROPERTY: other second\n* Second\n");
+    const OrgFile::Pointer first = parser.parse(QByteArrayView(firstData)).dynamicCast<OrgFile>();
+    const OrgFile::Pointer second = parser.parse(QByteArrayView(secondData)).dynamicCast<OrgFile>();
+    QVERIFY(first && second);
+    toplevel->addChild(first);
+    toplevel->addChild(second);
+    const Headline::Pointer firstHeadline = findElements<Headline>(first).value(0);
+    const Headline::Pointer secondHeadline = findElements<Headline>(second).value(0);
+    QVERIFY(firstHeadline && secondHeadline);
+    const PropertyIndex documentIndex(toplevel);
+    QVERIFY(documentIndex.fileProperties().isEmpty());
+    QCOMPARE(documentIndex.fileProperties(firstHeadline.data()).count(), 1);
+    QCOMPARE(documentIndex.fileProperties(second.data()).count(), 1);
+    QCOMPARE(documentIndex.property(firstHeadline.data(), FL1("var")), FL1("first"));
+    QVERIFY(!documentIndex.resolve(firstHeadline.data(), FL1("other"), nullptr));
+    QCOMPARE(documentIndex.property(secondHeadline.data(), FL1("other")), FL1("second"));
+    QVERIFY(!documentIndex.resolve(secondHeadline.data(), FL1("var"), nullptr));
+    QVERIFY(!documentIndex.resolve(toplevel.data(), FL1("var"), nullptr));
+    QCOMPARE(Properties(firstHeadline).property(FL1("var")), FL1("first"));
+    QCOMPARE(Properties(secondHeadline).property(FL1("other")), FL1("second"));
+    try {
+        Properties(secondHeadline).property(FL1("var"));
+        QFAIL("File properties of another file should not be inherited!");
+    } catch (const RuntimeException&) {
+        //expected
+    }
+}
+
 QTEST_MAIN(ParserTests)
 
 #include "tst_ParserTests.moc"
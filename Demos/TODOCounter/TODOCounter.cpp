@@ -17,39 +17,65 @@
  */
 
 #include <iostream>
+#include <vector>
 #include <QCoreApplication>
-#include <QFile>
-#include <QTextStream>
 
 #include <Parser.h>
-#include <Headline.h>
-#include <FindElements.h>
+#include <ParseBatch.h>
+#include <Exception.h>
+#include <OrgEventHandler.h>
 
 using namespace OrgMode;
 using namespace std;
 
+/** Count headlines and TODO items while the file is parsed, without building an element tree. */
+class TODOCounter : public OrgEventHandler
+{
+public:
+    void onHeadline(int, QStringView caption, const QStringList&, QStringView) override
+    {
+        ++headlines;
+        if (caption.startsWith(QLatin1String("TODO"))) {
+            ++todos;
+        }
+    }
+
+    int headlines = 0;
+    int todos = 0;
+};
+
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
-    if (argc !=2) {
+    if (argc < 2) {
         wcerr << "No file specified!" << endl;
         return 1;
     }
-    auto const inputFile = QString::fromLocal8Bit(argv[1]);
-    Parser parser;
-    QFile input(inputFile);
-    if (!input.open(QIODevice::ReadOnly)) {
-        wcerr << "Unable to open file" << inputFile.toStdWString() << "!" << endl;
-        return 1;
+    QStringList inputFiles;
+    for (int i = 1; i < argc; ++i) {
+        inputFiles << QString::fromLocal8Bit(argv[i]);
     }
-    QTextStream stream(&input);
-    OrgElement::Pointer orgfile = parser.parse(&stream, inputFile);
-    auto const headlines = findElements<Headline>(orgfile);
-    wcout << "Number of headlines: " << headlines.count() << endl;
-    auto isTODO = [](const Headline::Pointer& element) {
-        return element->caption().startsWith(QStringLiteral("TODO"));
-    };
-    auto const todos = findElements<Headline>(orgfile, isTODO);
-    wcout << "Number of TODOs: " << todos.count() << endl;
-
+    //The files are parsed concurrently, with one counter per file:
+    const Parser parser;
+    const ParseBatch batch(parser);
+    std::vector<TODOCounter> counters(inputFiles.count());
+    const QStringList errors = batch.parseFiles(inputFiles, [&counters](int index) {
+        return &counters[index];
+    });
+    int result = 0;
+    for(auto const& error : errors) {
+        if (!error.isEmpty()) {
+            wcerr << error.toStdWString() << endl;
+            result = 1;
+        }
+    }
+    int headlines = 0;
+    int todos = 0;
+    for(auto const& counter : counters) {
+        headlines += counter.headlines;
+        todos += counter.todos;
+    }
+    wcout << "Number of headlines: " << headlines << endl;
+    wcout << "Number of TODOs: " << todos << endl;
+    return result;
 }
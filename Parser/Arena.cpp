@@ -0,0 +1,255 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstdlib>
+#include <new>
+
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "Arena.h"
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+namespace OrgMode {
+
+namespace {
+
+thread_local Arena* currentArena = nullptr;
+
+//The region table maps the regions of all arena blocks to their arenas. It has two levels, a leaf covers 4 GiB of
+//addresses and is created when the first block in that range is allocated. Addresses above 48 bits are not mapped:
+const int RegionBits = 16;
+const int LeafBits = 16;
+const int RootBits = 48 - RegionBits - LeafBits;
+static_assert(Arena::RegionSize == 1 << RegionBits, "The region size needs to match the region table");
+
+struct Leaf {
+    QAtomicPointer<Arena> arenas[1 << LeafBits];
+};
+
+QAtomicPointer<Leaf> regionTable[1 << RootBits];
+
+//The number of references an arena takes at once for the allocations it makes:
+const int ReservedReferences = 1024;
+
+std::size_t aligned(std::size_t size)
+{
+    const std::size_t alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+char* allocateBlock(std::size_t size)
+{
+    void* block = nullptr;
+#ifdef Q_OS_WIN
+    block = _aligned_malloc(size, Arena::RegionSize);
+#else
+    if (posix_memalign(&block, Arena::RegionSize, size) != 0) {
+        block = nullptr;
+    }
+#endif
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char*>(block);
+}
+
+void freeBlock(char* block)
+{
+#ifdef Q_OS_WIN
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+/** Set the arena of the regions of a block, null when the block is released.
+ * @return False if the block is outside of the addresses the table covers. */
+bool mapRegions(const char* block, qsizetype size, Arena* arena)
+{
+    const quint64 first = quint64(quintptr(block)) >> RegionBits;
+    const quint64 last = (quint64(quintptr(block)) + quint64(size) - 1) >> RegionBits;
+    if (last >> (LeafBits + RootBits)) {
+        return false;
+    }
+    for (quint64 region = first; region <= last; ++region) {
+        QAtomicPointer<Leaf>& root = regionTable[region >> LeafBits];
+        Leaf* leaf = root.loadAcquire();
+        if (!leaf) {
+            static QMutex mutex;
+            const QMutexLocker locker(&mutex);
+            leaf = root.loadAcquire();
+            if (!leaf) {
+                //Leaves are never released, there are few of them:
+                leaf = new Leaf;
+                root.storeRelease(leaf);
+            }
+        }
+        leaf->arenas[region & ((1 << LeafBits) - 1)].storeRelease(arena);
+    }
+    return true;
+}
+
+}
+
+/** @brief Create an arena that allocates blocks of blockSize bytes, rounded up to whole regions.
+ *
+ * The arena deletes itself when it is released.
+ */
+Arena::Arena(qsizetype blockSize)
+    : refs_(0)
+    , reserved_(0)
+    , blockSize_((qMax<qsizetype>(blockSize, 1) + RegionSize - 1) / RegionSize * RegionSize)
+    , next_(nullptr)
+    , end_(nullptr)
+    , allocationCount_(0)
+{
+}
+
+Arena::~Arena()
+{
+    for (int i = 0; i < blocks_.size(); ++i) {
+        //The regions are unmapped before the memory can be reused by the heap:
+        mapRegions(blocks_.at(i), blockSizes_.at(i), nullptr);
+        freeBlock(blocks_.at(i));
+    }
+}
+
+/** @brief Allocate size bytes, aligned for any type. Every allocation holds a reference to the arena.
+ *
+ * This is called while a scope of the arena is active, which returns the references that have been taken in
+ * advance when it ends.
+ */
+void* Arena::allocate(std::size_t size)
+{
+    size = aligned(size);
+    if (next_ == nullptr || std::size_t(end_ - next_) < size) {
+        //Allocations that are larger than the blocks get a block of their own:
+        const qsizetype blockSize = qMax(blockSize_, qsizetype(size + RegionSize - 1) / RegionSize * RegionSize);
+        char* block = allocateBlock(std::size_t(blockSize));
+        if (!mapRegions(block, blockSize, this)) {
+            freeBlock(block);
+            throw std::bad_alloc();
+        }
+        blocks_.append(block);
+        blockSizes_.append(blockSize);
+        next_ = block;
+        end_ = block + blockSize;
+    }
+    if (reserved_ == 0) {
+        //One atomic operation for a batch of allocations:
+        refs_.fetchAndAddRelaxed(ReservedReferences);
+        reserved_ = ReservedReferences;
+    }
+    --reserved_;
+    void* pointer = next_;
+    next_ += size;
+    ++allocationCount_;
+    return pointer;
+}
+
+void Arena::ref()
+{
+    refs_.ref();
+}
+
+/** @brief Release a reference, the arena and all its blocks are released with the last one. */
+void Arena::deref()
+{
+    if (!refs_.deref()) {
+        delete this;
+    }
+}
+
+qsizetype Arena::allocationCount() const
+{
+    return allocationCount_;
+}
+
+qsizetype Arena::blockCount() const
+{
+    return blocks_.size();
+}
+
+/** @brief The arena of the innermost active scope in the current thread, or null. */
+Arena* Arena::current()
+{
+    return currentArena;
+}
+
+/** @brief The arena pointer has been allocated from, or null if it is not in a block of an arena. */
+Arena* Arena::owner(const void *pointer)
+{
+    const quint64 region = quint64(quintptr(pointer)) >> RegionBits;
+    if (region >> (LeafBits + RootBits)) {
+        return nullptr;
+    }
+    const Leaf* leaf = regionTable[region >> LeafBits].loadAcquire();
+    return leaf ? leaf->arenas[region & ((1 << LeafBits) - 1)].loadAcquire() : nullptr;
+}
+
+/** @brief Return the references that have been taken for allocations that have not been made. */
+void Arena::releaseReserved()
+{
+    if (reserved_ > 0) {
+        refs_.fetchAndAddRelaxed(-reserved_);
+        reserved_ = 0;
+    }
+}
+
+/** @brief Make arena the current arena of the thread, and hold a reference to it. */
+Arena::Scope::Scope(Arena *arena)
+    : arena_(arena)
+    , previous_(currentArena)
+{
+    if (arena_) {
+        arena_->ref();
+    }
+    currentArena = arena_;
+}
+
+Arena::Scope::~Scope()
+{
+    currentArena = previous_;
+    if (arena_) {
+        //The reference of the scope keeps the arena alive until the reserved ones have been returned:
+        arena_->releaseReserved();
+        arena_->deref();
+    }
+}
+
+void* ArenaAllocated::operator new(std::size_t size)
+{
+    Arena* arena = currentArena;
+    return arena ? arena->allocate(size) : ::operator new(size);
+}
+
+/** @brief Memory from an arena is not released, but the reference of the allocation to the arena is. */
+void ArenaAllocated::operator delete(void *pointer)
+{
+    if (Arena* arena = Arena::owner(pointer)) {
+        arena->deref();
+    } else {
+        ::operator delete(pointer);
+    }
+}
+
+}
@@ -0,0 +1,101 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+
+#include <QAtomicInt>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+
+namespace OrgMode {
+
+/** @brief Arena is a monotonic allocator for the elements of a parse result and their private data.
+ *
+ * Memory is carved from large blocks, and is only returned when the arena is released. The arena is reference
+ * counted: every allocation holds a reference, so that the arena is released when the last element that lives in
+ * it has been destroyed. Elements are allocated in an arena while a Scope for it is active in the current thread.
+ * Allocating from one arena is not thread-safe, releasing allocations is.
+ *
+ * The blocks are aligned to regions of RegionSize bytes, and a table maps the regions of all blocks to their arenas
+ * (see owner()). Allocations carry no header, neither in an arena nor on the heap. The references of allocations
+ * are taken in batches by the allocating thread, and the unused ones are returned when its scope ends.
+ */
+class ORGMODEPARSER_EXPORT Arena
+{
+public:
+    enum {
+        RegionSize = 64 * 1024
+    };
+
+    explicit Arena(qsizetype blockSize = RegionSize);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size);
+    void ref();
+    void deref();
+
+    qsizetype allocationCount() const;
+    qsizetype blockCount() const;
+
+    static Arena* current();
+    static Arena* owner(const void* pointer);
+
+    /** @brief Scope makes an arena the current arena of the thread, for the lifetime of the scope. */
+    class ORGMODEPARSER_EXPORT Scope
+    {
+    public:
+        explicit Scope(Arena* arena);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+    private:
+        Arena* arena_;
+        Arena* previous_;
+    };
+
+private:
+    ~Arena();
+    void releaseReserved();
+
+    QAtomicInt refs_;
+    //References taken for allocations that have not been made yet:
+    int reserved_;
+    qsizetype blockSize_;
+    QVector<char*> blocks_;
+    QVector<qsizetype> blockSizes_;
+    char* next_;
+    char* end_;
+    qsizetype allocationCount_;
+};
+
+/** @brief Classes that derive from ArenaAllocated are allocated from the current arena, if there is one. */
+class ORGMODEPARSER_EXPORT ArenaAllocated
+{
+public:
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer);
+};
+
+}
+
+#endif // ARENA_H
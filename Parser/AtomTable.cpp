@@ -0,0 +1,221 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <memory>
+#include <vector>
+
+#include <QAtomicPointer>
+#include <QHash>
+#include <QMutex>
+
+#include "AtomTable.h"
+
+namespace OrgMode {
+
+namespace {
+
+thread_local AtomTable::Pointer currentTable;
+
+//The entries are kept in segments that are never moved, segment k holds FirstSegment << k entries:
+const int FirstSegmentBits = 5;
+const int SegmentCount = 32 - FirstSegmentBits;
+
+}
+
+struct AtomTable::Private {
+    //The strings are kept decoded, and as UTF-8 for the elements that keep slices of their source:
+    struct Entry {
+        QString text;
+        SourceText source;
+        size_t hash;
+    };
+
+    //An open addressing hash index, every slot holds an atom + 1, or 0 if it is empty. It is at most half full:
+    struct Index {
+        explicit Index(size_t capacity)
+            : mask(capacity - 1)
+            , slots(new QAtomicInt[capacity])
+        {}
+        size_t mask;
+        std::unique_ptr<QAtomicInt[]> slots;
+    };
+
+    ~Private();
+    const Entry& entry(Atom atom) const;
+    Atom lookup(const QString& text, size_t hash) const;
+    Atom append(const QString& text, size_t hash);
+    static int segmentOf(Atom atom, int* offset);
+
+    QAtomicPointer<Entry> segments_[SegmentCount];
+    QAtomicInt size_;
+    QAtomicPointer<Index> index_;
+    //Writers are serialized. Replaced indexes are kept while the table exists, readers may still use them:
+    QMutex mutex_;
+    std::vector<std::unique_ptr<Index>> indexes_;
+};
+
+AtomTable::Private::~Private()
+{
+    for (auto& segment : segments_) {
+        delete[] segment.loadRelaxed();
+    }
+}
+
+int AtomTable::Private::segmentOf(Atom atom, int *offset)
+{
+    const quint32 position = quint32(atom) + (1u << FirstSegmentBits);
+    const int segment = 31 - qCountLeadingZeroBits(position) - FirstSegmentBits;
+    *offset = int(position - ((1u << FirstSegmentBits) << segment));
+    return segment;
+}
+
+const AtomTable::Private::Entry &AtomTable::Private::entry(Atom atom) const
+{
+    int offset;
+    const int segment = segmentOf(atom, &offset);
+    return segments_[segment].loadAcquire()[offset];
+}
+
+/** @brief Find text without locking. Strings that are added concurrently may not be found. */
+AtomTable::Atom AtomTable::Private::lookup(const QString &text, size_t hash) const
+{
+    const Index* index = index_.loadAcquire();
+    if (!index) {
+        return InvalidAtom;
+    }
+    for (size_t slot = hash & index->mask; ; slot = (slot + 1) & index->mask) {
+        const int value = index->slots[slot].loadAcquire();
+        if (value == 0) {
+            return InvalidAtom;
+        }
+        const Entry& candidate = entry(value - 1);
+        if (candidate.hash == hash && candidate.text == text) {
+            return value - 1;
+        }
+    }
+}
+
+/** @brief Add text to the table, with the mutex locked. The entry is written before readers can find it. */
+AtomTable::Atom AtomTable::Private::append(const QString &text, size_t hash)
+{
+    const Atom atom = size_.loadRelaxed();
+    int offset;
+    const int segment = segmentOf(atom, &offset);
+    Entry* entries = segments_[segment].loadRelaxed();
+    if (!entries) {
+        entries = new Entry[size_t(1) << (FirstSegmentBits + segment)];
+        segments_[segment].storeRelease(entries);
+    }
+    entries[offset] = Entry{text, SourceText(text), hash};
+    size_.storeRelease(atom + 1);
+    auto const place = [this](Index* index, Atom placed, size_t placedHash) {
+        size_t slot = placedHash & index->mask;
+        while (index->slots[slot].loadRelaxed() != 0) {
+            slot = (slot + 1) & index->mask;
+        }
+        index->slots[slot].storeRelease(placed + 1);
+    };
+    Index* index = index_.loadRelaxed();
+    if (!index || size_t(atom + 1) * 2 > index->mask + 1) {
+        //Grow the index, readers keep using the current one until the new one is complete:
+        std::unique_ptr<Index> grown(new Index(index ? (index->mask + 1) * 2 : 64));
+        for (Atom existing = 0; existing <= atom; ++existing) {
+            place(grown.get(), existing, entry(existing).hash);
+        }
+        index_.storeRelease(grown.get());
+        indexes_.push_back(std::move(grown));
+    } else {
+        place(index, atom, hash);
+    }
+    return atom;
+}
+
+AtomTable::AtomTable()
+    : d(new Private)
+{
+}
+
+AtomTable::~AtomTable() = default;
+
+/** @brief Return the atom of text, which is added to the table if it is not in it yet. Null text has no atom. */
+AtomTable::Atom AtomTable::intern(const QString &text)
+{
+    if (text.isNull()) {
+        return InvalidAtom;
+    }
+    const size_t hash = qHash(text);
+    const Atom atom = d->lookup(text, hash);
+    if (atom != InvalidAtom) {
+        return atom;
+    }
+    QMutexLocker locker(&d->mutex_);
+    //Another thread may have added text in the meantime:
+    const Atom added = d->lookup(text, hash);
+    return added != InvalidAtom ? added : d->append(text, hash);
+}
+
+/** @brief Return the atom of text, or InvalidAtom if text is not in the table. The table is not changed. */
+AtomTable::Atom AtomTable::find(const QString &text) const
+{
+    return d->lookup(text, qHash(text));
+}
+
+/** @brief The string of atom, or a null string for InvalidAtom. */
+QString AtomTable::string(Atom atom) const
+{
+    if (atom == InvalidAtom) {
+        return QString();
+    }
+    Q_ASSERT(atom >= 0 && atom < d->size_.loadAcquire());
+    return d->entry(atom).text;
+}
+
+/** @brief The UTF-8 encoded string of atom, see string(). */
+SourceText AtomTable::sourceText(Atom atom) const
+{
+    if (atom == InvalidAtom) {
+        return SourceText();
+    }
+    Q_ASSERT(atom >= 0 && atom < d->size_.loadAcquire());
+    return d->entry(atom).source;
+}
+
+/** @brief The number of atoms. Atoms are numbered from 0 in the order they have been interned. */
+int AtomTable::size() const
+{
+    return d->size_.loadAcquire();
+}
+
+/** @brief The table of the innermost active scope in the current thread, or null. */
+AtomTable::Pointer AtomTable::current()
+{
+    return currentTable;
+}
+
+/** @brief Make table the current table of the thread. */
+AtomTable::Scope::Scope(const Pointer &table)
+    : previous_(currentTable)
+{
+    currentTable = table;
+}
+
+AtomTable::Scope::~Scope()
+{
+    currentTable = previous_;
+}
+
+}
@@ -0,0 +1,81 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ATOMTABLE_H
+#define ATOMTABLE_H
+
+#include <memory>
+
+#include <QSharedPointer>
+#include <QString>
+
+#include "orgmodeparser_export.h"
+#include "SourceText.h"
+
+namespace OrgMode {
+
+/** @brief AtomTable interns the strings of a document that repeat in many elements, and maps them to atoms.
+ *
+ * Tags, drawer names and the keys of drawer entries and file attributes are kept by the elements as atoms, small
+ * integers that are compared instead of the strings. Every document has one table, which is kept by its OrgFile
+ * (see OrgElement::atomTable()). The parser makes the table current while the file is created (see Scope), files
+ * that are created without a current table get a new one. Atoms can only be compared if they are from the same
+ * table.
+ *
+ * The table is thread-safe. Looking up strings and atoms does not lock, only adding strings does.
+ */
+class ORGMODEPARSER_EXPORT AtomTable
+{
+public:
+    typedef QSharedPointer<AtomTable> Pointer;
+    typedef int Atom;
+    static const Atom InvalidAtom = -1;
+
+    AtomTable();
+    AtomTable(const AtomTable&) = delete;
+    AtomTable& operator=(const AtomTable&) = delete;
+    ~AtomTable();
+
+    Atom intern(const QString& text);
+    Atom find(const QString& text) const;
+    QString string(Atom atom) const;
+    SourceText sourceText(Atom atom) const;
+    int size() const;
+
+    static Pointer current();
+
+    /** @brief Scope makes a table the current table of the thread, for the lifetime of the scope. */
+    class ORGMODEPARSER_EXPORT Scope
+    {
+    public:
+        explicit Scope(const Pointer& table);
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope();
+
+    private:
+        Pointer previous_;
+    };
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // ATOMTABLE_H
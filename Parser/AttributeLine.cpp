@@ -16,12 +16,21 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "AttributeLine.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class AttributeLine::Private {
+class AttributeLine::Private : public ArenaAllocated {
 public:
-    Property property_;
+    Private()
+        : key_(AtomTable::InvalidAtom)
+        , operation_(Property::Property_Define)
+    {}
+
+    //The property is kept in parts, with the key as an atom:
+    AtomTable::Atom key_;
+    SourceText value_;
+    Property::Operation operation_;
 };
 
 AttributeLine::AttributeLine(OrgElement *parent)
@@ -34,6 +43,7 @@ AttributeLine::AttributeLine(const QString &line, OrgElement *parent)
     : OrgElement(line, parent)
     , d(new Private)
 {
+    setKind(AttributeLineKind);
 }
 
 AttributeLine::AttributeLine(AttributeLine && other) = default;
@@ -42,32 +52,47 @@ AttributeLine::~AttributeLine() = default;
 
 void AttributeLine::setProperty(const Property &property)
 {
-    d->property_ = property;
+    d->key_ = atomTable()->intern(property.key());
+    d->value_ = property.valueText();
+    d->operation_ = property.operation();
 }
 
 Property AttributeLine::property() const
 {
-    return d->property_;
+    return Property(atomTable()->sourceText(d->key_), d->value_, d->operation_);
 }
 
 QString AttributeLine::key() const
 {
-    return d->property_.key();
+    return atomTable()->string(d->key_);
 }
 
 QString AttributeLine::value() const
 {
-    return d->property_.value();
+    return d->value_.toString();
+}
+
+/** @brief The atom of the key, in the atom table of the element. */
+AtomTable::Atom AttributeLine::keyAtom() const
+{
+    return d->key_;
+}
+
+void AttributeLine::atomTableChanged(const AtomTable::Pointer &previous)
+{
+    if (d->key_ != AtomTable::InvalidAtom) {
+        d->key_ = atomTable()->intern(previous->string(d->key_));
+    }
 }
 
 bool AttributeLine::isElementValid() const
 {
-    return !d->property_.isValid();
+    return !property().isValid();
 }
 
 QString AttributeLine::description() const
 {
-    return tr("%1: %2").arg(d->property_.key()).arg(d->property_.value());
+    return tr("%1: %2").arg(key()).arg(value());
 }
 
 }
@@ -24,6 +24,7 @@
 
 #include <OrgElement.h>
 #include <Property.h>
+#include <AtomTable.h>
 #include "orgmodeparser_export.h"
 
 namespace OrgMode {
@@ -32,6 +33,8 @@ class ORGMODEPARSER_EXPORT AttributeLine : public OrgElement
 {
     Q_DECLARE_TR_FUNCTIONS(AttributeLine)
 public:
+    static const Kind StaticKind = AttributeLineKind;
+
     explicit AttributeLine(OrgElement* parent = nullptr);
     explicit AttributeLine(const QString& line, OrgElement* parent = nullptr);
     AttributeLine(AttributeLine&&);
@@ -42,8 +45,10 @@ public:
     Property property() const;
     QString key() const;
     QString value() const;
+    AtomTable::Atom keyAtom() const;
 
 protected:
+    void atomTableChanged(const AtomTable::Pointer& previous) override;
     bool isElementValid() const override;
     QString description() const override;
 
@@ -19,6 +19,7 @@
 #include "Exception.h"
 #include "OrgFile.h"
 #include "FileAttributeLine.h"
+#include "FileSettings.h"
 #include "FindElements.h"
 
 namespace OrgMode {
@@ -26,7 +27,7 @@ namespace OrgMode {
 template <typename T>
 T* findNextHigherUp(OrgElement* element) {
     if (!element) return nullptr;
-    T* p = dynamic_cast<T*>(element);
+    T* p = element_cast<T>(element);
     if (p) {
         return p;
     } else if (element->parent()) {
@@ -92,18 +93,23 @@ Attributes::Vector Attributes::fileAttributes() const
     return attributes;
 }
 
-/** @brief For the element, return the drawer names that are defined. */
+/** @brief For the element, return the drawer names that are defined.
+ *
+ * Parsed files provide their drawer names in OrgFile::fileSettings(), which are returned without searching the file.
+ * For element trees that have been built programmatically, the settings are empty, and the DRAWERS attributes are
+ * collected from the file.
+ */
 const QStringList Attributes::drawerNames() const
 {
-    static const QStringList defaults = QStringList() << QStringLiteral("PROPERTIES");
-    try {
-        const QString drawersAttribute = fileAttribute(QString::fromLatin1("DRAWERS"));
-        const QStringList names = drawersAttribute.split(QRegularExpression(QLatin1String("\\s+")));
-        return defaults + names;
-    } catch (const RuntimeException&) {
-        // No drawer attribute defined:
-        return defaults;
+    auto const file = findNextHigherUp<OrgFile>(d->element_.data());
+    if (file && !file->fileSettings().attributes().isEmpty()) {
+        return file->fileSettings().drawerNames();
+    }
+    FileSettings settings;
+    for(auto const& attribute : fileAttributes(QString::fromLatin1("DRAWERS"))) {
+        settings.addAttribute(attribute);
     }
+    return settings.drawerNames();
 }
 
 /** @brief Return the value of an attribute identified by name.
@@ -0,0 +1,494 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QVector>
+#include <QPair>
+#include <QtEndian>
+
+#include <limits>
+#include <cstring>
+
+#include "BinaryDocument.h"
+#include "Exception.h"
+#include "OrgFile.h"
+#include "Headline.h"
+#include "OrgLine.h"
+#include "FileAttributeLine.h"
+#include "ClockLine.h"
+#include "CompletedClockLine.h"
+#include "Drawer.h"
+#include "PropertyDrawer.h"
+#include "DrawerEntry.h"
+#include "PropertyDrawerEntry.h"
+#include "DrawerClosingEntry.h"
+#include "AtomTable.h"
+
+namespace OrgMode {
+
+struct BinaryDocument::Private {
+    enum HeaderField {
+        Header_Magic,
+        Header_Version,
+        Header_NodeCount,
+        Header_NodesOffset,
+        Header_StringCount,
+        Header_StringsOffset,
+        Header_CharsOffset,
+        Header_CharCount,
+        Header_ListsOffset,
+        Header_ListCount,
+        Header_TimesOffset,
+        Header_TimeCount
+    };
+    enum NodeField {
+        Field_Type,
+        Field_Parent,
+        Field_SubtreeEnd,
+        Field_Line,
+        Field_First,
+        Field_Second
+    };
+
+    quint32 word(qsizetype offset) const
+    {
+        return qFromLittleEndian<quint32>(data_.data() + offset);
+    }
+    quint32 header(HeaderField field) const
+    {
+        return word(field * 4);
+    }
+    quint32 field(int node, NodeField field) const
+    {
+        return word(nodesOffset_ + qsizetype(node) * BinaryFormat::NodeSize + field * 4);
+    }
+    quint32 listEntry(quint32 index) const
+    {
+        return word(listsOffset_ + qsizetype(index) * 4);
+    }
+    QString string(quint32 id) const;
+    QDateTime time(quint32 index) const;
+    Property property(int node) const;
+    FileSettings fileSettings(quint32 list) const;
+    [[noreturn]] void invalid() const;
+    void verify();
+    void verifyList(quint32 index, quint32 entrySize, const QVector<quint32>& stringOffsets) const;
+    void verifyString(quint32 id) const;
+    void verifyTime(quint32 index) const;
+    OrgElement::Pointer createElement(int node, OrgElement* parent, QVector<QString>* strings) const;
+
+    QByteArrayView data_;
+    int nodeCount_ = 0;
+    qsizetype nodesOffset_ = 0;
+    quint32 stringCount_ = 0;
+    qsizetype stringsOffset_ = 0;
+    qsizetype charsOffset_ = 0;
+    quint32 charCount_ = 0;
+    qsizetype listsOffset_ = 0;
+    quint32 listCount_ = 0;
+    qsizetype timesOffset_ = 0;
+    quint32 timeCount_ = 0;
+};
+
+void BinaryDocument::Private::invalid() const
+{
+    throw RuntimeException(BinaryDocument::tr("The data is not valid OrgModeParser binary data."));
+}
+
+QString BinaryDocument::Private::string(quint32 id) const
+{
+    if (id == BinaryFormat::None) {
+        return QString();
+    }
+    const qsizetype offset = word(stringsOffset_ + qsizetype(id) * 8);
+    const qsizetype length = word(stringsOffset_ + qsizetype(id) * 8 + 4);
+    QString result(length, Qt::Uninitialized);
+    const char* chars = data_.data() + charsOffset_ + offset * 2;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(result.data(), chars, length * 2);
+#else
+    for (qsizetype i = 0; i < length; ++i) {
+        result[i] = QChar(qFromLittleEndian<quint16>(chars + i * 2));
+    }
+#endif
+    return result;
+}
+
+QDateTime BinaryDocument::Private::time(quint32 index) const
+{
+    if (index == BinaryFormat::None) {
+        return QDateTime();
+    }
+    const qint64 value = qFromLittleEndian<qint64>(data_.data() + timesOffset_ + qsizetype(index) * 8);
+    if (value == BinaryFormat::InvalidTime) {
+        return QDateTime();
+    }
+    return QDateTime(QDate::fromJulianDay(value / 86400000), QTime::fromMSecsSinceStartOfDay(int(value % 86400000)));
+}
+
+Property BinaryDocument::Private::property(int node) const
+{
+    const Property::Operation operation = Property::Operation(field(node, Field_Type) >> 8);
+    return Property(string(field(node, Field_First)), string(field(node, Field_Second)), operation);
+}
+
+FileSettings BinaryDocument::Private::fileSettings(quint32 list) const
+{
+    FileSettings settings;
+    const quint32 count = listEntry(list);
+    for (quint32 i = 0; i < count; ++i) {
+        const quint32 entry = list + 1 + i * 3;
+        settings.addAttribute(Property(string(listEntry(entry)), string(listEntry(entry + 1)),
+                                       Property::Operation(listEntry(entry + 2))));
+    }
+    return settings;
+}
+
+/** @brief Verify that all tables are within the data, and that all indices refer to existing entries. */
+void BinaryDocument::Private::verify()
+{
+    if (data_.size() < BinaryFormat::HeaderSize || header(Header_Magic) != BinaryFormat::Magic
+            || header(Header_Version) != BinaryFormat::Version) {
+        invalid();
+    }
+    const qint64 size = data_.size();
+    auto const table = [this, size](HeaderField offsetField, HeaderField countField, qint64 entrySize) {
+        const qint64 offset = header(offsetField);
+        if (offset < BinaryFormat::HeaderSize || offset + header(countField) * entrySize > size) {
+            invalid();
+        }
+        return qsizetype(offset);
+    };
+    nodesOffset_ = table(Header_NodesOffset, Header_NodeCount, BinaryFormat::NodeSize);
+    stringsOffset_ = table(Header_StringsOffset, Header_StringCount, 8);
+    charsOffset_ = table(Header_CharsOffset, Header_CharCount, 2);
+    listsOffset_ = table(Header_ListsOffset, Header_ListCount, 4);
+    timesOffset_ = table(Header_TimesOffset, Header_TimeCount, 8);
+    if (header(Header_NodeCount) == 0 || header(Header_NodeCount) > quint32(std::numeric_limits<int>::max())) {
+        invalid();
+    }
+    nodeCount_ = int(header(Header_NodeCount));
+    stringCount_ = header(Header_StringCount);
+    charCount_ = header(Header_CharCount);
+    listCount_ = header(Header_ListCount);
+    timeCount_ = header(Header_TimeCount);
+    for (quint32 id = 0; id < stringCount_; ++id) {
+        const quint64 offset = word(stringsOffset_ + qsizetype(id) * 8);
+        const quint64 length = word(stringsOffset_ + qsizetype(id) * 8 + 4);
+        if (offset + length > charCount_) {
+            invalid();
+        }
+    }
+    //The nodes are in preorder, every node has to be a child of the innermost subtree that contains it:
+    QVector<int> open;
+    for (int node = 0; node < nodeCount_; ++node) {
+        while (!open.isEmpty() && quint32(node) >= field(open.last(), Field_SubtreeEnd)) {
+            open.removeLast();
+        }
+        const quint32 parent = field(node, Field_Parent);
+        const quint32 end = field(node, Field_SubtreeEnd);
+        if ((open.isEmpty() ? parent != BinaryFormat::None || node != 0 : parent != quint32(open.last()))
+                || end <= quint32(node) || end > quint32(nodeCount_)
+                || (!open.isEmpty() && end > field(open.last(), Field_SubtreeEnd))) {
+            invalid();
+        }
+        open.append(node);
+        verifyString(field(node, Field_Line));
+        const quint32 first = field(node, Field_First);
+        const quint32 second = field(node, Field_Second);
+        switch (field(node, Field_Type) & 0xff) {
+        case BinaryFormat::OrgFileNode:
+            verifyString(first);
+            verifyList(second, 3, QVector<quint32>() << 0 << 1);
+            break;
+        case BinaryFormat::HeadlineNode:
+            verifyString(first);
+            verifyList(second, 1, QVector<quint32>() << 0);
+            break;
+        case BinaryFormat::CompletedClockLineNode:
+            verifyTime(second);
+            Q_FALLTHROUGH();
+        case BinaryFormat::ClockLineNode:
+            verifyTime(first);
+            break;
+        case BinaryFormat::DrawerNode:
+        case BinaryFormat::PropertyDrawerNode:
+            verifyString(first);
+            break;
+        case BinaryFormat::FileAttributeLineNode:
+        case BinaryFormat::DrawerEntryNode:
+        case BinaryFormat::PropertyDrawerEntryNode:
+        case BinaryFormat::DrawerClosingEntryNode:
+            verifyString(first);
+            verifyString(second);
+            break;
+        case BinaryFormat::OrgLineNode:
+            break;
+        default:
+            invalid();
+        }
+    }
+}
+
+/** @brief Verify a list of entries with entrySize values, the values at stringOffsets are string ids. */
+void BinaryDocument::Private::verifyList(quint32 index, quint32 entrySize, const QVector<quint32> &stringOffsets) const
+{
+    if (index >= listCount_ || quint64(index) + 1 + quint64(listEntry(index)) * entrySize > listCount_) {
+        invalid();
+    }
+    const quint32 count = listEntry(index);
+    for (quint32 entry = 0; entry < count; ++entry) {
+        for (const quint32 offset : stringOffsets) {
+            verifyString(listEntry(index + 1 + entry * entrySize + offset));
+        }
+    }
+}
+
+void BinaryDocument::Private::verifyString(quint32 id) const
+{
+    if (id != BinaryFormat::None && id >= stringCount_) {
+        invalid();
+    }
+}
+
+void BinaryDocument::Private::verifyTime(quint32 index) const
+{
+    if (index >= timeCount_) {
+        invalid();
+    }
+}
+
+/** @brief Create the element of node, with its values. Strings are decoded once, and shared between elements. */
+OrgElement::Pointer BinaryDocument::Private::createElement(int node, OrgElement* parent, QVector<QString> *strings) const
+{
+    auto const string = [this, strings](quint32 id) {
+        if (id == BinaryFormat::None) {
+            return QString();
+        }
+        QString& decoded = (*strings)[id];
+        if (decoded.isNull()) {
+            decoded = this->string(id);
+        }
+        return decoded;
+    };
+    const QString line = string(field(node, Field_Line));
+    const quint32 first = field(node, Field_First);
+    const quint32 second = field(node, Field_Second);
+    const quint32 type = field(node, Field_Type);
+    auto const property = [&]() {
+        return Property(string(first), string(second), Property::Operation(type >> 8));
+    };
+    switch (type & 0xff) {
+    case BinaryFormat::OrgFileNode: {
+        auto const file = OrgFile::Pointer(new OrgFile(parent));
+        file->setFileName(string(first));
+        file->setFileSettings(fileSettings(second));
+        return file;
+    }
+    case BinaryFormat::HeadlineNode: {
+        auto const headline = Headline::Pointer(new Headline(line, parent));
+        headline->setCaption(string(first));
+        Headline::Tags tags;
+        const quint32 count = listEntry(second);
+        for (quint32 i = 0; i < count; ++i) {
+            tags.insert(string(listEntry(second + 1 + i)));
+        }
+        headline->setTags(tags);
+        return headline;
+    }
+    case BinaryFormat::ClockLineNode: {
+        auto const clockLine = ClockLine::Pointer(new ClockLine(line, parent));
+        clockLine->setStartTime(time(first));
+        return clockLine;
+    }
+    case BinaryFormat::CompletedClockLineNode: {
+        auto const clockLine = CompletedClockLine::Pointer(new CompletedClockLine(line, parent));
+        clockLine->setStartTime(time(first));
+        clockLine->setEndTime(time(second));
+        return clockLine;
+    }
+    case BinaryFormat::DrawerNode:
+    case BinaryFormat::PropertyDrawerNode: {
+        Drawer::Pointer drawer((type & 0xff) == BinaryFormat::PropertyDrawerNode
+                               ? new PropertyDrawer(line, parent) : new Drawer(line, parent));
+        drawer->setName(string(first));
+        return drawer;
+    }
+    case BinaryFormat::FileAttributeLineNode: {
+        auto const attributeLine = FileAttributeLine::Pointer(new FileAttributeLine(line, parent));
+        attributeLine->setProperty(property());
+        return attributeLine;
+    }
+    case BinaryFormat::DrawerEntryNode:
+    case BinaryFormat::PropertyDrawerEntryNode:
+    case BinaryFormat::DrawerClosingEntryNode: {
+        DrawerEntry::Pointer entry;
+        if ((type & 0xff) == BinaryFormat::DrawerClosingEntryNode) {
+            entry.reset(new DrawerClosingEntry(line, parent));
+        } else if ((type & 0xff) == BinaryFormat::PropertyDrawerEntryNode) {
+            entry.reset(new PropertyDrawerEntry(line, parent));
+        } else {
+            entry.reset(new DrawerEntry(line, parent));
+        }
+        entry->setProperty(property());
+        return entry;
+    }
+    default:
+        return OrgElement::Pointer(new OrgLine(line, parent));
+    }
+}
+
+/** @brief A document that reads data, which is verified. A RuntimeException is thrown if the data is invalid. */
+BinaryDocument::BinaryDocument(QByteArrayView data)
+    : d(new Private)
+{
+    d->data_ = data;
+    d->verify();
+}
+
+BinaryDocument::BinaryDocument(BinaryDocument && other) = default;
+BinaryDocument& BinaryDocument::operator=(BinaryDocument &&other) = default;
+BinaryDocument::~BinaryDocument() = default;
+
+int BinaryDocument::nodeCount() const
+{
+    return d->nodeCount_;
+}
+
+BinaryFormat::NodeType BinaryDocument::type(int node) const
+{
+    Q_ASSERT(node >= 0 && node < d->nodeCount_);
+    return BinaryFormat::NodeType(d->field(node, Private::Field_Type) & 0xff);
+}
+
+/** @brief The index of the parent node, or -1 for the root node. */
+int BinaryDocument::parent(int node) const
+{
+    Q_ASSERT(node >= 0 && node < d->nodeCount_);
+    const quint32 parent = d->field(node, Private::Field_Parent);
+    return parent == BinaryFormat::None ? -1 : int(parent);
+}
+
+/** @brief The index after the last node in the subtree of node. */
+int BinaryDocument::subtreeEnd(int node) const
+{
+    Q_ASSERT(node >= 0 && node < d->nodeCount_);
+    return int(d->field(node, Private::Field_SubtreeEnd));
+}
+
+/** @brief The index of the first child of node, or -1 if it has no children. */
+int BinaryDocument::firstChild(int node) const
+{
+    return node + 1 < subtreeEnd(node) ? node + 1 : -1;
+}
+
+/** @brief The index of the next child of the parent of node, or -1 if node is the last child. */
+int BinaryDocument::nextSibling(int node) const
+{
+    const int parent = this->parent(node);
+    const int next = subtreeEnd(node);
+    return parent >= 0 && next < subtreeEnd(parent) ? next : -1;
+}
+
+QString BinaryDocument::line(int node) const
+{
+    Q_ASSERT(node >= 0 && node < d->nodeCount_);
+    return d->string(d->field(node, Private::Field_Line));
+}
+
+/** @brief The caption of a headline node. */
+QString BinaryDocument::caption(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::HeadlineNode);
+    return d->string(d->field(node, Private::Field_First));
+}
+
+/** @brief The tags of a headline node. */
+QStringList BinaryDocument::tags(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::HeadlineNode);
+    const quint32 list = d->field(node, Private::Field_Second);
+    QStringList tags;
+    for (quint32 i = 0; i < d->listEntry(list); ++i) {
+        tags.append(d->string(d->listEntry(list + 1 + i)));
+    }
+    return tags;
+}
+
+/** @brief The name of a drawer node, or the file name of a file node. */
+QString BinaryDocument::name(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::DrawerNode || type(node) == BinaryFormat::PropertyDrawerNode
+             || type(node) == BinaryFormat::OrgFileNode);
+    return d->string(d->field(node, Private::Field_First));
+}
+
+/** @brief The property of a file attribute line or drawer entry node. */
+Property BinaryDocument::property(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::FileAttributeLineNode || type(node) == BinaryFormat::DrawerEntryNode
+             || type(node) == BinaryFormat::PropertyDrawerEntryNode
+             || type(node) == BinaryFormat::DrawerClosingEntryNode);
+    return d->property(node);
+}
+
+/** @brief The start time of a clock line node. */
+QDateTime BinaryDocument::startTime(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::ClockLineNode || type(node) == BinaryFormat::CompletedClockLineNode);
+    return d->time(d->field(node, Private::Field_First));
+}
+
+/** @brief The end time of a clock line node, invalid if the clock line is not completed. */
+QDateTime BinaryDocument::endTime(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::ClockLineNode || type(node) == BinaryFormat::CompletedClockLineNode);
+    return d->time(d->field(node, Private::Field_Second));
+}
+
+/** @brief The settings of a file node. */
+FileSettings BinaryDocument::fileSettings(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::OrgFileNode);
+    return d->fileSettings(d->field(node, Private::Field_Second));
+}
+
+/** @brief Build the element tree of the subtree of node. */
+OrgElement::Pointer BinaryDocument::toElement(int node) const
+{
+    Q_ASSERT(node >= 0 && node < d->nodeCount_);
+    QVector<QString> strings(d->stringCount_);
+    //The elements get an atom table of their own, as the elements of a parse result:
+    const AtomTable::Scope atoms(AtomTable::Pointer(new AtomTable));
+    //The elements of the open subtrees, the innermost last:
+    QVector<QPair<int, OrgElement::Pointer>> open;
+    const int end = subtreeEnd(node);
+    for (int current = node; current < end; ++current) {
+        while (!open.isEmpty() && current >= subtreeEnd(open.last().first)) {
+            open.removeLast();
+        }
+        //Elements are created in their parent, so that their atoms are interned in the table of the document:
+        OrgElement* const parent = open.isEmpty() ? nullptr : open.last().second.data();
+        const OrgElement::Pointer element = d->createElement(current, parent, &strings);
+        if (parent) {
+            parent->addChild(element);
+        }
+        open.append(qMakePair(current, element));
+    }
+    return open.first().second;
+}
+
+}
@@ -0,0 +1,76 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BINARYDOCUMENT_H
+#define BINARYDOCUMENT_H
+
+#include <memory>
+
+#include <QCoreApplication>
+#include <QByteArrayView>
+#include <QStringList>
+#include <QDateTime>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+#include <BinaryFormat.h>
+#include <Property.h>
+#include <FileSettings.h>
+
+namespace OrgMode {
+
+/** @brief BinaryDocument reads data in the BinaryFormat in place, without building elements.
+ *
+ * The structure of the data is verified when the document is created, the values of nodes are only decoded when
+ * they are accessed. The data is not copied and needs to stay valid while the document is used, which makes it
+ * possible to read memory mapped files. Nodes are identified by their index, the root node is 0.
+ */
+class ORGMODEPARSER_EXPORT BinaryDocument
+{
+    Q_DECLARE_TR_FUNCTIONS(BinaryDocument)
+public:
+    explicit BinaryDocument(QByteArrayView data);
+    BinaryDocument(BinaryDocument&&);
+    BinaryDocument& operator=(BinaryDocument&&);
+    ~BinaryDocument();
+
+    int nodeCount() const;
+    BinaryFormat::NodeType type(int node) const;
+    int parent(int node) const;
+    int subtreeEnd(int node) const;
+    int firstChild(int node) const;
+    int nextSibling(int node) const;
+
+    QString line(int node) const;
+    QString caption(int node) const;
+    QStringList tags(int node) const;
+    QString name(int node) const;
+    Property property(int node) const;
+    QDateTime startTime(int node) const;
+    QDateTime endTime(int node) const;
+    FileSettings fileSettings(int node) const;
+
+    OrgElement::Pointer toElement(int node = 0) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // BINARYDOCUMENT_H
@@ -0,0 +1,236 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QHash>
+#include <QVector>
+#include <QDateTime>
+#include <QtEndian>
+
+#include "BinaryFormat.h"
+#include "BinaryDocument.h"
+#include "Exception.h"
+#include "OrgFile.h"
+#include "Headline.h"
+#include "OrgLine.h"
+#include "FileAttributeLine.h"
+#include "ClockLine.h"
+#include "CompletedClockLine.h"
+#include "Drawer.h"
+#include "PropertyDrawer.h"
+#include "DrawerEntry.h"
+#include "PropertyDrawerEntry.h"
+#include "DrawerClosingEntry.h"
+
+namespace OrgMode {
+
+namespace {
+
+/** Collects the tables of the binary format while the tree is traversed. */
+class Builder
+{
+public:
+    void addElement(const OrgElement::Pointer& element, quint32 parent);
+    QByteArray data() const;
+
+private:
+    quint32 addString(const QString& string);
+    quint32 addTime(const QDateTime& time);
+    void setProperty(quint32 node, const Property& property);
+
+    QVector<quint32> nodes_;
+    QHash<QString, quint32> stringIds_;
+    QVector<quint32> strings_;
+    QString chars_;
+    QVector<quint32> lists_;
+    QVector<qint64> times_;
+};
+
+enum NodeField {
+    Field_Type,
+    Field_Parent,
+    Field_SubtreeEnd,
+    Field_Line,
+    Field_First,
+    Field_Second,
+    FieldCount
+};
+
+quint32 Builder::addString(const QString &string)
+{
+    if (string.isNull()) {
+        return BinaryFormat::None;
+    }
+    auto it = stringIds_.constFind(string);
+    if (it != stringIds_.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = quint32(strings_.size() / 2);
+    strings_.append(quint32(chars_.size()));
+    strings_.append(quint32(string.size()));
+    chars_.append(string);
+    stringIds_.insert(string, id);
+    return id;
+}
+
+quint32 Builder::addTime(const QDateTime &time)
+{
+    times_.append(time.isValid()
+                  ? time.date().toJulianDay() * 86400000 + time.time().msecsSinceStartOfDay()
+                  : BinaryFormat::InvalidTime);
+    return quint32(times_.size() - 1);
+}
+
+void Builder::setProperty(quint32 node, const Property &property)
+{
+    quint32* const fields = nodes_.data() + node * FieldCount;
+    fields[Field_Type] |= quint32(property.operation()) << 8;
+    fields[Field_First] = addString(property.key());
+    fields[Field_Second] = addString(property.value());
+}
+
+void Builder::addElement(const OrgElement::Pointer &element, quint32 parent)
+{
+    const quint32 node = quint32(nodes_.size() / FieldCount);
+    quint32 type;
+    quint32 first = BinaryFormat::None;
+    quint32 second = BinaryFormat::None;
+    const Property* property = nullptr;
+    Property entryProperty;
+    if (auto const file = element_cast<OrgFile>(element)) {
+        type = BinaryFormat::OrgFileNode;
+        first = addString(file->fileName());
+        const FileSettings::Vector attributes = file->fileSettings().attributes();
+        second = quint32(lists_.size());
+        lists_.append(quint32(attributes.count()));
+        for(auto const& attribute : attributes) {
+            lists_.append(addString(attribute.key()));
+            lists_.append(addString(attribute.value()));
+            lists_.append(quint32(attribute.operation()));
+        }
+    } else if (auto const headline = element_cast<Headline>(element)) {
+        type = BinaryFormat::HeadlineNode;
+        first = addString(headline->caption());
+        const Headline::Tags tags = headline->tags();
+        second = quint32(lists_.size());
+        lists_.append(quint32(tags.size()));
+        for(auto const& tag : tags) {
+            lists_.append(addString(tag));
+        }
+    } else if (auto const clockLine = element_cast<ClockLine>(element)) {
+        first = addTime(clockLine->startTime());
+        if (auto const completed = element_cast<CompletedClockLine>(clockLine)) {
+            type = BinaryFormat::CompletedClockLineNode;
+            second = addTime(completed->endTime());
+        } else {
+            type = BinaryFormat::ClockLineNode;
+        }
+    } else if (auto const drawer = element_cast<Drawer>(element)) {
+        type = element_cast<PropertyDrawer>(drawer) ? BinaryFormat::PropertyDrawerNode : BinaryFormat::DrawerNode;
+        first = addString(drawer->name());
+    } else if (auto const entry = element_cast<DrawerEntry>(element)) {
+        if (element_cast<DrawerClosingEntry>(entry)) {
+            type = BinaryFormat::DrawerClosingEntryNode;
+        } else if (element_cast<PropertyDrawerEntry>(entry)) {
+            type = BinaryFormat::PropertyDrawerEntryNode;
+        } else {
+            type = BinaryFormat::DrawerEntryNode;
+        }
+        entryProperty = entry->property();
+        property = &entryProperty;
+    } else if (auto const attributeLine = element_cast<FileAttributeLine>(element)) {
+        type = BinaryFormat::FileAttributeLineNode;
+        entryProperty = attributeLine->property();
+        property = &entryProperty;
+    } else if (element_cast<OrgLine>(element)) {
+        type = BinaryFormat::OrgLineNode;
+    } else {
+        throw RuntimeException(BinaryFormat::tr("Elements of this type cannot be serialized: %1")
+                               .arg(element->describe()));
+    }
+    nodes_ << type << parent << 0 << addString(element->line()) << first << second;
+    if (property) {
+        setProperty(node, *property);
+    }
+    for(auto const& child : element->childSpan()) {
+        addElement(child, node);
+    }
+    nodes_[node * FieldCount + Field_SubtreeEnd] = quint32(nodes_.size() / FieldCount);
+}
+
+void appendWords(QByteArray* data, const quint32* words, qsizetype count)
+{
+    const qsizetype offset = data->size();
+    data->resize(offset + count * 4);
+    for (qsizetype i = 0; i < count; ++i) {
+        qToLittleEndian<quint32>(words[i], data->data() + offset + i * 4);
+    }
+}
+
+QByteArray Builder::data() const
+{
+    const quint32 nodeCount = quint32(nodes_.size() / FieldCount);
+    const quint32 nodesOffset = BinaryFormat::HeaderSize;
+    const quint32 stringsOffset = nodesOffset + nodeCount * BinaryFormat::NodeSize;
+    const quint32 charsOffset = stringsOffset + quint32(strings_.size()) * 4;
+    const quint32 listsOffset = charsOffset + quint32(chars_.size()) * 2;
+    //Time stamps are aligned to 8 bytes:
+    const quint32 timesOffset = (listsOffset + quint32(lists_.size()) * 4 + 7) & ~7u;
+    const quint32 header[] = {
+        BinaryFormat::Magic, BinaryFormat::Version,
+        nodeCount, nodesOffset,
+        quint32(strings_.size() / 2), stringsOffset,
+        charsOffset, quint32(chars_.size()),
+        listsOffset, quint32(lists_.size()),
+        timesOffset, quint32(times_.size())
+    };
+    QByteArray data;
+    data.reserve(timesOffset + times_.size() * 8);
+    appendWords(&data, header, sizeof(header) / sizeof(header[0]));
+    appendWords(&data, nodes_.constData(), nodes_.size());
+    appendWords(&data, strings_.constData(), strings_.size());
+    const qsizetype chars = data.size();
+    data.resize(chars + chars_.size() * 2);
+    for (qsizetype i = 0; i < chars_.size(); ++i) {
+        qToLittleEndian<quint16>(chars_.at(i).unicode(), data.data() + chars + i * 2);
+    }
+    appendWords(&data, lists_.constData(), lists_.size());
+    data.resize(timesOffset + times_.size() * 8, '\0');
+    for (qsizetype i = 0; i < times_.size(); ++i) {
+        qToLittleEndian<qint64>(times_.at(i), data.data() + timesOffset + i * 8);
+    }
+    return data;
+}
+
+}
+
+/** @brief Serialize element and its children. The element becomes the root node. */
+QByteArray BinaryFormat::serialize(const OrgElement::Pointer &element)
+{
+    Q_ASSERT(element);
+    Builder builder;
+    builder.addElement(element, None);
+    return builder.data();
+}
+
+/** @brief Rebuild the element tree from serialized data. A RuntimeException is thrown if the data is invalid. */
+OrgElement::Pointer BinaryFormat::deserialize(QByteArrayView data)
+{
+    const BinaryDocument document(data);
+    return document.toElement();
+}
+
+}
@@ -0,0 +1,86 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BINARYFORMAT_H
+#define BINARYFORMAT_H
+
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+
+namespace OrgMode {
+
+/** @brief BinaryFormat converts element trees to and from a compact, versioned binary representation.
+ *
+ * All values are stored as little endian 32 bit integers, except time stamps, which are 64 bit. The data starts
+ * with a header of HeaderSize bytes:
+ *
+ *     magic, version, nodeCount, nodesOffset, stringCount, stringsOffset, charsOffset, charCount,
+ *     listsOffset, listCount, timesOffset, timeCount
+ *
+ * The nodes are stored in preorder, so that the subtree of every node is the range of nodes up to its subtree
+ * end. Every node takes NodeSize bytes:
+ *
+ *     type | operation << 8, parent, subtreeEnd, line, first, second
+ *
+ * Strings are stored once, in a string table of (offset, length) pairs into UTF-16 characters. The meaning of
+ * first and second depends on the type of the node: the caption and the list of tags of headlines, the key and
+ * value of attribute lines and drawer entries (with the operation of the property), the name of drawers, the time
+ * stamps of clock lines, and the file name and list of file attributes of files. Lists are stored as a count
+ * followed by the entries. Time stamps are stored as the Julian day times 86400000 plus the milliseconds of the
+ * day, so that local times are restored exactly.
+ *
+ * The data can be read in place, for example from a memory mapped file, with BinaryDocument.
+ */
+class ORGMODEPARSER_EXPORT BinaryFormat
+{
+    Q_DECLARE_TR_FUNCTIONS(BinaryFormat)
+public:
+    enum NodeType {
+        OrgFileNode,
+        HeadlineNode,
+        OrgLineNode,
+        FileAttributeLineNode,
+        ClockLineNode,
+        CompletedClockLineNode,
+        DrawerNode,
+        PropertyDrawerNode,
+        DrawerEntryNode,
+        PropertyDrawerEntryNode,
+        DrawerClosingEntryNode
+    };
+
+    //The text "OMPB", as a little endian integer:
+    static const quint32 Magic = 0x42504d4f;
+    static const quint32 Version = 1;
+    static const int HeaderSize = 12 * 4;
+    static const int NodeSize = 6 * 4;
+    //The string index of null strings, and the parent index of the root node:
+    static const quint32 None = 0xffffffff;
+    //The time stamp value of invalid times:
+    static const qint64 InvalidTime = Q_INT64_C(-0x7fffffffffffffff) - 1;
+
+    static QByteArray serialize(const OrgElement::Pointer& element);
+    static OrgElement::Pointer deserialize(QByteArrayView data);
+};
+
+}
+
+#endif // BINARYFORMAT_H
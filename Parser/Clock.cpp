@@ -25,7 +25,7 @@ namespace OrgMode {
 
 class Clock::Private {
 public:
-    int subduration(const TimeInterval & interval, OrgElement::Pointer element, bool withChildren, int depth = 0);
+    int subduration(const TimeInterval & interval, const OrgElement* element, bool withChildren, int depth = 0);
     OrgElement::Pointer element_;
 };
 
@@ -47,29 +47,28 @@ Clock::~Clock() = default;
 
 int Clock::duration(const TimeInterval& interval) const
 {
-    return d->subduration(interval, d->element_, true);
+    return d->subduration(interval, d->element_.data(), true);
 }
 
 int Clock::itemDuration(const TimeInterval &interval) const
 {
-    return d->subduration(interval, d->element_, false);
+    return d->subduration(interval, d->element_.data(), false);
 }
 
-int Clock::Private::subduration(const TimeInterval& interval, OrgElement::Pointer element, bool withChildren, int depth)
+int Clock::Private::subduration(const TimeInterval& interval, const OrgElement* element, bool withChildren, int depth)
 {
     int subtotal = 0;
     if (depth > 0 && withChildren == false) {
-        Headline* headline = dynamic_cast<Headline*>(element.data());
-        if (headline) {
+        if (element->isKindOf(OrgElement::HeadlineKind)) {
             return subtotal;
         }
     }
-    CompletedClockLine* clockLine = dynamic_cast<CompletedClockLine*>(element.data());
+    const CompletedClockLine* clockLine = element_cast<CompletedClockLine>(element);
     if (clockLine) {
         subtotal += clockLine->durationWithinInterval(interval);
     }
-    for (auto child : element->children()) {
-        subtotal += subduration(interval, child, withChildren, depth+1);
+    for (auto const& child : element->childSpan()) {
+        subtotal += subduration(interval, child.data(), withChildren, depth+1);
     }
     return subtotal;
 }
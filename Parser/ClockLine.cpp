@@ -16,10 +16,11 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "ClockLine.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class ClockLine::Private {
+class ClockLine::Private : public ArenaAllocated {
 public:
     QDateTime start_;
 };
@@ -28,6 +29,7 @@ ClockLine::ClockLine(const QString &line, OrgElement *parent)
     : OrgElement(line, parent)
     , d(new Private)
 {
+    setKind(ClockLineKind);
 }
 
 ClockLine::ClockLine(ClockLine && other) = default;
@@ -31,6 +31,7 @@ class ORGMODEPARSER_EXPORT ClockLine : public OrgElement
     Q_DECLARE_TR_FUNCTIONS(ClockLine)
 public:
     typedef QSharedPointer<ClockLine> Pointer;
+    static const Kind StaticKind = ClockLineKind;
 
     explicit ClockLine(const QString& line, OrgElement* parent = nullptr);
     explicit ClockLine(OrgElement* parent = nullptr);
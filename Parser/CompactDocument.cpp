@@ -0,0 +1,664 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <limits>
+
+#include <QPair>
+
+#include "CompactDocument.h"
+#include "Exception.h"
+#include "LineClassifier.h"
+#include "OrgFile.h"
+#include "Headline.h"
+#include "OrgLine.h"
+#include "FileAttributeLine.h"
+#include "ClockLine.h"
+#include "CompletedClockLine.h"
+#include "Drawer.h"
+#include "PropertyDrawer.h"
+#include "DrawerEntry.h"
+#include "PropertyDrawerEntry.h"
+#include "DrawerClosingEntry.h"
+#include "AtomTable.h"
+
+namespace OrgMode {
+
+struct CompactDocument::Private {
+    //A range of characters in strings_. The length of null strings is -1:
+    struct Span {
+        qsizetype offset;
+        qsizetype length;
+    };
+    struct HeadlineEntry {
+        Span caption;
+        int firstTag;
+        int tagCount;
+    };
+    //Times are milliseconds since the epoch, or BinaryFormat::InvalidTime:
+    struct ClockEntry {
+        qint64 start;
+        qint64 end;
+    };
+    struct PropertyEntry {
+        Span key;
+        Span value;
+        Property::Operation operation;
+    };
+    struct FileEntry {
+        Span name;
+        int firstAttribute;
+        int attributeCount;
+    };
+
+    int addNode(BinaryFormat::NodeType type, int payload, QStringView line);
+    void closeNode();
+    Span addString(QStringView string);
+    QStringView string(const Span& span) const;
+    int addHeadline(QStringView caption, const Headline::Tags& tags);
+    int addClock(const QDateTime& start, const QDateTime& end);
+    int addProperty(const Property& property);
+    int addName(QStringView name);
+    int addFile(const QString& name, const FileSettings& settings);
+    void addElement(const OrgElement::Pointer& element);
+    Property property(int entry) const;
+    OrgElement::Pointer createElement(int node, OrgElement* parent) const;
+    int duration(int node, const TimeInterval& interval, bool withChildren) const;
+
+    QVector<quint8> types_;
+    QVector<int> depths_;
+    QVector<int> parents_;
+    QVector<int> subtreeEnds_;
+    //The index of the values of a node in the side table of its type, or -1:
+    QVector<int> payloads_;
+    //The line of node n is the range from lineOffsets_[n] to lineOffsets_[n + 1] in lines_:
+    QVector<qsizetype> lineOffsets_ = QVector<qsizetype>() << 0;
+    QString lines_;
+    QString strings_;
+    QVector<HeadlineEntry> headlines_;
+    QVector<Span> tags_;
+    QVector<ClockEntry> clocks_;
+    QVector<PropertyEntry> properties_;
+    QVector<Span> names_;
+    QVector<FileEntry> files_;
+    //The nodes that are being built, the innermost last:
+    QVector<int> open_;
+};
+
+namespace {
+
+qint64 toTime(const QDateTime& time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : BinaryFormat::InvalidTime;
+}
+
+QDateTime fromTime(qint64 time)
+{
+    return time == BinaryFormat::InvalidTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(time);
+}
+
+/** The duration in seconds of the intersection of [start, end[ and [from, to[, as TimeInterval calculates it. */
+long intersectionDuration(qint64 start, qint64 end, qint64 from, qint64 to)
+{
+    //Invalid times are smaller than all valid times, as for QDateTime:
+    const qint64 invalid = BinaryFormat::InvalidTime;
+    qint64 s = start;
+    qint64 e = end;
+    if (from == invalid && to == invalid) {
+        //The interval is open on both sides, the intersection is the clock itself
+    } else if (start == invalid && end == invalid) {
+        s = from;
+        e = to;
+    } else {
+        s = qMax(start != invalid ? start : from, from != invalid ? from : start);
+        e = qMin(end != invalid ? end : to, to != invalid ? to : end);
+        if (e != invalid) {
+            e = qMax(e, s);
+        }
+    }
+    if (s != invalid && e != invalid && s > e) {
+        return 0;
+    }
+    if (s == invalid || e == invalid) {
+        return std::numeric_limits<int>::max();
+    }
+    return long((e - s) / 1000);
+}
+
+}
+
+int CompactDocument::Private::addNode(BinaryFormat::NodeType type, int payload, QStringView line)
+{
+    const int node = int(types_.size());
+    types_.append(quint8(type));
+    depths_.append(int(open_.size()));
+    parents_.append(open_.isEmpty() ? -1 : open_.last());
+    subtreeEnds_.append(node + 1);
+    payloads_.append(payload);
+    lines_.append(line);
+    lineOffsets_.append(lines_.size());
+    return node;
+}
+
+/** Close the innermost open node, after all its children have been added. */
+void CompactDocument::Private::closeNode()
+{
+    subtreeEnds_[open_.takeLast()] = int(types_.size());
+}
+
+CompactDocument::Private::Span CompactDocument::Private::addString(QStringView string)
+{
+    if (string.isNull()) {
+        return Span{0, -1};
+    }
+    const Span span{strings_.size(), string.size()};
+    strings_.append(string);
+    return span;
+}
+
+QStringView CompactDocument::Private::string(const Span &span) const
+{
+    if (span.length < 0) {
+        return QStringView();
+    }
+    return QStringView(strings_.constData() + span.offset, span.length);
+}
+
+int CompactDocument::Private::addHeadline(QStringView caption, const Headline::Tags &tags)
+{
+    headlines_.append(HeadlineEntry{addString(caption), int(tags_.size()), int(tags.size())});
+    for(auto const& tag : tags) {
+        tags_.append(addString(tag));
+    }
+    return int(headlines_.size()) - 1;
+}
+
+int CompactDocument::Private::addClock(const QDateTime &start, const QDateTime &end)
+{
+    clocks_.append(ClockEntry{toTime(start), toTime(end)});
+    return int(clocks_.size()) - 1;
+}
+
+int CompactDocument::Private::addProperty(const Property &property)
+{
+    properties_.append(PropertyEntry{addString(property.key()), addString(property.value()), property.operation()});
+    return int(properties_.size()) - 1;
+}
+
+int CompactDocument::Private::addName(QStringView name)
+{
+    names_.append(addString(name));
+    return int(names_.size()) - 1;
+}
+
+int CompactDocument::Private::addFile(const QString &name, const FileSettings &settings)
+{
+    const FileSettings::Vector attributes = settings.attributes();
+    files_.append(FileEntry{addString(name), int(properties_.size()), int(attributes.count())});
+    for(auto const& attribute : attributes) {
+        addProperty(attribute);
+    }
+    return int(files_.size()) - 1;
+}
+
+/** @brief Add element and its children, in preorder. */
+void CompactDocument::Private::addElement(const OrgElement::Pointer &element)
+{
+    BinaryFormat::NodeType type;
+    int payload = -1;
+    if (auto const file = element_cast<OrgFile>(element)) {
+        type = BinaryFormat::OrgFileNode;
+        payload = addFile(file->fileName(), file->fileSettings());
+    } else if (auto const headline = element_cast<Headline>(element)) {
+        type = BinaryFormat::HeadlineNode;
+        payload = addHeadline(headline->caption(), headline->tags());
+    } else if (auto const clockLine = element_cast<ClockLine>(element)) {
+        auto const completed = element_cast<CompletedClockLine>(clockLine);
+        type = completed ? BinaryFormat::CompletedClockLineNode : BinaryFormat::ClockLineNode;
+        payload = addClock(clockLine->startTime(), completed ? completed->endTime() : QDateTime());
+    } else if (auto const drawer = element_cast<Drawer>(element)) {
+        type = element_cast<PropertyDrawer>(drawer) ? BinaryFormat::PropertyDrawerNode : BinaryFormat::DrawerNode;
+        payload = addName(drawer->name());
+    } else if (auto const entry = element_cast<DrawerEntry>(element)) {
+        if (element_cast<DrawerClosingEntry>(entry)) {
+            type = BinaryFormat::DrawerClosingEntryNode;
+        } else if (element_cast<PropertyDrawerEntry>(entry)) {
+            type = BinaryFormat::PropertyDrawerEntryNode;
+        } else {
+            type = BinaryFormat::DrawerEntryNode;
+        }
+        payload = addProperty(entry->property());
+    } else if (auto const attributeLine = element_cast<FileAttributeLine>(element)) {
+        type = BinaryFormat::FileAttributeLineNode;
+        payload = addProperty(attributeLine->property());
+    } else if (element_cast<OrgLine>(element)) {
+        type = BinaryFormat::OrgLineNode;
+    } else {
+        throw RuntimeException(CompactDocument::tr("Elements of this type cannot be converted: %1")
+                               .arg(element->describe()));
+    }
+    open_.append(addNode(type, payload, element->line()));
+    for(auto const& child : element->childSpan()) {
+        addElement(child);
+    }
+    closeNode();
+}
+
+Property CompactDocument::Private::property(int entry) const
+{
+    const PropertyEntry& property = properties_.at(entry);
+    return Property(string(property.key).toString(), string(property.value).toString(), property.operation);
+}
+
+/** @brief Create the element of node, with its values. */
+OrgElement::Pointer CompactDocument::Private::createElement(int node, OrgElement* parent) const
+{
+    const QString line = QStringView(lines_).mid(lineOffsets_.at(node),
+                                                 lineOffsets_.at(node + 1) - lineOffsets_.at(node)).toString();
+    const int payload = payloads_.at(node);
+    const BinaryFormat::NodeType type = BinaryFormat::NodeType(types_.at(node));
+    switch (type) {
+    case BinaryFormat::OrgFileNode: {
+        const FileEntry& entry = files_.at(payload);
+        auto const file = OrgFile::Pointer(new OrgFile(parent));
+        file->setFileName(string(entry.name).toString());
+        FileSettings settings;
+        for (int attribute = 0; attribute < entry.attributeCount; ++attribute) {
+            settings.addAttribute(property(entry.firstAttribute + attribute));
+        }
+        file->setFileSettings(settings);
+        return file;
+    }
+    case BinaryFormat::HeadlineNode: {
+        const HeadlineEntry& entry = headlines_.at(payload);
+        auto const headline = Headline::Pointer(new Headline(line, parent));
+        headline->setCaption(string(entry.caption).toString());
+        Headline::Tags tags;
+        for (int tag = 0; tag < entry.tagCount; ++tag) {
+            tags.insert(string(tags_.at(entry.firstTag + tag)).toString());
+        }
+        headline->setTags(tags);
+        return headline;
+    }
+    case BinaryFormat::ClockLineNode: {
+        auto const clockLine = ClockLine::Pointer(new ClockLine(line, parent));
+        clockLine->setStartTime(fromTime(clocks_.at(payload).start));
+        return clockLine;
+    }
+    case BinaryFormat::CompletedClockLineNode: {
+        auto const clockLine = CompletedClockLine::Pointer(new CompletedClockLine(line, parent));
+        clockLine->setStartTime(fromTime(clocks_.at(payload).start));
+        clockLine->setEndTime(fromTime(clocks_.at(payload).end));
+        return clockLine;
+    }
+    case BinaryFormat::DrawerNode:
+    case BinaryFormat::PropertyDrawerNode: {
+        Drawer::Pointer drawer(type == BinaryFormat::PropertyDrawerNode ? new PropertyDrawer(line, parent)
+                                                                        : new Drawer(line, parent));
+        drawer->setName(string(names_.at(payload)).toString());
+        return drawer;
+    }
+    case BinaryFormat::FileAttributeLineNode: {
+        auto const attributeLine = FileAttributeLine::Pointer(new FileAttributeLine(line, parent));
+        attributeLine->setProperty(property(payload));
+        return attributeLine;
+    }
+    case BinaryFormat::DrawerEntryNode:
+    case BinaryFormat::PropertyDrawerEntryNode:
+    case BinaryFormat::DrawerClosingEntryNode: {
+        DrawerEntry::Pointer entry;
+        if (type == BinaryFormat::DrawerClosingEntryNode) {
+            entry.reset(new DrawerClosingEntry(line, parent));
+        } else if (type == BinaryFormat::PropertyDrawerEntryNode) {
+            entry.reset(new PropertyDrawerEntry(line, parent));
+        } else {
+            entry.reset(new DrawerEntry(line, parent));
+        }
+        entry->setProperty(property(payload));
+        return entry;
+    }
+    case BinaryFormat::OrgLineNode:
+        break;
+    }
+    return OrgElement::Pointer(new OrgLine(line, parent));
+}
+
+/** @brief Sum up the completed clock lines in the subtree of node, like Clock::duration() does. */
+int CompactDocument::Private::duration(int node, const TimeInterval &interval, bool withChildren) const
+{
+    const qint64 from = toTime(interval.start());
+    const qint64 to = toTime(interval.end());
+    const quint8* const types = types_.constData();
+    const int* const subtreeEnds = subtreeEnds_.constData();
+    const int* const payloads = payloads_.constData();
+    const ClockEntry* const clocks = clocks_.constData();
+    int total = 0;
+    const int end = subtreeEnds[node];
+    for (int current = node; current < end;) {
+        const quint8 type = types[current];
+        if (!withChildren && current != node && type == BinaryFormat::HeadlineNode) {
+            //Skip the subtree of the child headline:
+            current = subtreeEnds[current];
+            continue;
+        }
+        if (type == BinaryFormat::CompletedClockLineNode) {
+            const ClockEntry& clock = clocks[payloads[current]];
+            total += int(intersectionDuration(clock.start, clock.end, from, to));
+        }
+        ++current;
+    }
+    return total;
+}
+
+/** @brief An empty document, without nodes. */
+CompactDocument::CompactDocument()
+    : d(new Private)
+{
+}
+
+/** @brief Convert the element tree of element. The element becomes the root node. */
+CompactDocument::CompactDocument(const OrgElement::Pointer &element)
+    : CompactDocument()
+{
+    Q_ASSERT(element);
+    d->addElement(element);
+}
+
+CompactDocument::CompactDocument(const CompactDocument& other)
+    : d(new Private)
+{
+    *d = *(other.d);
+}
+
+CompactDocument::CompactDocument(CompactDocument && other) = default;
+CompactDocument& CompactDocument::operator=(CompactDocument &&other) = default;
+CompactDocument::~CompactDocument() = default;
+
+int CompactDocument::nodeCount() const
+{
+    return int(d->types_.size());
+}
+
+BinaryFormat::NodeType CompactDocument::type(int node) const
+{
+    return BinaryFormat::NodeType(d->types_.at(node));
+}
+
+/** @brief The number of ancestors of node, as OrgElement::level() counts them. */
+int CompactDocument::depth(int node) const
+{
+    return d->depths_.at(node);
+}
+
+/** @brief The index of the parent node, or -1 for the root node. */
+int CompactDocument::parent(int node) const
+{
+    return d->parents_.at(node);
+}
+
+/** @brief The index after the last node in the subtree of node. */
+int CompactDocument::subtreeEnd(int node) const
+{
+    return d->subtreeEnds_.at(node);
+}
+
+/** @brief The index of the first child of node, or -1 if it has no children. */
+int CompactDocument::firstChild(int node) const
+{
+    return node + 1 < subtreeEnd(node) ? node + 1 : -1;
+}
+
+/** @brief The index of the next child of the parent of node, or -1 if node is the last child. */
+int CompactDocument::nextSibling(int node) const
+{
+    const int parent = this->parent(node);
+    const int next = subtreeEnd(node);
+    return parent >= 0 && next < subtreeEnd(parent) ? next : -1;
+}
+
+QStringView CompactDocument::line(int node) const
+{
+    const qsizetype offset = d->lineOffsets_.at(node);
+    return QStringView(d->lines_).mid(offset, d->lineOffsets_.at(node + 1) - offset);
+}
+
+/** @brief The caption of a headline node. */
+QStringView CompactDocument::caption(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::HeadlineNode);
+    return d->string(d->headlines_.at(d->payloads_.at(node)).caption);
+}
+
+/** @brief The tags of a headline node, in the order of Headline::tags(). */
+QStringList CompactDocument::tags(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::HeadlineNode);
+    const Private::HeadlineEntry& entry = d->headlines_.at(d->payloads_.at(node));
+    QStringList tags;
+    for (int tag = 0; tag < entry.tagCount; ++tag) {
+        tags.append(d->string(d->tags_.at(entry.firstTag + tag)).toString());
+    }
+    return tags;
+}
+
+/** @brief Return true if the headline node has the tag, without creating any strings. */
+bool CompactDocument::hasTag(int node, QStringView tag) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::HeadlineNode);
+    const Private::HeadlineEntry& entry = d->headlines_.at(d->payloads_.at(node));
+    for (int index = 0; index < entry.tagCount; ++index) {
+        if (d->string(d->tags_.at(entry.firstTag + index)) == tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief The name of a drawer node, or the file name of a file node. */
+QStringView CompactDocument::name(int node) const
+{
+    if (type(node) == BinaryFormat::OrgFileNode) {
+        return d->string(d->files_.at(d->payloads_.at(node)).name);
+    }
+    Q_ASSERT(type(node) == BinaryFormat::DrawerNode || type(node) == BinaryFormat::PropertyDrawerNode);
+    return d->string(d->names_.at(d->payloads_.at(node)));
+}
+
+/** @brief The property of a file attribute line or drawer entry node. */
+Property CompactDocument::property(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::FileAttributeLineNode || type(node) == BinaryFormat::DrawerEntryNode
+             || type(node) == BinaryFormat::PropertyDrawerEntryNode
+             || type(node) == BinaryFormat::DrawerClosingEntryNode);
+    return d->property(d->payloads_.at(node));
+}
+
+/** @brief The start time of a clock line node. */
+QDateTime CompactDocument::startTime(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::ClockLineNode || type(node) == BinaryFormat::CompletedClockLineNode);
+    return fromTime(d->clocks_.at(d->payloads_.at(node)).start);
+}
+
+/** @brief The end time of a clock line node, invalid if the clock line is not completed. */
+QDateTime CompactDocument::endTime(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::ClockLineNode || type(node) == BinaryFormat::CompletedClockLineNode);
+    return fromTime(d->clocks_.at(d->payloads_.at(node)).end);
+}
+
+/** @brief The settings of a file node. */
+FileSettings CompactDocument::fileSettings(int node) const
+{
+    Q_ASSERT(type(node) == BinaryFormat::OrgFileNode);
+    const Private::FileEntry& entry = d->files_.at(d->payloads_.at(node));
+    FileSettings settings;
+    for (int attribute = 0; attribute < entry.attributeCount; ++attribute) {
+        settings.addAttribute(d->property(entry.firstAttribute + attribute));
+    }
+    return settings;
+}
+
+/** @brief Find the nodes of a type in the subtree of node, in preorder, where predicate returns true.
+ *
+ * The predicate is only called for nodes of the type. Without a predicate, all nodes of the type are returned.
+ */
+QVector<int> CompactDocument::findNodes(BinaryFormat::NodeType type, const Predicate &predicate, int node) const
+{
+    QVector<int> matches;
+    if (d->types_.isEmpty()) {
+        return matches;
+    }
+    const quint8* const types = d->types_.constData();
+    const int end = subtreeEnd(node);
+    for (int current = node; current < end; ++current) {
+        if (types[current] == type && (!predicate || predicate(current))) {
+            matches.append(current);
+        }
+    }
+    return matches;
+}
+
+/** @brief The duration of all completed clock lines in the subtree of node within interval, in seconds.
+ *
+ * @see Clock::duration()
+ */
+int CompactDocument::duration(int node, const TimeInterval &interval) const
+{
+    return d->duration(node, interval, true);
+}
+
+/** @brief The duration of the completed clock lines of node within interval, without child headlines.
+ *
+ * @see Clock::itemDuration()
+ */
+int CompactDocument::itemDuration(int node, const TimeInterval &interval) const
+{
+    return d->duration(node, interval, false);
+}
+
+/** @brief Build the element tree of the subtree of node. */
+OrgElement::Pointer CompactDocument::toElement(int node) const
+{
+    Q_ASSERT(node >= 0 && node < nodeCount());
+    //The elements get an atom table of their own, as the elements of a parse result:
+    const AtomTable::Scope atoms(AtomTable::Pointer(new AtomTable));
+    //The elements of the open subtrees, the innermost last:
+    QVector<QPair<int, OrgElement::Pointer>> open;
+    const int end = subtreeEnd(node);
+    for (int current = node; current < end; ++current) {
+        while (!open.isEmpty() && current >= subtreeEnd(open.last().first)) {
+            open.removeLast();
+        }
+        //Elements are created in their parent, so that their atoms are interned in the table of the document:
+        OrgElement* const parent = open.isEmpty() ? nullptr : open.last().second.data();
+        const OrgElement::Pointer element = d->createElement(current, parent);
+        if (parent) {
+            parent->addChild(element);
+        }
+        open.append(qMakePair(current, element));
+    }
+    return open.first().second;
+}
+
+struct CompactDocument::Builder::Private {
+    CompactDocument document_;
+};
+
+/** @brief A builder for a document with a file node as the root node. */
+CompactDocument::Builder::Builder(const QString &fileName, const FileSettings &settings)
+    : d(new Private)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    document->open_.append(document->addNode(BinaryFormat::OrgFileNode, document->addFile(fileName, settings),
+                                             QStringView()));
+}
+
+CompactDocument::Builder::~Builder() = default;
+
+void CompactDocument::Builder::onHeadline(int, QStringView caption, const QStringList &tags, QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    //Headlines keep their tags as a set:
+    const Headline::Tags tagSet(tags.begin(), tags.end());
+    document->open_.append(document->addNode(BinaryFormat::HeadlineNode, document->addHeadline(caption, tagSet),
+                                             line));
+}
+
+void CompactDocument::Builder::onHeadlineEnd(int)
+{
+    d->document_.d->closeNode();
+}
+
+void CompactDocument::Builder::onClockLine(const QDateTime &start, const QDateTime &end, QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    document->addNode(end.isValid() ? BinaryFormat::CompletedClockLineNode : BinaryFormat::ClockLineNode,
+                      document->addClock(start, end), line);
+}
+
+void CompactDocument::Builder::onFileAttribute(const Property &attribute, QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    document->addNode(BinaryFormat::FileAttributeLineNode, document->addProperty(attribute), line);
+}
+
+void CompactDocument::Builder::onDrawerBegin(QStringView name, QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    const BinaryFormat::NodeType type = name == QLatin1String("PROPERTIES") ? BinaryFormat::PropertyDrawerNode
+                                                                            : BinaryFormat::DrawerNode;
+    document->open_.append(document->addNode(type, document->addName(name), line));
+}
+
+void CompactDocument::Builder::onDrawerEntry(const Property &entry, QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    const BinaryFormat::NodeType type = document->types_.at(document->open_.last()) == BinaryFormat::PropertyDrawerNode
+            ? BinaryFormat::PropertyDrawerEntryNode : BinaryFormat::DrawerEntryNode;
+    document->addNode(type, document->addProperty(entry), line);
+}
+
+void CompactDocument::Builder::onDrawerEnd(QStringView line)
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    if (!line.isNull()) {
+        //The closing entry is an entry with the key END, as in the element tree:
+        QStringView name;
+        QStringView value;
+        LineClassifier::matchDrawerEntry(line, &name, &value);
+        document->addNode(BinaryFormat::DrawerClosingEntryNode,
+                          document->addProperty(Property(name.toString(), value.toString())), line);
+    }
+    document->closeNode();
+}
+
+void CompactDocument::Builder::onLine(QStringView line)
+{
+    d->document_.d->addNode(BinaryFormat::OrgLineNode, -1, line);
+}
+
+/** @brief Finish the document and return it. The builder cannot be used afterwards. */
+CompactDocument CompactDocument::Builder::document()
+{
+    CompactDocument::Private* const document = d->document_.d.get();
+    while (!document->open_.isEmpty()) {
+        document->closeNode();
+    }
+    return std::move(d->document_);
+}
+
+}
@@ -0,0 +1,124 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef COMPACTDOCUMENT_H
+#define COMPACTDOCUMENT_H
+
+#include <memory>
+#include <functional>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QStringView>
+#include <QDateTime>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+#include <OrgEventHandler.h>
+#include <BinaryFormat.h>
+#include <Property.h>
+#include <FileSettings.h>
+#include <TimeInterval.h>
+
+namespace OrgMode {
+
+/** @brief CompactDocument is an immutable representation of an element tree in flat arrays.
+ *
+ * The nodes are stored in preorder, as in the BinaryFormat. The kind, depth, parent and subtree end of the nodes
+ * are kept in one array each, the lines are concatenated into one string, and the values of headlines, clock
+ * lines, drawers, properties and files are kept in side tables. Traversals and queries run over the arrays
+ * without following pointers, which makes them much faster than on the element tree for large files. Nodes are
+ * identified by their index, the root node is 0. The string views that are returned stay valid as long as the
+ * document exists.
+ *
+ * Documents are created from element trees, or directly by the parser, see Parser::parseCompact().
+ */
+class ORGMODEPARSER_EXPORT CompactDocument
+{
+    Q_DECLARE_TR_FUNCTIONS(CompactDocument)
+public:
+    typedef std::function<bool(int node)> Predicate;
+
+    class Builder;
+
+    CompactDocument();
+    explicit CompactDocument(const OrgElement::Pointer& element);
+    CompactDocument(const CompactDocument&);
+    CompactDocument(CompactDocument&&);
+    CompactDocument& operator=(CompactDocument&&);
+    ~CompactDocument();
+
+    int nodeCount() const;
+    BinaryFormat::NodeType type(int node) const;
+    int depth(int node) const;
+    int parent(int node) const;
+    int subtreeEnd(int node) const;
+    int firstChild(int node) const;
+    int nextSibling(int node) const;
+
+    QStringView line(int node) const;
+    QStringView caption(int node) const;
+    QStringList tags(int node) const;
+    bool hasTag(int node, QStringView tag) const;
+    QStringView name(int node) const;
+    Property property(int node) const;
+    QDateTime startTime(int node) const;
+    QDateTime endTime(int node) const;
+    FileSettings fileSettings(int node) const;
+
+    QVector<int> findNodes(BinaryFormat::NodeType type, const Predicate& predicate = Predicate(),
+                           int node = 0) const;
+    int duration(int node = 0, const TimeInterval& interval = TimeInterval()) const;
+    int itemDuration(int node, const TimeInterval& interval = TimeInterval()) const;
+
+    OrgElement::Pointer toElement(int node = 0) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+/** @brief Builder creates a CompactDocument from the events of the parser.
+ *
+ * The file name and settings of the document are passed to the builder, since the events do not report them.
+ */
+class ORGMODEPARSER_EXPORT CompactDocument::Builder : public OrgEventHandler
+{
+public:
+    explicit Builder(const QString& fileName = QString(), const FileSettings& settings = FileSettings());
+    ~Builder() override;
+
+    void onHeadline(int level, QStringView caption, const QStringList& tags, QStringView line) override;
+    void onHeadlineEnd(int level) override;
+    void onClockLine(const QDateTime& start, const QDateTime& end, QStringView line) override;
+    void onFileAttribute(const Property& attribute, QStringView line) override;
+    void onDrawerBegin(QStringView name, QStringView line) override;
+    void onDrawerEntry(const Property& entry, QStringView line) override;
+    void onDrawerEnd(QStringView line) override;
+    void onLine(QStringView line) override;
+
+    CompactDocument document();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // COMPACTDOCUMENT_H
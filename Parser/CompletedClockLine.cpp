@@ -16,11 +16,12 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "CompletedClockLine.h"
+#include "Arena.h"
 #include "TimeInterval.h"
 
 namespace OrgMode {
 
-class CompletedClockLine::Private {
+class CompletedClockLine::Private : public ArenaAllocated {
 public:
     QDateTime end_;
 };
@@ -29,7 +30,7 @@ CompletedClockLine::CompletedClockLine(const QString &line, OrgElement *parent)
     : ClockLine(line, parent)
     , d(new Private)
 {
-
+    setKind(CompletedClockLineKind);
 }
 
 CompletedClockLine::CompletedClockLine(OrgElement *parent)
@@ -36,6 +36,7 @@ class ORGMODEPARSER_EXPORT CompletedClockLine : public ClockLine
     Q_DECLARE_TR_FUNCTIONS(CompletedClockLine)
 public:
     typedef QSharedPointer<CompletedClockLine> Pointer;
+    static const Kind StaticKind = CompletedClockLineKind;
 
     explicit CompletedClockLine(const QString& line, OrgElement* parent = nullptr);
     explicit CompletedClockLine(OrgElement* parent = nullptr);
@@ -16,12 +16,16 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "Drawer.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class Drawer::Private {
+class Drawer::Private : public ArenaAllocated {
 public:
-    QString name_;
+    Private()
+        : name_(AtomTable::InvalidAtom)
+    {}
+    AtomTable::Atom name_;
 };
 
 Drawer::Drawer(OrgElement *parent)
@@ -33,6 +37,7 @@ Drawer::Drawer(const QString &line, OrgElement *parent)
     : OrgElement(line, parent)
     , d(new Private())
 {
+    setKind(DrawerKind);
 }
 
 Drawer::Drawer(Drawer && other) = default;
@@ -41,12 +46,25 @@ Drawer::~Drawer() = default;
 
 QString Drawer::name() const
 {
-    return d->name_;
+    return atomTable()->string(d->name_);
 }
 
 void Drawer::setName(const QString &name)
 {
-    d->name_ = name;
+    d->name_ = atomTable()->intern(name);
+}
+
+/** @brief The atom of the name of the drawer, in the atom table of the drawer. */
+AtomTable::Atom Drawer::nameAtom() const
+{
+    return d->name_;
+}
+
+void Drawer::atomTableChanged(const AtomTable::Pointer &previous)
+{
+    if (d->name_ != AtomTable::InvalidAtom) {
+        d->name_ = atomTable()->intern(previous->string(d->name_));
+    }
 }
 
 bool Drawer::isElementValid() const
@@ -23,6 +23,7 @@
 #include <QCoreApplication>
 
 #include <OrgElement.h>
+#include <AtomTable.h>
 #include "orgmodeparser_export.h"
 
 namespace OrgMode {
@@ -32,6 +33,7 @@ class ORGMODEPARSER_EXPORT Drawer : public OrgElement
     Q_DECLARE_TR_FUNCTIONS(Drawer)
 public:
     typedef QSharedPointer<Drawer> Pointer;
+    static const Kind StaticKind = DrawerKind;
 
     explicit Drawer(OrgElement* parent = nullptr);
     explicit Drawer(const QString& line, OrgElement* parent = nullptr);
@@ -42,8 +44,10 @@ public:
 
     QString name() const;
     void setName(const QString& name);
+    AtomTable::Atom nameAtom() const;
 
 protected:
+    void atomTableChanged(const AtomTable::Pointer& previous) override;
     bool isElementValid() const override;
     QString mnemonic() const override;
     QString description() const override;
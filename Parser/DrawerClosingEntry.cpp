@@ -16,15 +16,16 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "DrawerClosingEntry.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class DrawerClosingEntry::Private {
+class DrawerClosingEntry::Private : public ArenaAllocated {
 public:
 };
 
 DrawerClosingEntry::DrawerClosingEntry(OrgMode::OrgElement *parent)
-    : DrawerEntry(QString(), parent)
+    : DrawerClosingEntry(QString(), parent)
 {
 }
 
@@ -32,7 +33,7 @@ DrawerClosingEntry::DrawerClosingEntry(const QString &line, OrgMode::OrgElement
     : DrawerEntry(line, parent)
     , d(new Private)
 {
-
+    setKind(DrawerClosingEntryKind);
 }
 
 DrawerClosingEntry::DrawerClosingEntry(DrawerClosingEntry && other) = default;
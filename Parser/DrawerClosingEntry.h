@@ -32,6 +32,7 @@ class DrawerClosingEntry : public DrawerEntry
     Q_DECLARE_TR_FUNCTIONS(DrawerClosingEntry)
 public:
     typedef QSharedPointer<DrawerClosingEntry> Pointer;
+    static const Kind StaticKind = DrawerClosingEntryKind;
 
     explicit DrawerClosingEntry(OrgElement* parent = nullptr);
     explicit DrawerClosingEntry(const QString& line, OrgElement* parent = nullptr);
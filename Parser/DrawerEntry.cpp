@@ -16,10 +16,11 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "DrawerEntry.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class DrawerEntry::Private {
+class DrawerEntry::Private : public ArenaAllocated {
 public:
 };
 
@@ -32,6 +33,7 @@ DrawerEntry::DrawerEntry(const QString &line, OrgMode::OrgElement *parent)
     : AttributeLine(line, parent)
     , d(new Private)
 {
+    setKind(DrawerEntryKind);
 }
 
 DrawerEntry::DrawerEntry(DrawerEntry && other) = default;
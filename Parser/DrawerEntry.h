@@ -32,6 +32,7 @@ class ORGMODEPARSER_EXPORT DrawerEntry : public AttributeLine
     Q_DECLARE_TR_FUNCTIONS(DrawerEntry)
 public:
     typedef QSharedPointer<DrawerEntry> Pointer;
+    static const Kind StaticKind = DrawerEntryKind;
 
     explicit DrawerEntry(OrgElement* parent = nullptr);
     explicit DrawerEntry(const QString& line, OrgElement* parent = nullptr);
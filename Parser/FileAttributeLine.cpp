@@ -16,10 +16,11 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "FileAttributeLine.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class FileAttributeLine::Private {
+class FileAttributeLine::Private : public ArenaAllocated {
 public:
 };
 
@@ -32,6 +33,7 @@ FileAttributeLine::FileAttributeLine(const QString &line, OrgElement *parent)
     : AttributeLine(line, parent)
     , d(new Private)
 {
+    setKind(FileAttributeLineKind);
 }
 
 FileAttributeLine::FileAttributeLine(FileAttributeLine && other) = default;
@@ -32,6 +32,7 @@ class ORGMODEPARSER_EXPORT FileAttributeLine : public AttributeLine
     Q_DECLARE_TR_FUNCTIONS(FileAttributeLine)
 public:
     typedef QSharedPointer<FileAttributeLine> Pointer;
+    static const Kind StaticKind = FileAttributeLineKind;
     typedef QList<Pointer> List;
 
     explicit FileAttributeLine(OrgElement* parent = nullptr);
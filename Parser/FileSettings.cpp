@@ -0,0 +1,192 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QSet>
+
+#include "FileSettings.h"
+#include "Properties.h"
+
+namespace OrgMode {
+
+namespace {
+
+QStringList splitWords(const QString& value)
+{
+    return value.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+}
+
+/** Remove the fast access key from a keyword, as in "TODO(t)" or "@work(w)". */
+QString withoutAccessKey(const QString& word)
+{
+    const int bracket = word.indexOf(QLatin1Char('('));
+    return bracket > 0 && word.endsWith(QLatin1Char(')')) ? word.left(bracket) : word;
+}
+
+}
+
+struct FileSettings::Private {
+    QStringList drawerNames_ = QStringList() << QStringLiteral("PROPERTIES");
+    QSet<QString> drawerNameSet_ = QSet<QString>() << QStringLiteral("PROPERTIES");
+    QStringList todoKeywords_;
+    QStringList doneKeywords_;
+    QStringList tags_;
+    QStringList fileTags_;
+    QString category_;
+    Vector properties_;
+    Vector attributes_;
+
+    void addTodoKeywords(const QString& value);
+};
+
+/** Keywords before a "|" are TODO keywords, those after are DONE keywords. Without a "|", the last keyword is a
+ * DONE keyword. */
+void FileSettings::Private::addTodoKeywords(const QString& value)
+{
+    const QStringList words = splitWords(value);
+    const int separator = words.indexOf(QStringLiteral("|"));
+    const int firstDone = separator >= 0 ? separator : words.count() - 1;
+    for (int i = 0; i < words.count(); ++i) {
+        if (i < firstDone) {
+            todoKeywords_.append(withoutAccessKey(words.at(i)));
+        } else if (i != separator) {
+            doneKeywords_.append(withoutAccessKey(words.at(i)));
+        }
+    }
+}
+
+FileSettings::FileSettings()
+    : d(new Private)
+{
+}
+
+FileSettings::FileSettings(const FileSettings &other)
+    : d(new Private(*other.d))
+{
+}
+
+FileSettings& FileSettings::operator=(const FileSettings &other)
+{
+    if (this != &other) {
+        *d = *other.d;
+    }
+    return *this;
+}
+
+FileSettings::FileSettings(FileSettings && other) = default;
+FileSettings& FileSettings::operator=(FileSettings &&other) = default;
+FileSettings::~FileSettings() = default;
+
+/** @brief Add the file attribute to the settings. Attributes that are not settings are ignored. */
+void FileSettings::addAttribute(const Property &attribute)
+{
+    d->attributes_.append(attribute);
+    const QString key = attribute.key();
+    const QString value = attribute.value();
+    if (key == QLatin1String("DRAWERS")) {
+        for (auto const& name : splitWords(value)) {
+            d->drawerNames_.append(name);
+            d->drawerNameSet_.insert(name);
+        }
+    } else if (key == QLatin1String("TODO") || key == QLatin1String("SEQ_TODO") || key == QLatin1String("TYP_TODO")) {
+        d->addTodoKeywords(value);
+    } else if (key == QLatin1String("TAGS")) {
+        for (auto const& word : splitWords(value)) {
+            //Skip the group markers:
+            if (!word.startsWith(QLatin1Char('{')) && !word.startsWith(QLatin1Char('}'))
+                    && !word.startsWith(QLatin1Char('[')) && !word.startsWith(QLatin1Char(']'))) {
+                d->tags_.append(withoutAccessKey(word));
+            }
+        }
+    } else if (key == QLatin1String("FILETAGS")) {
+        for (auto const& word : splitWords(value)) {
+            d->fileTags_.append(word.split(QLatin1Char(':'), Qt::SkipEmptyParts));
+        }
+    } else if (key == QLatin1String("CATEGORY")) {
+        if (d->category_.isNull()) {
+            d->category_ = value;
+        }
+    } else if (key == QLatin1String("PROPERTY")) {
+        const Property property = Properties::parseAttributeAsProperty(attribute);
+        if (property.isValid()) {
+            d->properties_.append(property);
+        }
+    }
+}
+
+/** @brief The names of the drawers, PROPERTIES and those defined by DRAWERS attributes. */
+QStringList FileSettings::drawerNames() const
+{
+    return d->drawerNames_;
+}
+
+bool FileSettings::isDrawerName(const QString &name) const
+{
+    return d->drawerNameSet_.contains(name);
+}
+
+/** @brief The TODO keywords, "TODO" if none are defined. */
+QStringList FileSettings::todoKeywords() const
+{
+    if (d->todoKeywords_.isEmpty() && d->doneKeywords_.isEmpty()) {
+        return QStringList() << QStringLiteral("TODO");
+    }
+    return d->todoKeywords_;
+}
+
+/** @brief The DONE keywords, "DONE" if no TODO keywords are defined. */
+QStringList FileSettings::doneKeywords() const
+{
+    if (d->todoKeywords_.isEmpty() && d->doneKeywords_.isEmpty()) {
+        return QStringList() << QStringLiteral("DONE");
+    }
+    return d->doneKeywords_;
+}
+
+/** @brief The tags defined by TAGS attributes, without fast access keys and group markers. */
+QStringList FileSettings::tags() const
+{
+    return d->tags_;
+}
+
+/** @brief The tags that all headlines in the file inherit, defined by FILETAGS attributes. */
+QStringList FileSettings::fileTags() const
+{
+    return d->fileTags_;
+}
+
+/** @brief The category of the file, a null string if none is defined. */
+QString FileSettings::category() const
+{
+    return d->category_;
+}
+
+/** @brief The property definitions of PROPERTY attributes, in the order they are defined. */
+FileSettings::Vector FileSettings::properties() const
+{
+    return d->properties_;
+}
+
+/** @brief All attributes that have been added, including those that are not settings, in the order they were added.
+ *
+ * Adding them to an empty FileSettings object restores the settings.
+ */
+FileSettings::Vector FileSettings::attributes() const
+{
+    return d->attributes_;
+}
+
+}
@@ -0,0 +1,71 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FILESETTINGS_H
+#define FILESETTINGS_H
+
+#include <memory>
+
+#include <QStringList>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include <Property.h>
+
+namespace OrgMode {
+
+/** @brief FileSettings holds the typed, file-wide settings that are defined by file attributes.
+ *
+ * The settings are collected once while the file attributes are scanned, and can then be queried in constant
+ * time. Attributes with the same key accumulate, except for CATEGORY, where the first definition is used (as
+ * with Attributes::fileAttribute()).
+ *
+ * The supported attributes are DRAWERS, TODO (and its synonyms SEQ_TODO and TYP_TODO), TAGS, FILETAGS, CATEGORY
+ * and PROPERTY.
+ */
+class ORGMODEPARSER_EXPORT FileSettings
+{
+public:
+    typedef QVector<Property> Vector;
+
+    FileSettings();
+    FileSettings(const FileSettings& other);
+    FileSettings& operator=(const FileSettings& other);
+    FileSettings(FileSettings&&);
+    FileSettings& operator=(FileSettings&&);
+    ~FileSettings();
+
+    void addAttribute(const Property& attribute);
+
+    QStringList drawerNames() const;
+    bool isDrawerName(const QString& name) const;
+    QStringList todoKeywords() const;
+    QStringList doneKeywords() const;
+    QStringList tags() const;
+    QStringList fileTags() const;
+    QString category() const;
+    Vector properties() const;
+    Vector attributes() const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // FILESETTINGS_H
@@ -22,6 +22,7 @@
 #include <QSharedPointer>
 
 #include <OrgElement.h>
+#include <Traversal.h>
 
 namespace OrgMode {
 
@@ -7,26 +7,30 @@ static inline void NilDeleter(OrgElement*) {}
 
 template <typename T, typename Decision>
 QList<QSharedPointer<T>> findElements(const OrgElement::Pointer& element, Decision d, int maxDepth) {
-    if (!element) return QList<QSharedPointer<T>>();
-
     QList<QSharedPointer<T>> matches;
-    auto const p = element.dynamicCast<T>();
-    if (p) {
-        const bool decision = d(p);
-        if (decision) {
-            matches.append(p);
+    if (!element) return matches;
+
+    //Only matching elements are copied, the traversal itself does not touch reference counts:
+    const int level = element->level();
+    const PreorderRange range(element);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        const OrgElement::Pointer& current = *it;
+        if (current->isKindOf(T::StaticKind)) {
+            const QSharedPointer<T> p = current.template staticCast<T>();
+            if (d(p)) {
+                matches.append(p);
+            }
+        }
+        if (current->level() - level == maxDepth) {
+            it.skipSubtree();
         }
-    }
-    if (maxDepth == 0) return matches;
-    for(auto const child : element->children()) {
-        matches.append(findElements<T>(child, d, maxDepth - 1));
     }
     return matches;
 }
 
 template <typename T, typename Decision>
 QList<QSharedPointer<T>> findElements(OrgElement* element, Decision d, int maxDepth) {
-    return findElements<T>(OrgElement::Pointer(element, NilDeleter), maxDepth, d);
+    return findElements<T>(OrgElement::Pointer(element, NilDeleter), d, maxDepth);
 }
 
 template <typename T>
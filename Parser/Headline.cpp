@@ -19,29 +19,63 @@
 #include <QRegularExpression>
 
 #include "Headline.h"
+#include "OrgFile.h"
+#include "Arena.h"
 #include "Exception.h"
 #include "OrgFileContent.h"
 
 namespace OrgMode {
 
-class Headline::Private {
+class Headline::Private : public ArenaAllocated {
 public:
-    QString caption_;
-    QStringList lines_;
-    Headline::Tags tags_;
+    TagSet inheritedFrom(const OrgElement* parent) const;
+    static TagSet translate(const TagSet& tags, const AtomTable::Pointer& from, const AtomTable::Pointer& to);
+
+    SourceText caption_;
+    TagSet tags_;
+    //The tags of the ancestors, and the file tags, kept up to date when tags change or headlines move:
+    TagSet inherited_;
 };
 
+/** @brief The tags a headline inherits from parent. The parent is part of the same document as the headline. */
+TagSet Headline::Private::inheritedFrom(const OrgElement* parent) const
+{
+    if (const Headline* headline = element_cast<Headline>(parent)) {
+        return headline->d->tags_ | headline->d->inherited_;
+    } else if (const OrgFile* file = element_cast<OrgFile>(parent)) {
+        TagSet tags;
+        for(auto const& tag : file->fileSettings().fileTags()) {
+            tags.insert(file->atomTable()->intern(tag));
+        }
+        return tags;
+    }
+    return TagSet();
+}
+
+/** @brief Map tags from the table from to the table to. */
+TagSet Headline::Private::translate(const TagSet &tags, const AtomTable::Pointer &from, const AtomTable::Pointer &to)
+{
+    TagSet result;
+    for(auto const tag : tags.atoms()) {
+        result.insert(to->intern(from->string(tag)));
+    }
+    return result;
+}
+
 Headline::Headline(const QString &line, OrgElement *parent)
     : OrgElement(line, parent)
     , d(new Private)
 {
-
+    setKind(HeadlineKind);
+    d->inherited_ = d->inheritedFrom(parent);
 }
 
 Headline::Headline(OrgElement* parent)
     : OrgElement(parent)
     , d(new Private)
 {
+    setKind(HeadlineKind);
+    d->inherited_ = d->inheritedFrom(parent);
 }
 
 Headline::Headline(Headline && other) = default;
@@ -50,38 +84,150 @@ Headline::~Headline() = default;
 
 QString Headline::caption() const
 {
-    return d->caption_;
+    return d->caption_.toString();
+}
+
+/** @brief The UTF-8 encoded caption, without decoding it. The view is valid until the caption is changed. */
+QUtf8StringView Headline::captionView() const
+{
+    return d->caption_.view();
 }
 
 void Headline::setCaption(const QString &caption)
+{
+    d->caption_ = SourceText(caption);
+}
+
+/** @brief Set the caption to a slice of a source buffer, usually of the line of the headline. */
+void Headline::setCaption(const SourceText &caption)
 {
     d->caption_ = caption;
 }
 
+/** @brief The tags of the headline, looked up in the atom table of the headline. */
 Headline::Tags Headline::tags() const
 {
-    return d->tags_;
+    Tags tags;
+    for(auto const tag : d->tags_.atoms()) {
+        tags.insert(atomTable()->string(tag));
+    }
+    return tags;
 }
 
 void Headline::setTags(const Headline::Tags &tags)
 {
-    d->tags_ = tags;
+    d->tags_.clear();
+    for(auto const& tag : tags) {
+        d->tags_.insert(atomTable()->intern(tag));
+    }
+    updateSubHeadlines();
 }
 
 void Headline::addTag(const QString &tag)
 {
-    d->tags_.insert(tag);
+    d->tags_.insert(atomTable()->intern(tag));
+    updateSubHeadlines();
 }
 
 void Headline::removeTag(const QString &tag)
 {
-    d->tags_.erase(tag);
+    d->tags_.remove(atomTable()->find(tag));
+    updateSubHeadlines();
 }
 
-bool OrgMode::Headline::hasTag(const QString &tag) const
+bool Headline::hasTag(const QString &tag) const
 {
-    return d->tags_.find(tag) != d->tags_.end();
+    return hasTag(atomTable()->find(tag));
+}
 
+/** @brief Return true if the headline has the tag with the atom tag, from the atom table of the headline.
+ *
+ * This tests a bit, the atom can be looked up once for many headlines of the same document.
+ */
+bool Headline::hasTag(AtomTable::Atom tag) const
+{
+    return d->tags_.contains(tag);
+}
+
+/** @brief The atoms of the tags of the headline, in ascending order. */
+Headline::TagAtoms Headline::tagAtoms() const
+{
+    return d->tags_.atoms();
+}
+
+/** @brief The tags of the headline, as a set of atoms. */
+const TagSet &Headline::tagSet() const
+{
+    return d->tags_;
+}
+
+/** @brief The tags the headline inherits from its ancestors, and the file tags of the file it is part of.
+ *
+ * The set is kept up to date when tags are changed or headlines are moved.
+ * @see FileSettings::fileTags()
+ */
+const TagSet &Headline::inheritedTagSet() const
+{
+    return d->inherited_;
+}
+
+/** @brief The inherited tags, looked up in the atom table of the headline, see inheritedTagSet(). */
+Headline::Tags Headline::inheritedTags() const
+{
+    Tags tags;
+    for(auto const tag : d->inherited_.atoms()) {
+        tags.insert(atomTable()->string(tag));
+    }
+    return tags;
+}
+
+/** @brief Compute the inherited tags again, after the headline has been moved or the file tags have changed. */
+void Headline::updateInheritedTags()
+{
+    const TagSet inherited = d->inheritedFrom(parent());
+    //If the inherited tags did not change, the ones of the sub-headlines did not either:
+    if (inherited != d->inherited_) {
+        d->inherited_ = inherited;
+        updateSubHeadlines();
+    }
+}
+
+void Headline::updateSubHeadlines()
+{
+    for(auto const& child : availableChildren()) {
+        if (auto const headline = element_cast<Headline>(child)) {
+            headline->updateInheritedTags();
+        }
+    }
+}
+
+void Headline::parentChanged()
+{
+    updateInheritedTags();
+}
+
+/** @brief Move the tags to the atom table of the document the headline has been added to. */
+void Headline::atomTableChanged(const AtomTable::Pointer &previous)
+{
+    d->tags_ = Private::translate(d->tags_, previous, atomTable());
+    d->inherited_ = Private::translate(d->inherited_, previous, atomTable());
+}
+
+/** @brief The direct sub-headlines of this headline.
+ *
+ * The body of a lazily parsed headline is not parsed to find them, so that the outline of a file can be walked
+ * cheaply.
+ * @see Parser::setLazyParsing()
+ */
+Headline::List Headline::headlines() const
+{
+    Headline::List result;
+    for(auto const& child : availableChildren()) {
+        if (auto const headline = element_cast<Headline>(child)) {
+            result.append(headline);
+        }
+    }
+    return result;
 }
 
 bool Headline::isElementValid() const
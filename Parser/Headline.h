@@ -25,6 +25,8 @@
 #include <QSharedPointer>
 
 #include <OrgElement.h>
+#include <AtomTable.h>
+#include <TagSet.h>
 #include "orgmodeparser_export.h"
 
 namespace OrgMode {
@@ -35,8 +37,10 @@ class ORGMODEPARSER_EXPORT Headline : public OrgElement
     Q_DECLARE_TR_FUNCTIONS(Headline)
 public:
     typedef QSharedPointer<Headline> Pointer;
+    static const Kind StaticKind = HeadlineKind;
     typedef QList<Pointer> List;
     typedef std::set<QString> Tags;
+    typedef QVector<AtomTable::Atom> TagAtoms;
 
     explicit Headline(const QString& line, OrgElement* parent = nullptr);
     explicit Headline(OrgElement* parent = nullptr);
@@ -45,21 +49,34 @@ public:
     ~Headline() override;
 
     QString caption() const;
+    QUtf8StringView captionView() const;
     void setCaption(const QString& caption);
+    void setCaption(const SourceText& caption);
 
     Tags tags() const;
     void setTags(const Tags& tags);
     void addTag(const QString& tag);
     void removeTag(const QString& tag);
     bool hasTag(const QString& tag) const;
+    bool hasTag(AtomTable::Atom tag) const;
+    TagAtoms tagAtoms() const;
+    const TagSet& tagSet() const;
+    const TagSet& inheritedTagSet() const;
+    Tags inheritedTags() const;
+    void updateInheritedTags();
+
+    List headlines() const;
 
     bool isMatch(const QRegularExpression& pattern) const override;
 
 protected:
+    void parentChanged() override;
+    void atomTableChanged(const AtomTable::Pointer& previous) override;
     bool isElementValid() const override;
     QString mnemonic() const override;
     QString description() const override;
 private:
+    void updateSubHeadlines();
     struct Private;
     std::unique_ptr<Private> d;
 };
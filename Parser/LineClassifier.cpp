@@ -0,0 +1,215 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <array>
+
+#include "LineClassifier.h"
+
+namespace OrgMode {
+
+namespace {
+
+/** The characters matched by \s in the regular expressions that describe the OrgMode syntax. */
+inline bool isBlank(QChar c)
+{
+    const char16_t u = c.unicode();
+    return u == ' ' || u == '\t' || u == '\n' || u == '\v' || u == '\f' || u == '\r';
+}
+
+inline qsizetype skipBlanks(QStringView line, qsizetype position)
+{
+    while (position < line.size() && isBlank(line.at(position))) {
+        ++position;
+    }
+    return position;
+}
+
+/** The characters allowed in a time stamp of a clock line, [- A-Za-z0-9:]. */
+inline bool isTimeStampCharacter(QChar c)
+{
+    const char16_t u = c.unicode();
+    return u == '-' || u == ' ' || u == ':'
+            || (u >= '0' && u <= '9') || (u >= 'A' && u <= 'Z') || (u >= 'a' && u <= 'z');
+}
+
+/** Match "[time stamp]" at position.
+ * @return The position after the closing bracket, or -1 if there is no time stamp at position.
+ */
+qsizetype matchTimeStamp(QStringView line, qsizetype position, QStringView* timestamp)
+{
+    if (position >= line.size() || line.at(position) != QLatin1Char('[')) {
+        return -1;
+    }
+    qsizetype end = position + 1;
+    while (end < line.size() && isTimeStampCharacter(line.at(end))) {
+        ++end;
+    }
+    if (end == position + 1 || end == line.size() || line.at(end) != QLatin1Char(']')) {
+        return -1;
+    }
+    *timestamp = line.mid(position + 1, end - position - 1);
+    return end + 1;
+}
+
+typedef std::array<LineClassifier::Type, 128> DispatchTable;
+
+const DispatchTable& dispatchTable()
+{
+    static const DispatchTable table = [] {
+        DispatchTable t;
+        t.fill(LineClassifier::Text);
+        t['*'] = LineClassifier::Headline;
+        t['C'] = LineClassifier::Clock;
+        t['#'] = LineClassifier::FileAttribute;
+        t[':'] = LineClassifier::Drawer;
+        return t;
+    }();
+    return table;
+}
+
+}
+
+/** @brief Return the candidate type of line, based on its first non-blank character. */
+LineClassifier::Type LineClassifier::classify(QStringView line)
+{
+    const qsizetype first = skipBlanks(line, 0);
+    if (first == line.size()) {
+        return Text;
+    }
+    const char16_t c = line.at(first).unicode();
+    if (c >= dispatchTable().size()) {
+        return Text;
+    }
+    const Type type = dispatchTable()[c];
+    //Headlines start in the first column:
+    if (type == Headline && first > 0) {
+        return Text;
+    }
+    return type;
+}
+
+/** @brief Match "^([*]+)\s+(.*)$". The level is the number of stars. */
+bool LineClassifier::matchHeadline(QStringView line, int* level, QStringView* description)
+{
+    qsizetype stars = 0;
+    while (stars < line.size() && line.at(stars) == QLatin1Char('*')) {
+        ++stars;
+    }
+    if (stars == 0 || stars == line.size() || !isBlank(line.at(stars))) {
+        return false;
+    }
+    *level = int(stars);
+    *description = line.mid(skipBlanks(line, stars));
+    return true;
+}
+
+/** @brief Match "^(.+)(\s+):(.+):\s*$" on the description of a headline.
+ *
+ * The tags start at the last colon that follows a blank. The caption is the trimmed text before the tags.
+ */
+bool LineClassifier::matchTags(QStringView description, QStringView* caption, QStringView* tags)
+{
+    qsizetype close = description.size() - 1;
+    while (close >= 0 && isBlank(description.at(close))) {
+        --close;
+    }
+    if (close < 0 || description.at(close) != QLatin1Char(':')) {
+        return false;
+    }
+    for (qsizetype open = close - 2; open >= 2; --open) {
+        if (description.at(open) == QLatin1Char(':') && isBlank(description.at(open - 1))) {
+            *caption = description.left(open - 1).trimmed();
+            *tags = description.mid(open + 1, close - open - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Match "^\s*CLOCK:\s*\[start\](--\[end\])?".
+ *
+ * end is set to a null view if the clock line is incomplete.
+ */
+bool LineClassifier::matchClockLine(QStringView line, QStringView* start, QStringView* end)
+{
+    static const QLatin1String keyword("CLOCK:");
+    qsizetype position = skipBlanks(line, 0);
+    if (!line.mid(position).startsWith(keyword)) {
+        return false;
+    }
+    position = matchTimeStamp(line, skipBlanks(line, position + keyword.size()), start);
+    if (position < 0) {
+        return false;
+    }
+    *end = QStringView();
+    const QStringView remainder = line.mid(position);
+    if (remainder.startsWith(QLatin1String("--"))) {
+        matchTimeStamp(remainder, 2, end);
+    }
+    return true;
+}
+
+/** @brief Match "^\s*#\+(.+):\s+(.*)$". The key extends to the last colon that is followed by a blank. */
+bool LineClassifier::matchFileAttribute(QStringView line, QStringView* key, QStringView* value)
+{
+    const qsizetype begin = skipBlanks(line, 0);
+    if (!line.mid(begin).startsWith(QLatin1String("#+"))) {
+        return false;
+    }
+    const qsizetype keyBegin = begin + 2;
+    for (qsizetype colon = line.size() - 2; colon > keyBegin; --colon) {
+        if (line.at(colon) == QLatin1Char(':') && isBlank(line.at(colon + 1))) {
+            *key = line.mid(keyBegin, colon - keyBegin);
+            *value = line.mid(skipBlanks(line, colon + 1));
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Match "^\s+:(.+):\s*$", an indented drawer title without text after it. */
+bool LineClassifier::matchDrawerTitle(QStringView line, QStringView* name)
+{
+    const qsizetype begin = skipBlanks(line, 0);
+    if (begin == 0 || begin == line.size() || line.at(begin) != QLatin1Char(':')) {
+        return false;
+    }
+    const qsizetype close = line.lastIndexOf(QLatin1Char(':'));
+    if (close <= begin + 1 || skipBlanks(line, close + 1) != line.size()) {
+        return false;
+    }
+    *name = line.mid(begin + 1, close - begin - 1);
+    return true;
+}
+
+/** @brief Match "^\s*:(.+?):\s*(.*)$", a drawer entry. The value is trimmed. */
+bool LineClassifier::matchDrawerEntry(QStringView line, QStringView* name, QStringView* value)
+{
+    const qsizetype begin = skipBlanks(line, 0);
+    if (begin == line.size() || line.at(begin) != QLatin1Char(':')) {
+        return false;
+    }
+    const qsizetype close = line.indexOf(QLatin1Char(':'), begin + 2);
+    if (close < 0) {
+        return false;
+    }
+    *name = line.mid(begin + 1, close - begin - 1);
+    *value = line.mid(close + 1).trimmed();
+    return true;
+}
+
+}
@@ -0,0 +1,56 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LINECLASSIFIER_H
+#define LINECLASSIFIER_H
+
+#include <QStringView>
+
+#include "orgmodeparser_export.h"
+
+namespace OrgMode {
+
+/** @brief LineClassifier determines the syntactic type of a line without regular expressions.
+ *
+ * classify() dispatches on the first non-blank character of the line using a lookup table. It only returns a
+ * candidate type, the match functions then validate the exact syntax of the candidate and extract its parts. The
+ * extracted parts are views into the line that was matched.
+ */
+class ORGMODEPARSER_EXPORT LineClassifier
+{
+public:
+    enum Type {
+        Text,          ///< Any other line
+        Headline,      ///< '*' in the first column
+        Clock,         ///< 'C', a "CLOCK: [...]" line
+        FileAttribute, ///< '#', a "#+KEY: value" line
+        Drawer         ///< ':', a drawer title or a drawer entry
+    };
+
+    static Type classify(QStringView line);
+
+    static bool matchHeadline(QStringView line, int* level, QStringView* description);
+    static bool matchTags(QStringView description, QStringView* caption, QStringView* tags);
+    static bool matchClockLine(QStringView line, QStringView* start, QStringView* end);
+    static bool matchFileAttribute(QStringView line, QStringView* key, QStringView* value);
+    static bool matchDrawerTitle(QStringView line, QStringView* name);
+    static bool matchDrawerEntry(QStringView line, QStringView* name, QStringView* value);
+};
+
+}
+
+#endif // LINECLASSIFIER_H
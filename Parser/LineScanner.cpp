@@ -0,0 +1,268 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <atomic>
+#include <cstring>
+
+#include <QtAlgorithms>
+
+#include "LineScanner.h"
+#include "Exception.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ORGMODEPARSER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace OrgMode {
+
+namespace {
+
+std::atomic<int> selectedImplementation(LineScanner::Automatic);
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/** Determine the candidate type of a line from its leading characters. */
+LineClassifier::Type classify(const char* line, qsizetype length)
+{
+    if (length > 0 && line[0] == '*') {
+        return LineClassifier::Headline;
+    }
+    qsizetype first = 0;
+    while (first < length && isBlank(line[first])) {
+        ++first;
+    }
+    const qsizetype remaining = length - first;
+    const char* marker = line + first;
+    if (remaining >= 1 && marker[0] == ':') {
+        return LineClassifier::Drawer;
+    } else if (remaining >= 2 && marker[0] == '#' && marker[1] == '+') {
+        return LineClassifier::FileAttribute;
+    } else if (remaining >= 6 && std::memcmp(marker, "CLOCK:", 6) == 0) {
+        return LineClassifier::Clock;
+    }
+    return LineClassifier::Text;
+}
+
+/** Collects the lines of a buffer from the positions of its newlines. */
+class LineBuilder
+{
+public:
+    LineBuilder(const char* data, qsizetype begin, LineScanner::LineIndex& index)
+        : data_(data)
+        , start_(begin)
+        , index_(index)
+    {}
+
+    inline void newline(qsizetype position)
+    {
+        const qsizetype length = position > start_ && data_[position - 1] == '\r'
+                ? position - start_ - 1 : position - start_;
+        index_.append({ start_, length, classify(data_ + start_, length) });
+        start_ = position + 1;
+    }
+
+    /** The last line does not need to end with a newline. */
+    void finish(qsizetype size)
+    {
+        if (start_ < size) {
+            newline(size);
+        }
+    }
+
+private:
+    const char* data_;
+    qsizetype start_;
+    LineScanner::LineIndex& index_;
+};
+
+void scanScalar(const char* data, qsizetype position, qsizetype size, LineBuilder& builder)
+{
+    for (; position < size; ++position) {
+        if (data[position] == '\n') {
+            builder.newline(position);
+        }
+    }
+}
+
+#ifdef ORGMODEPARSER_X86_SIMD
+__attribute__((target("sse2")))
+void scanSSE2(const char* data, qsizetype position, qsizetype size, LineBuilder& builder)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; position + 16 <= size; position += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        quint32 mask = quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask) {
+            builder.newline(position + qCountTrailingZeroBits(mask));
+            mask &= mask - 1;
+        }
+    }
+    scanScalar(data, position, size, builder);
+}
+
+__attribute__((target("avx2")))
+void scanAVX2(const char* data, qsizetype position, qsizetype size, LineBuilder& builder)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; position + 32 <= size; position += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        while (mask) {
+            builder.newline(position + qCountTrailingZeroBits(mask));
+            mask &= mask - 1;
+        }
+    }
+    scanSSE2(data, position, size, builder);
+}
+#endif
+
+LineScanner::Implementation resolve(LineScanner::Implementation implementation)
+{
+    if (implementation != LineScanner::Automatic) {
+        return implementation;
+    }
+    if (LineScanner::isSupported(LineScanner::AVX2)) {
+        return LineScanner::AVX2;
+    } else if (LineScanner::isSupported(LineScanner::SSE2)) {
+        return LineScanner::SSE2;
+    }
+    return LineScanner::Scalar;
+}
+
+}
+
+/** @brief Split buffer into lines.
+ *
+ * A UTF-8 byte order mark at the start of the buffer is skipped. If implementation is Automatic, the
+ * implementation selected with setImplementation() is used. A RuntimeException is thrown if the requested
+ * implementation is not supported by the CPU.
+ */
+LineScanner::LineIndex LineScanner::scan(QByteArrayView buffer, Implementation implementation)
+{
+    if (implementation == Automatic) {
+        implementation = LineScanner::implementation();
+    }
+    if (!isSupported(implementation)) {
+        throw RuntimeException(tr("The %1 line scanner is not supported on this CPU!").arg(name(implementation)));
+    }
+    const char* data = buffer.data();
+    const qsizetype size = buffer.size();
+    //Skip the byte order mark, like QTextStream does:
+    const qsizetype begin = buffer.startsWith(QByteArrayView("\xEF\xBB\xBF")) ? 3 : 0;
+    LineIndex index;
+    //An estimate of the line count that avoids most reallocations for typical org files:
+    index.reserve(size / 32 + 1);
+    LineBuilder builder(data, begin, index);
+    switch (resolve(implementation)) {
+#ifdef ORGMODEPARSER_X86_SIMD
+    case AVX2:
+        scanAVX2(data, begin, size, builder);
+        break;
+    case SSE2:
+        scanSSE2(data, begin, size, builder);
+        break;
+#endif
+    default:
+        scanScalar(data, begin, size, builder);
+        break;
+    }
+    builder.finish(size);
+    return index;
+}
+
+/** @brief Read the line of buffer that starts at offset into line, and move offset to the start of the next line.
+ *
+ * This reads one line at a time, for parsers that stream over a buffer without keeping a line index. Starting at
+ * offset 0, it returns the lines scan() returns, in order.
+ * @return False if the buffer ends at offset.
+ */
+bool LineScanner::next(QByteArrayView buffer, qsizetype* offset, Line* line)
+{
+    Q_ASSERT(offset && line);
+    if (*offset == 0 && buffer.startsWith(QByteArrayView("\xEF\xBB\xBF"))) {
+        *offset = 3;
+    }
+    const char* data = buffer.data();
+    const qsizetype start = *offset;
+    const qsizetype size = buffer.size();
+    if (start >= size) {
+        return false;
+    }
+    const void* newline = std::memchr(data + start, '\n', size_t(size - start));
+    const qsizetype end = newline ? static_cast<const char*>(newline) - data : size;
+    const qsizetype length = end > start && data[end - 1] == '\r' ? end - start - 1 : end - start;
+    *offset = newline ? end + 1 : size;
+    *line = { start, length, classify(data + start, length) };
+    return true;
+}
+
+/** @brief Return true if implementation can be used on this CPU. */
+bool LineScanner::isSupported(Implementation implementation)
+{
+    switch (implementation) {
+    case Automatic:
+    case Scalar:
+        return true;
+#ifdef ORGMODEPARSER_X86_SIMD
+    case SSE2:
+        return __builtin_cpu_supports("sse2");
+    case AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+/** @brief The implementation used when scan() is called with Automatic. */
+LineScanner::Implementation LineScanner::implementation()
+{
+    return resolve(Implementation(selectedImplementation.load(std::memory_order_relaxed)));
+}
+
+/** @brief Select the implementation used by the parser, for all threads.
+ *
+ * A RuntimeException is thrown if implementation is not supported by the CPU.
+ */
+void LineScanner::setImplementation(Implementation implementation)
+{
+    if (!isSupported(implementation)) {
+        throw RuntimeException(tr("The %1 line scanner is not supported on this CPU!").arg(name(implementation)));
+    }
+    selectedImplementation.store(implementation, std::memory_order_relaxed);
+}
+
+QString LineScanner::name(Implementation implementation)
+{
+    switch (implementation) {
+    case Automatic:
+        return tr("automatic");
+    case Scalar:
+        return tr("scalar");
+    case SSE2:
+        return tr("SSE2");
+    case AVX2:
+        return tr("AVX2");
+    }
+    return QString();
+}
+
+}
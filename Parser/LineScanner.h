@@ -0,0 +1,71 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+#include <QCoreApplication>
+#include <QByteArrayView>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include "LineClassifier.h"
+
+namespace OrgMode {
+
+/** @brief LineScanner splits a UTF-8 buffer into lines and determines the candidate type of each line.
+ *
+ * The newlines are located in bulk using SSE2 or AVX2 vector instructions where the CPU supports them, with a
+ * scalar fallback. The implementation is selected at runtime, either automatically or explicitly (for example to
+ * benchmark the implementations against each other on the same machine). All implementations produce the same
+ * line index.
+ *
+ * The type of each line is the candidate type determined from its leading characters (a '*' in the first column,
+ * "#+", ':' or "CLOCK:" after blanks), as LineClassifier::classify() would return it for the decoded line, except
+ * that '#' and 'C' only become candidates if followed by the rest of their marker.
+ */
+class ORGMODEPARSER_EXPORT LineScanner
+{
+    Q_DECLARE_TR_FUNCTIONS(LineScanner)
+public:
+    enum Implementation {
+        Automatic, ///< The fastest implementation supported by the CPU
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    /** @brief A line in the scanned buffer, without the line break ("\n" or "\r\n"). */
+    struct Line {
+        qsizetype offset;
+        qsizetype length;
+        LineClassifier::Type type;
+    };
+    typedef QVector<Line> LineIndex;
+
+    static LineIndex scan(QByteArrayView buffer, Implementation implementation = Automatic);
+    static bool next(QByteArrayView buffer, qsizetype* offset, Line* line);
+
+    static bool isSupported(Implementation implementation);
+    static Implementation implementation();
+    static void setImplementation(Implementation implementation);
+    static QString name(Implementation implementation);
+};
+
+}
+
+#endif // LINESCANNER_H
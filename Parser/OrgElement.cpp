@@ -17,21 +17,170 @@
 */
 #include <QtDebug>
 #include <QRegularExpression>
+#include <unordered_map>
+
+#include <QMutex>
+#include <QAtomicPointer>
 
 #include "OrgElement.h"
+#include "OrgFile.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class OrgElement::Private {
+namespace {
+
+/** Lazy children are loaded under one of a fixed set of mutexes, selected by the address of the element, so that
+ * elements do not carry a mutex of their own. Loaders do not access the children of other lazy elements. */
+QMutex& lazyMutex(const OrgElement* element)
+{
+    static QMutex mutexes[61];
+    return mutexes[(quintptr(element) / sizeof(void*)) % 61];
+}
+
+/** The atom tables of trees that are not part of a file, kept for the root of the tree until it is added to a
+ * parent or destroyed. Parse results are always part of a file, and do not use them. */
+class DetachedTables {
+public:
+    const AtomTable::Pointer& table(const void* root)
+    {
+        QMutexLocker locker(&mutex_);
+        AtomTable::Pointer& table = tables_[root];
+        if (!table) {
+            table.reset(new AtomTable);
+            count_.ref();
+        }
+        return table;
+    }
+
+    AtomTable::Pointer find(const void* root)
+    {
+        if (count_.loadAcquire() == 0) {
+            return AtomTable::Pointer();
+        }
+        QMutexLocker locker(&mutex_);
+        auto const it = tables_.find(root);
+        return it == tables_.end() ? AtomTable::Pointer() : it->second;
+    }
+
+    void release(const void* root)
+    {
+        if (count_.loadAcquire() == 0) {
+            return;
+        }
+        QMutexLocker locker(&mutex_);
+        if (tables_.erase(root) > 0) {
+            count_.deref();
+        }
+    }
+
+private:
+    QMutex mutex_;
+    //Nodes of the map are stable, references to the tables stay valid while the root keeps them:
+    std::unordered_map<const void*, AtomTable::Pointer> tables_;
+    QAtomicInt count_;
+};
+
+DetachedTables& detachedTables()
+{
+    static DetachedTables tables;
+    return tables;
+}
+
+}
+
+class OrgElement::Private : public ArenaAllocated {
 public:
     Private(OrgElement* parent)
         : parent_(parent)
+        , level_(parent ? parent->level() + 1 : 0)
     {}
+    ~Private()
+    {
+        delete loader_.loadRelaxed();
+        if (!parent_) {
+            detachedTables().release(this);
+        }
+    }
+    void loadChildren(OrgElement* self);
+    void setLevel(int level);
+    void setIndexes();
+    void changeAtomTable(OrgElement* self, const AtomTable::Pointer& previous);
+    void markFileChanged(OrgElement* self);
+
     OrgElement::List children_;
     OrgElement* parent_;
-    QString line_;
+    //The number of ancestors, updated when the element or one of its ancestors is moved:
+    int level_;
+    //The position of the element in the children of its parent, or -1:
+    int index_ = -1;
+    SourceText line_;
+    //Only allocated while the children created by the loader have not been added yet:
+    QAtomicPointer<OrgElement::Loader> loader_;
 };
 
+/** @brief Insert the lazily created children before the others, once. */
+void OrgElement::Private::loadChildren(OrgElement* self)
+{
+    if (!loader_.loadAcquire()) {
+        return;
+    }
+    QMutexLocker locker(&lazyMutex(self));
+    const std::unique_ptr<OrgElement::Loader> loader(loader_.loadRelaxed());
+    if (!loader) {
+        return;
+    }
+    OrgElement::List children = (*loader)(self);
+    for(auto const& child : children) {
+        child->setParent(self);
+    }
+    children_ = children + children_;
+    setIndexes();
+    loader_.storeRelease(nullptr);
+}
+
+/** @brief Set the level of the element, and of the elements in its subtree. Lazy children are not loaded. */
+void OrgElement::Private::setLevel(int level)
+{
+    if (level_ == level) {
+        return;
+    }
+    level_ = level;
+    for(auto const& child : children_) {
+        child->d->setLevel(level + 1);
+    }
+}
+
+/** @brief Move the atoms of the element and its subtree from previous to the table of the document. Files keep
+ * their own tables. */
+void OrgElement::Private::changeAtomTable(OrgElement* self, const AtomTable::Pointer& previous)
+{
+    self->atomTableChanged(previous);
+    for(auto const& child : children_) {
+        if (!child->isKindOf(OrgFileKind)) {
+            child->d->changeAtomTable(child.data(), previous);
+        }
+    }
+}
+
+/** @brief Increment the revision of the closest file of the element, after its children have been changed. */
+void OrgElement::Private::markFileChanged(OrgElement* self)
+{
+    for (OrgElement* element = self; element; element = element->parent()) {
+        if (auto const file = element_cast<OrgFile>(element)) {
+            file->markChanged();
+            return;
+        }
+    }
+}
+
+void OrgElement::Private::setIndexes()
+{
+    for (int index = 0; index < children_.size(); ++index) {
+        children_.at(index)->d->index_ = index;
+    }
+}
+
 OrgElement::OrgElement(OrgElement* parent)
     : d(new Private(parent))
 {
@@ -54,7 +203,22 @@ bool OrgElement::isValid() const
 
 void OrgElement::setParent(OrgElement* parent)
 {
+    //An element that moves to another document keeps its atoms in the table of that document:
+    const bool moved = parent != d->parent_;
+    const bool wasRoot = !d->parent_;
+    AtomTable::Pointer previous;
+    if (moved) {
+        previous = wasRoot ? detachedTables().find(d.get()) : atomTable();
+    }
     d->parent_ = parent;
+    d->setLevel(parent ? parent->level() + 1 : 0);
+    if (previous && previous != atomTable()) {
+        d->changeAtomTable(this, previous);
+    }
+    if (moved && wasRoot) {
+        detachedTables().release(d.get());
+    }
+    parentChanged();
 }
 
 OrgElement* OrgElement::parent() const
@@ -62,42 +226,166 @@ OrgElement* OrgElement::parent() const
     return d->parent_;
 }
 
+/** @brief The line of the element, decoded from the source of the element. */
 QString OrgElement::line() const
 {
-    return d->line_;
+    return d->line_.toString();
+}
+
+/** @brief The UTF-8 encoded line of the element, without decoding it.
+ *
+ * The view is valid until the line is changed or the element is destroyed.
+ */
+QUtf8StringView OrgElement::lineView() const
+{
+    return d->line_.view();
 }
 
 void OrgElement::setLine(const QString &line)
+{
+    d->line_ = SourceText(line);
+}
+
+/** @brief Set the line to a slice of a source buffer, which is shared and not copied. */
+void OrgElement::setLine(const SourceText &line)
 {
     d->line_ = line;
 }
 
+/** @brief The children of the element.
+ *
+ * If the element has lazy children, they are created by the loader when the children are accessed the first time.
+ * This is thread-safe.
+ */
 OrgElement::List OrgElement::children() const
 {
+    d->loadChildren(const_cast<OrgElement*>(this));
     return d->children_;
 }
 
+/** @brief The children of the element, without copying the list.
+ *
+ * Lazy children are created as by children(). The span is valid until the children of the element are changed.
+ */
+OrgElement::ChildSpan OrgElement::childSpan() const
+{
+    d->loadChildren(const_cast<OrgElement*>(this));
+    const Pointer* const first = d->children_.constData();
+    return ChildSpan(first, first + d->children_.size());
+}
+
+/** @brief The position of the element in the children of its parent, or -1 if it has not been added to one. */
+int OrgElement::childIndex() const
+{
+    return d->index_;
+}
+
 void OrgElement::addChild(const OrgElement::Pointer &child)
 {
+    d->loadChildren(this);
     child->setParent(this);
+    child->d->index_ = int(d->children_.size());
     d->children_.append(child);
 }
 
+/** @brief Replace the children of the element.
+ *
+ * Children that are not part of children anymore are detached, they have no parent and no child index afterwards.
+ * This increments the revision of the file the element is part of, see OrgFile::markChanged(). Adding children
+ * does not, as the parser and lazy sections add them while the file is built.
+ */
 void OrgElement::setChildren(const OrgElement::List &children)
 {
+    d->loadChildren(this);
+    const List previous = d->children_;
+    for(auto const& child : previous) {
+        child->d->index_ = -1;
+    }
     for(auto child : children) {
         child->setParent(this);
     }
     d->children_ = children;
+    d->setIndexes();
+    for(auto const& child : previous) {
+        if (child->d->index_ < 0 && child->d->parent_ == this) {
+            child->setParent(nullptr);
+        }
+    }
+    d->markFileChanged(this);
+}
+
+/** @brief Defer creating the first children of the element until the children are accessed.
+ *
+ * When children() is called the first time, the elements returned by loader are inserted before the children the
+ * element has at that time. The element must not be shared between threads before this is called.
+ */
+void OrgElement::setLazyChildren(const OrgElement::Loader &loader)
+{
+    d->loadChildren(this);
+    if (loader) {
+        d->loader_.storeRelease(new Loader(loader));
+    }
+}
+
+/** @brief Return true if the children created by a loader have not been added yet. */
+bool OrgElement::hasLazyChildren() const
+{
+    return d->loader_.loadAcquire() != nullptr;
 }
 
+/** @brief The children that exist without calling the loader of lazy children.
+ *
+ * These are all children if the lazy children have been loaded, and the children that follow them otherwise.
+ */
+OrgElement::List OrgElement::availableChildren() const
+{
+    if (!d->loader_.loadAcquire()) {
+        return d->children_;
+    }
+    QMutexLocker locker(&lazyMutex(this));
+    return d->children_;
+}
+
+/** @brief The depth of the element in the tree, the number of its ancestors. */
 int OrgElement::level() const
 {
-    if (d->parent_) {
-        return d->parent_->level() + 1;
-    } else {
-        return 0;
+    return d->level_;
+}
+
+/** @brief The atom table of the document of the element.
+ *
+ * This is the table of the closest OrgFile, which is the element itself or one of its ancestors. The elements of a
+ * tree that is not part of a file share a table that is kept for the root of the tree, until it is added to a parent.
+ */
+const AtomTable::Pointer &OrgElement::atomTable() const
+{
+    const OrgElement* root = this;
+    for (const OrgElement* element = this; element; element = element->parent()) {
+        if (auto const file = element_cast<OrgFile>(element)) {
+            return file->atomTable();
+        }
+        root = element;
     }
+    return detachedTables().table(root->d.get());
+}
+
+/** @brief Called when the element has been added to a parent, or moved. Subclasses update derived state. */
+void OrgElement::parentChanged()
+{
+}
+
+/** @brief Called when the element has been moved to a document with another atom table.
+ *
+ * Subclasses that keep atoms look up their strings in previous, and intern them in atomTable().
+ */
+void OrgElement::atomTableChanged(const AtomTable::Pointer&)
+{
+}
+
+/** @brief Set the kind of the element, in the constructors of subclasses. */
+void OrgElement::setKind(Kind kind)
+{
+    kind_ = kind;
 }
 
 QString OrgElement::describe() const
@@ -107,7 +395,7 @@ QString OrgElement::describe() const
             .arg(mnemonic(), 8)
             .arg(level(), 3)
             .arg(description());
-     for(auto const& child : children()) {
+     for(auto const& child : childSpan()) {
          result += child->describe();
      }
      return result;
@@ -19,12 +19,16 @@
 #define ORGELEMENT_H
 
 #include <memory>
+#include <functional>
 
 #include <QCoreApplication>
 #include <QSharedPointer>
 #include <QRegularExpression>
 
 #include "orgmodeparser_export.h"
+#include <Arena.h>
+#include <AtomTable.h>
+#include <SourceText.h>
 
 class QRegularExpression;
 
@@ -35,12 +39,51 @@ namespace OrgMode {
  * Example elements are headlines, lines of text, and other parts of an org file.
  * Elements are always bound by line breaks.
  */
-class ORGMODEPARSER_EXPORT OrgElement
+class ORGMODEPARSER_EXPORT OrgElement : public ArenaAllocated
 {
     Q_DECLARE_TR_FUNCTIONS(OrgElement)
 public:
     typedef QSharedPointer<OrgElement> Pointer;
     typedef QList<Pointer> List;
+    typedef std::function<List(OrgElement* parent)> Loader;
+
+    /** @brief The kinds of elements, in preorder of the class hierarchy.
+     *
+     * The kinds of the subclasses of a class follow the kind of the class, see isKindOf().
+     */
+    enum Kind {
+        OrgElementKind,
+        OrgFileKind,
+        HeadlineKind,
+        OrgLineKind,
+        ClockLineKind,
+        CompletedClockLineKind,
+        DrawerKind,
+        PropertyDrawerKind,
+        AttributeLineKind,
+        FileAttributeLineKind,
+        DrawerEntryKind,
+        PropertyDrawerEntryKind,
+        DrawerClosingEntryKind
+    };
+    static const Kind StaticKind = OrgElementKind;
+
+    /** @brief A borrowed range of the children of an element, valid until the children are changed. */
+    class ChildSpan {
+    public:
+        ChildSpan(const Pointer* begin = nullptr, const Pointer* end = nullptr)
+            : begin_(begin)
+            , end_(end)
+        {}
+        const Pointer* begin() const { return begin_; }
+        const Pointer* end() const { return end_; }
+        int size() const { return int(end_ - begin_); }
+        bool isEmpty() const { return begin_ == end_; }
+        const Pointer& at(int index) const { return begin_[index]; }
+    private:
+        const Pointer* begin_;
+        const Pointer* end_;
+    };
 
     explicit OrgElement(OrgElement* parent = nullptr);
     explicit OrgElement(const QString& line, OrgElement* parent = nullptr);
@@ -56,19 +99,36 @@ public:
     OrgElement* parent() const;
 
     QString line() const;
+    QUtf8StringView lineView() const;
     void setLine(const QString& line);
+    void setLine(const SourceText& line);
 
     List children() const;
+    ChildSpan childSpan() const;
+    int childIndex() const;
     void addChild(const Pointer& child);
     void setChildren(const List& children);
+    void setLazyChildren(const Loader& loader);
+    bool hasLazyChildren() const;
 
     int level() const;
+    const AtomTable::Pointer& atomTable() const;
+
+    /** @brief The kind of the class of the element. */
+    Kind kind() const { return kind_; }
+    /** @brief Return true if the element is of the class of kind, or of one of its subclasses. */
+    bool isKindOf(Kind kind) const { return kind_ >= kind && kind_ <= lastKindOf(kind); }
+    static Kind lastKindOf(Kind kind);
 
     QString describe() const;
 
     virtual bool isMatch(const QRegularExpression& pattern) const;
 
 protected:
+    void setKind(Kind kind);
+    virtual void parentChanged();
+    virtual void atomTableChanged(const AtomTable::Pointer& previous);
+    List availableChildren() const;
     virtual bool isElementValid() const = 0;
     virtual QString mnemonic() const = 0;
     virtual QString description() const = 0;
@@ -76,12 +136,55 @@ protected:
 private:
     struct Private;
     std::unique_ptr<Private> d;
+    //Kept outside of the private data, so that kind() is inline:
+    Kind kind_ = OrgElementKind;
 };
 
+/** @brief The last kind of the subclasses of the class of kind, or kind if the class has no subclasses. */
+inline OrgElement::Kind OrgElement::lastKindOf(Kind kind)
+{
+    switch (kind) {
+    case OrgElementKind:
+        return DrawerClosingEntryKind;
+    case ClockLineKind:
+        return CompletedClockLineKind;
+    case DrawerKind:
+        return PropertyDrawerKind;
+    case AttributeLineKind:
+    case DrawerEntryKind:
+        return DrawerClosingEntryKind;
+    default:
+        return kind;
+    }
+}
+
+/** @brief Cast element to T if it is a T, or return null.
+ *
+ * This is a comparison of the kind of the element, followed by a static cast, and replaces dynamic casts between
+ * element classes.
+ */
+template <typename T>
+T* element_cast(OrgElement* element)
+{
+    return element && element->isKindOf(T::StaticKind) ? static_cast<T*>(element) : nullptr;
+}
+
+template <typename T>
+const T* element_cast(const OrgElement* element)
+{
+    return element && element->isKindOf(T::StaticKind) ? static_cast<const T*>(element) : nullptr;
+}
+
+template <typename T>
+QSharedPointer<T> element_cast(const OrgElement::Pointer& element)
+{
+    return element && element->isKindOf(T::StaticKind) ? element.template staticCast<T>() : QSharedPointer<T>();
+}
+
 //FIXME Check if isMatch could be a template specialization for findElements:
 template <typename T>
 QSharedPointer<T> findElement(OrgElement::Pointer element, const QRegularExpression& pattern) {
-    QSharedPointer<T> p = element.dynamicCast<T>();
+    QSharedPointer<T> p = element_cast<T>(element);
     if (p && element->isMatch(pattern)) {
         return p;
     } else {
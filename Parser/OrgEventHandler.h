@@ -0,0 +1,65 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ORGEVENTHANDLER_H
+#define ORGEVENTHANDLER_H
+
+#include <QDateTime>
+#include <QStringList>
+#include <QStringView>
+
+#include "orgmodeparser_export.h"
+#include <Property.h>
+
+namespace OrgMode {
+
+/** @brief OrgEventHandler receives the elements of an OrgMode file as a sequence of events.
+ *
+ * Parser::parse() calls the handler for every element in the order of the file, without building an element
+ * tree. The events follow the structure the element tree would have: a headline is ended before the next
+ * headline that is not nested in it, and after its last child element. Every line of the file is reported by
+ * exactly one event.
+ *
+ * The views passed to the handler are only valid during the call. All methods do nothing by default, handlers
+ * reimplement those they are interested in.
+ */
+class ORGMODEPARSER_EXPORT OrgEventHandler
+{
+public:
+    virtual ~OrgEventHandler();
+
+    /** A headline with level stars starts. */
+    virtual void onHeadline(int level, QStringView caption, const QStringList& tags, QStringView line);
+    /** The headline with level stars ends, after all its children. */
+    virtual void onHeadlineEnd(int level);
+    /** A clock line. end is invalid if the clock line is incomplete. */
+    virtual void onClockLine(const QDateTime& start, const QDateTime& end, QStringView line);
+    /** A file attribute, "#+KEY: value". */
+    virtual void onFileAttribute(const Property& attribute, QStringView line);
+    /** A drawer starts. Property drawers are named PROPERTIES. */
+    virtual void onDrawerBegin(QStringView name, QStringView line);
+    /** An entry of the current drawer. The entries of property drawers may extend values (Property_Add). */
+    virtual void onDrawerEntry(const Property& entry, QStringView line);
+    /** The current drawer ends. line is a null view if the drawer ends with the file instead of ":END:". */
+    virtual void onDrawerEnd(QStringView line);
+    /** Any other line. */
+    virtual void onLine(QStringView line);
+};
+
+}
+
+#endif // ORGEVENTHANDLER_H
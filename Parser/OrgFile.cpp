@@ -15,19 +15,35 @@
     have received a copy of the GNU General Public License along with
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <QMutex>
+#include <QMutexLocker>
+
 #include "OrgFile.h"
+#include "Headline.h"
+#include "Arena.h"
+#include "FindElements.h"
 
 namespace OrgMode {
 
-class OrgFile::Private {
+class OrgFile::Private : public ArenaAllocated {
 public:
+    Private()
+        : atoms_(AtomTable::current() ? AtomTable::current() : AtomTable::Pointer(new AtomTable))
+    {}
     QString fileName_;
+    FileSettings fileSettings_;
+    AtomTable::Pointer atoms_;
+    int revision_ = 0;
+    //Built on first use, see propertyIndex():
+    PropertyIndex::Pointer propertyIndex_;
+    QMutex mutex_;
 };
 
 OrgFile::OrgFile(OrgElement *parent)
     : OrgElement(parent)
     , d(new Private)
 {
+    setKind(OrgFileKind);
 }
 
 OrgFile::OrgFile(OrgFile && other) = default;
@@ -44,6 +60,66 @@ QString OrgFile::fileName() const
     return d->fileName_;
 }
 
+void OrgFile::setFileSettings(const FileSettings &settings)
+{
+    d->fileSettings_ = settings;
+    //The file tags are inherited by the headlines:
+    for(auto const& child : availableChildren()) {
+        if (auto const headline = element_cast<Headline>(child)) {
+            headline->updateInheritedTags();
+        }
+    }
+}
+
+/** @brief The settings defined by the file attributes, as collected by the parser. */
+const FileSettings &OrgFile::fileSettings() const
+{
+    return d->fileSettings_;
+}
+
+/** @brief The atom table of the document, which holds the tags, drawer names and keys of its elements.
+ *
+ * It is the current table when the file is created (see AtomTable::Scope), or a new one.
+ */
+const AtomTable::Pointer &OrgFile::atomTable() const
+{
+    return d->atoms_;
+}
+
+/** @brief The property index of the file, which is shared by the Properties of its elements.
+ *
+ * The index is built on first use, and built again if the file has been changed since, see markChanged().
+ */
+PropertyIndex::Pointer OrgFile::propertyIndex() const
+{
+    QMutexLocker locker(&d->mutex_);
+    if (!d->propertyIndex_ || d->propertyIndex_->isStale()) {
+        d->propertyIndex_.reset(new PropertyIndex(OrgElement::Pointer(const_cast<OrgFile*>(this), NilDeleter)));
+    }
+    return d->propertyIndex_;
+}
+
+/** @brief The number of changes to the elements of the file, see markChanged(). */
+int OrgFile::revision() const
+{
+    return d->revision_;
+}
+
+/** @brief Record that elements of the file have been changed.
+ *
+ * The revision of the file and of the files that contain it is incremented. Indexes that refer to the elements,
+ * like PropertyIndex, detect that they are stale from it. OrgElement::setChildren() calls it, and with it
+ * Parser::reparse(). Call it after adding elements or changing their properties.
+ */
+void OrgFile::markChanged()
+{
+    for (OrgElement* element = this; element; element = element->parent()) {
+        if (auto const file = element_cast<OrgFile>(element)) {
+            ++file->d->revision_;
+        }
+    }
+}
+
 bool OrgFile::isElementValid() const
 {
     return true;
@@ -23,6 +23,9 @@
 #include <QCoreApplication>
 
 #include <OrgElement.h>
+#include <FileSettings.h>
+#include <AtomTable.h>
+#include <PropertyIndex.h>
 #include "orgmodeparser_export.h"
 
 namespace OrgMode {
@@ -32,6 +35,7 @@ class ORGMODEPARSER_EXPORT OrgFile : public OrgElement
     Q_DECLARE_TR_FUNCTIONS(OrgFile)
 public:
     typedef QSharedPointer<OrgFile> Pointer;
+    static const Kind StaticKind = OrgFileKind;
     typedef QList<Pointer> List;
 
     explicit OrgFile(OrgElement* parent = nullptr);
@@ -42,6 +46,15 @@ public:
     void setFileName(const QString& fileName);
     QString fileName() const;
 
+    void setFileSettings(const FileSettings& settings);
+    const FileSettings& fileSettings() const;
+
+    const AtomTable::Pointer& atomTable() const;
+    PropertyIndex::Pointer propertyIndex() const;
+
+    int revision() const;
+    void markChanged();
+
 protected:
     bool isElementValid() const override;
     QString mnemonic() const override;
@@ -21,39 +21,368 @@
 
 namespace OrgMode {
 
+namespace {
+
+//True if line ends the lookahead for the end of a drawer, closes is set if it is the closing line of the drawer:
+bool endsDrawerLookahead(LineClassifier::Type type, const QString& line, bool* closes)
+{
+    switch (type) {
+    case LineClassifier::Headline: {
+        int level;
+        QStringView description;
+        *closes = false;
+        return LineClassifier::matchHeadline(line, &level, &description);
+    }
+    case LineClassifier::Drawer: {
+        QStringView name;
+        QStringView value;
+        *closes = true;
+        return LineClassifier::matchDrawerEntry(line, &name, &value) && name == QLatin1String("END");
+    }
+    default:
+        return false;
+    }
+}
+
+}
+
 OrgFileContent::OrgFileContent(QTextStream *data)
     : data_(data)
+    , position_(0)
+    , endsBeforeHeadline_(false)
+    , discarded_(0)
+    , lookaheadBegin_(0)
+    , lookaheadEnd_(-1)
+    , drawerEnd_(-1)
+    , lookaheadLines_(0)
+    , streamed_(false)
+    , offset_(0)
+    , lastOffset_(-1)
 {
 }
 
+OrgFileContent::OrgFileContent(QByteArrayView buffer)
+    : data_(nullptr)
+    , buffer_(buffer)
+    , index_(LineScanner::scan(buffer))
+    , store_(index_.size())
+    , position_(0)
+    , endsBeforeHeadline_(false)
+    , discarded_(0)
+    , lookaheadBegin_(0)
+    , lookaheadEnd_(-1)
+    , drawerEnd_(-1)
+    , lookaheadLines_(0)
+    , streamed_(false)
+    , offset_(0)
+    , lastOffset_(-1)
+{
+}
+
+/** @brief Content that consists of the lines in index, which have been scanned from buffer before.
+ *
+ * The index may cover only a part of the buffer. If endsBeforeHeadline is true, the line after the last line of
+ * the index is a headline. This is considered when looking ahead for the end of drawers.
+ */
+OrgFileContent::OrgFileContent(QByteArrayView buffer, const LineScanner::LineIndex &index, bool endsBeforeHeadline)
+    : data_(nullptr)
+    , buffer_(buffer)
+    , index_(index)
+    , store_(index_.size())
+    , position_(0)
+    , endsBeforeHeadline_(endsBeforeHeadline)
+    , discarded_(0)
+    , lookaheadBegin_(0)
+    , lookaheadEnd_(-1)
+    , drawerEnd_(-1)
+    , lookaheadLines_(0)
+    , streamed_(false)
+    , offset_(0)
+    , lastOffset_(-1)
+{
+}
+
+/** @brief Content that reads buffer one line at a time, without a line index or a line store.
+ *
+ * This is used by parsers that visit every line once, like the event parser.
+ */
+OrgFileContent OrgFileContent::stream(QByteArrayView buffer)
+{
+    OrgFileContent content;
+    content.buffer_ = buffer;
+    content.streamed_ = true;
+    //Skip the byte order mark, like LineScanner::scan() does:
+    content.offset_ = buffer.startsWith(QByteArrayView("\xEF\xBB\xBF")) ? 3 : 0;
+    return content;
+}
+
 QString OrgFileContent::getLine()
 {
-    if (!lines_.isEmpty()) {
-        return lines_.takeFirst();
-    } else if (data_) {
-        return data_->readLine();
+    if (!pushback_.isEmpty()) {
+        return pushback_.takeLast();
+    }
+    if (streamed_) {
+        LineClassifier::Type type;
+        return readNext(&type);
+    }
+    if (readAhead(position_)) {
+        return store_.at(position_++);
     } else {
         return QString();
     }
 }
 
+/** @brief Read the next line and its candidate type.
+ *
+ * The type of lines from a buffer is provided by the line index, other lines are classified when they are read.
+ */
+QString OrgFileContent::getLine(LineClassifier::Type* type)
+{
+    if (!pushback_.isEmpty()) {
+        const QString line = getLine();
+        *type = LineClassifier::classify(line);
+        return line;
+    }
+    if (streamed_) {
+        return readNext(type);
+    }
+    if (!readAhead(position_)) {
+        *type = LineClassifier::Text;
+        return QString();
+    }
+    *type = typeAt(position_);
+    return store_.at(position_++);
+}
+
+/** @brief Return line to the content, it will be returned by the next call to getLine().
+ *
+ * If line is the line that was read last, the cursor is moved back. Otherwise it is pushed back.
+ */
 void OrgFileContent::ungetLine(const QString &line)
 {
-    if (!line.isNull()) {
-        lines_.prepend(line);
+    if (line.isNull()) {
+        return;
     }
+    if (streamed_) {
+        if (pushback_.isEmpty() && lastOffset_ >= 0
+                && ((line.constData() == last_.constData() && line.size() == last_.size()) || line == last_)) {
+            offset_ = lastOffset_;
+            lastOffset_ = -1;
+            last_ = QString();
+            --position_;
+            return;
+        }
+    } else if (pushback_.isEmpty() && position_ > 0) {
+        const QString& previous = store_.at(position_ - 1);
+        if ((line.constData() == previous.constData() && line.size() == previous.size()) || line == previous) {
+            --position_;
+            return;
+        }
+    }
+    pushback_.append(line);
 }
 
+/** @brief Return lines to the content, lines.first() will be returned by the next call to getLine(). */
 void OrgFileContent::ungetLines(const QStringList &lines)
 {
-    if (!lines.isEmpty()) {
-        lines_ = lines + lines_;
+    for (auto it = lines.crbegin(); it != lines.crend(); ++it) {
+        ungetLine(*it);
     }
 }
 
 bool OrgFileContent::atEnd() const
 {
-    return lines_.isEmpty() && (data_ == nullptr || data_->atEnd());
+    if (!pushback_.isEmpty() || position_ < store_.size()) {
+        return false;
+    } else if (streamed_) {
+        return offset_ >= buffer_.size();
+    } else if (data_) {
+        return data_->atEnd();
+    } else {
+        return true;
+    }
+}
+
+/** @brief The position of the cursor, which is the number of lines that have been read from the content. */
+qsizetype OrgFileContent::position() const
+{
+    return position_;
+}
+
+/** @brief Move the cursor to position, which has been returned by position() before.
+ *
+ * Lines that have been pushed back are discarded. The cursor of a streamed content cannot be moved.
+ */
+void OrgFileContent::setPosition(qsizetype position)
+{
+    Q_ASSERT(streamed_ ? position == position_ : position >= 0 && position <= store_.size());
+    pushback_.clear();
+    position_ = position;
+}
+
+/** @brief Find the end of a drawer whose title has been read last, without moving the cursor.
+ *
+ * The lines after the cursor are scanned for the closing ":END:" line of the drawer. The results are memorized
+ * for the scanned range, so that drawers that are not closed before the next headline do not cause the same lines
+ * to be scanned again for every drawer title they contain.
+ * @return The position after the closing line, the number of lines if the content ends before it, or -1 if a
+ * headline starts before the drawer is closed (including the headline after the content, see endsBeforeHeadline).
+ */
+qsizetype OrgFileContent::drawerEnd()
+{
+    Q_ASSERT(pushback_.isEmpty());
+    if (position_ >= lookaheadBegin_ && position_ <= lookaheadEnd_) {
+        return drawerEnd_;
+    }
+    lookaheadBegin_ = position_;
+    qsizetype position = position_;
+    bool found = false;
+    bool closes = false;
+    if (streamed_) {
+        //Only the candidate lines are decoded, and none of them is kept:
+        qsizetype offset = offset_;
+        LineScanner::Line entry;
+        for (; LineScanner::next(buffer_, &offset, &entry); ++position) {
+            ++lookaheadLines_;
+            if (entry.type == LineClassifier::Headline || entry.type == LineClassifier::Drawer) {
+                const QString line = QString::fromUtf8(buffer_.sliced(entry.offset, entry.length));
+                if (endsDrawerLookahead(entry.type, line, &closes)) {
+                    found = true;
+                    break;
+                }
+            }
+        }
+    } else {
+        for (; readAhead(position); ++position) {
+            ++lookaheadLines_;
+            if (endsDrawerLookahead(typeAt(position), store_.at(position), &closes)) {
+                found = true;
+                break;
+            }
+        }
+    }
+    //Without a closing line or a headline, position is the number of lines of the content:
+    lookaheadEnd_ = position;
+    if (found) {
+        drawerEnd_ = closes ? position + 1 : -1;
+    } else {
+        drawerEnd_ = endsBeforeHeadline_ ? -1 : position;
+    }
+    return drawerEnd_;
+}
+
+/** @brief The number of lines drawerEnd() has scanned, which is at most the number of lines of the content. */
+qsizetype OrgFileContent::lookaheadLines() const
+{
+    return lookaheadLines_;
+}
+
+/** @brief Find the next headline, starting at the cursor, without moving the cursor.
+ *
+ * Only the lines the line index marks as headline candidates are decoded.
+ * @return The position of the headline, or the number of lines if no headline follows.
+ */
+qsizetype OrgFileContent::nextHeadline()
+{
+    Q_ASSERT(pushback_.isEmpty());
+    if (streamed_) {
+        qsizetype position = position_;
+        qsizetype offset = offset_;
+        LineScanner::Line entry;
+        for (; LineScanner::next(buffer_, &offset, &entry); ++position) {
+            int level;
+            QStringView description;
+            if (entry.type == LineClassifier::Headline
+                    && LineClassifier::matchHeadline(QString::fromUtf8(buffer_.sliced(entry.offset, entry.length)),
+                                                     &level, &description)) {
+                break;
+            }
+        }
+        return position;
+    }
+    for (qsizetype position = position_; ; ++position) {
+        if (position < index_.size() && index_.at(position).type != LineClassifier::Headline) {
+            continue;
+        }
+        if (!readAhead(position)) {
+            return position;
+        }
+        int level;
+        QStringView description;
+        if (typeAt(position) == LineClassifier::Headline
+                && LineClassifier::matchHeadline(store_.at(position), &level, &description)) {
+            return position;
+        }
+    }
+}
+
+/** @brief Release the lines of a buffer before the cursor.
+ *
+ * This keeps the memory use constant when the lines are not referenced after they have been read. Lines that are
+ * read again after the cursor has been moved back are decoded again. Lines read from a stream are kept. A
+ * streamed content keeps no lines.
+ */
+void OrgFileContent::discardLines()
+{
+    const qsizetype end = qMin(position_, index_.size());
+    for (; discarded_ < end; ++discarded_) {
+        store_[discarded_] = QString();
+    }
+}
+
+/** @brief The lines of a buffer, as found by the LineScanner. Empty if the content is read from a stream, or
+ * streamed.
+ */
+const LineScanner::LineIndex &OrgFileContent::lineIndex() const
+{
+    return index_;
+}
+
+/** @brief Make the line at position available in the line store.
+ *
+ * Lines from a buffer are decoded when they are accessed the first time, lines from a stream are read up to
+ * position.
+ * @return False if the content has less lines.
+ */
+bool OrgFileContent::readAhead(qsizetype position)
+{
+    if (position < index_.size()) {
+        QString& line = store_[position];
+        if (line.isNull()) {
+            //An empty line is an empty, but not a null string, as with QTextStream::readLine():
+            const LineScanner::Line& entry = index_.at(position);
+            line = QString::fromUtf8(buffer_.sliced(entry.offset, entry.length));
+        }
+        return true;
+    }
+    while (data_ && position >= store_.size() && !data_->atEnd()) {
+        store_.append(data_->readLine());
+    }
+    return position < store_.size();
+}
+
+/** @brief Read the next line of a streamed content. */
+QString OrgFileContent::readNext(LineClassifier::Type* type)
+{
+    Q_ASSERT(streamed_);
+    const qsizetype offset = offset_;
+    LineScanner::Line entry;
+    if (!LineScanner::next(buffer_, &offset_, &entry)) {
+        *type = LineClassifier::Text;
+        return QString();
+    }
+    lastOffset_ = offset;
+    ++position_;
+    *type = entry.type;
+    //An empty line is an empty, but not a null string, as with QTextStream::readLine():
+    last_ = QString::fromUtf8(buffer_.sliced(entry.offset, entry.length));
+    return last_;
+}
+
+/** @brief The candidate type of a line in the line store. */
+LineClassifier::Type OrgFileContent::typeAt(qsizetype position) const
+{
+    return position < index_.size() ? index_.at(position).type : LineClassifier::classify(store_.at(position));
 }
 
 }
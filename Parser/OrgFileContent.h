@@ -20,14 +20,28 @@
 
 #include <QStringList>
 #include <QSharedPointer>
+#include <QByteArrayView>
 
 #include "orgmodeparser_export.h"
+#include "LineScanner.h"
 
 class QTextStream;
 
 namespace OrgMode {
 
 /** @brief OrgFileContent represents a data file and adds unget functionality for lines.
+ *
+ * The content is either read from a text stream, or directly from a UTF-8 encoded buffer that is owned by the
+ * caller and needs to stay valid while the content is parsed. A buffer is split into lines by the LineScanner
+ * upfront, lines are decoded when they are first read.
+ *
+ * Lines that have been read are kept in a line store, and the content is a cursor into it. Returning lines that
+ * have been read moves the cursor back, so that lookahead and backtracking do not copy lines. Lines that were
+ * not read from the content are pushed back and returned in LIFO order.
+ *
+ * A streamed content (see stream()) reads a buffer one line at a time instead, and keeps neither a line index nor
+ * a line store, so that its memory use does not depend on the size of the buffer. Only the line that was read
+ * last can be returned by moving the cursor back, and setPosition() cannot move it.
  *  It is not exported.
  */
 class ORGMODEPARSER_EXPORT OrgFileContent
@@ -36,15 +50,48 @@ public:
     typedef QSharedPointer<OrgFileContent> Pointer;
 
     explicit OrgFileContent(QTextStream* data = nullptr);
+    explicit OrgFileContent(QByteArrayView buffer);
+    OrgFileContent(QByteArrayView buffer, const LineScanner::LineIndex& index, bool endsBeforeHeadline = false);
+    static OrgFileContent stream(QByteArrayView buffer);
 
     QString getLine();
+    QString getLine(LineClassifier::Type* type);
     void ungetLine(const QString& line);
     void ungetLines(const QStringList& lines);
     bool atEnd() const;
 
+    qsizetype position() const;
+    void setPosition(qsizetype position);
+    qsizetype drawerEnd();
+    qsizetype lookaheadLines() const;
+    qsizetype nextHeadline();
+    void discardLines();
+
+    const LineScanner::LineIndex& lineIndex() const;
+
 private:
+    bool readAhead(qsizetype position);
+    QString readNext(LineClassifier::Type* type);
+    LineClassifier::Type typeAt(qsizetype position) const;
+
     QTextStream* data_;
-    QStringList lines_;
+    QByteArrayView buffer_;
+    LineScanner::LineIndex index_;
+    QVector<QString> store_;
+    qsizetype position_;
+    QStringList pushback_;
+    bool endsBeforeHeadline_;
+    qsizetype discarded_;
+    //The range of the last drawer end lookahead, and its result:
+    qsizetype lookaheadBegin_;
+    qsizetype lookaheadEnd_;
+    qsizetype drawerEnd_;
+    qsizetype lookaheadLines_;
+    //The state of a streamed content, the offset of the next line and the line that was read last:
+    bool streamed_;
+    qsizetype offset_;
+    qsizetype lastOffset_;
+    QString last_;
 };
 
 }
@@ -29,6 +29,7 @@ OrgLine::OrgLine(OrgElement *parent)
 OrgLine::OrgLine(const QString &line, OrgElement *parent)
     : OrgElement(line, parent)
 {
+    setKind(OrgLineKind);
 }
 
 OrgLine::OrgLine(OrgLine && other) = default;
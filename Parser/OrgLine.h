@@ -31,6 +31,8 @@ class ORGMODEPARSER_EXPORT OrgLine : public OrgElement
 {
     Q_DECLARE_TR_FUNCTIONS(OrgLine)
 public:
+    static const Kind StaticKind = OrgLineKind;
+
     explicit OrgLine(OrgElement* parent = nullptr);
     explicit OrgLine(const QString& line, OrgElement* parent = nullptr);
 
@@ -0,0 +1,240 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <vector>
+
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "ParseBatch.h"
+#include "Parser.h"
+#include "ParseCache.h"
+#include "Exception.h"
+
+namespace OrgMode {
+
+namespace {
+
+/** One queue of file indexes per worker. Workers take from the front of their own queue, and steal from the back
+ * of the queues of other workers when their own is empty. */
+class WorkQueues
+{
+public:
+    explicit WorkQueues(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            queues_.emplace_back(new Queue);
+        }
+    }
+
+    void push(int worker, int item)
+    {
+        queues_.at(worker)->items.push_back(item);
+    }
+
+    /** @return The next item for worker, or -1 if all queues are empty. */
+    int take(int worker)
+    {
+        {
+            Queue& own = *queues_.at(worker);
+            QMutexLocker locker(&own.mutex);
+            if (!own.items.empty()) {
+                const int item = own.items.front();
+                own.items.pop_front();
+                return item;
+            }
+        }
+        const int count = int(queues_.size());
+        for (int offset = 1; offset < count; ++offset) {
+            Queue& victim = *queues_.at((worker + offset) % count);
+            QMutexLocker locker(&victim.mutex);
+            if (!victim.items.empty()) {
+                const int item = victim.items.back();
+                victim.items.pop_back();
+                return item;
+            }
+        }
+        return -1;
+    }
+
+private:
+    struct Queue {
+        QMutex mutex;
+        std::deque<int> items;
+    };
+    std::vector<std::unique_ptr<Queue>> queues_;
+};
+
+}
+
+struct ParseBatch::Private {
+    explicit Private(const Parser& parser)
+        : parser_(parser)
+    {}
+
+    ParseBatch::Result parseFile(const QString& fileName) const;
+    void run(const ParseBatch* batch, const QStringList& fileNames, const std::function<void(int)>& task) const;
+
+    const Parser& parser_;
+    QThreadPool* pool_ = nullptr;
+    int threadCount_ = 0;
+    const ParseCache* cache_ = nullptr;
+};
+
+ParseBatch::Result ParseBatch::Private::parseFile(const QString &fileName) const
+{
+    Result result;
+    result.fileName = fileName;
+    try {
+        result.element = cache_ ? cache_->parseFile(parser_, fileName) : parser_.parseFile(fileName);
+    } catch (const Exception& ex) {
+        result.error = ex.message();
+    } catch (const std::exception& ex) {
+        result.error = QString::fromLocal8Bit(ex.what());
+    }
+    return result;
+}
+
+/** @brief Call task with the index of every file of fileNames, on the workers of batch. */
+void ParseBatch::Private::run(const ParseBatch* batch, const QStringList &fileNames,
+                              const std::function<void(int)>& task) const
+{
+    if (fileNames.isEmpty()) {
+        return;
+    }
+    //Largest files first:
+    QVector<qint64> sizes;
+    sizes.reserve(fileNames.count());
+    for(auto const& fileName : fileNames) {
+        sizes.append(QFileInfo(fileName).size());
+    }
+    std::vector<int> order(fileNames.count());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](int left, int right) {
+        return sizes.at(left) > sizes.at(right);
+    });
+    const int workers = qMin(batch->threadCount(), int(fileNames.count()));
+    WorkQueues queues(workers);
+    for (int i = 0; i < int(order.size()); ++i) {
+        queues.push(i % workers, order.at(i));
+    }
+    auto const work = [&queues, &task](int worker) {
+        for (int index = queues.take(worker); index >= 0; index = queues.take(worker)) {
+            task(index);
+        }
+    };
+    //Workers that the pool cannot start right away are not waited for, their files are stolen by the others:
+    QSemaphore finished;
+    int started = 0;
+    for (int worker = 1; worker < workers; ++worker) {
+        if (batch->threadPool()->tryStart([&work, &finished, worker]() { work(worker); finished.release(); })) {
+            ++started;
+        }
+    }
+    work(0);
+    finished.acquire(started);
+}
+
+ParseBatch::ParseBatch(const Parser &parser)
+    : d(new Private(parser))
+{
+}
+
+ParseBatch::ParseBatch(ParseBatch && other) = default;
+ParseBatch& ParseBatch::operator=(ParseBatch &&other) = default;
+ParseBatch::~ParseBatch() = default;
+
+/** @brief Set the thread pool the workers are run on. A null pointer selects the global thread pool. */
+void ParseBatch::setThreadPool(QThreadPool *pool)
+{
+    d->pool_ = pool;
+}
+
+QThreadPool *ParseBatch::threadPool() const
+{
+    return d->pool_ ? d->pool_ : QThreadPool::globalInstance();
+}
+
+/** @brief Set the number of threads that work on the batch, including the calling thread.
+ *
+ * Zero, the default, uses as many threads as the thread pool allows.
+ */
+void ParseBatch::setThreadCount(int count)
+{
+    d->threadCount_ = qMax(0, count);
+}
+
+int ParseBatch::threadCount() const
+{
+    return d->threadCount_ > 0 ? d->threadCount_ : qMax(1, threadPool()->maxThreadCount());
+}
+
+/** @brief Load the element trees from cache, which needs to stay valid while the batch is used.
+ *
+ * A null pointer, the default, parses every file. Event parsing does not use the cache.
+ */
+void ParseBatch::setCache(const ParseCache *cache)
+{
+    d->cache_ = cache;
+}
+
+const ParseCache *ParseBatch::cache() const
+{
+    return d->cache_;
+}
+
+/** @brief Parse the files and return the results in the order of fileNames. */
+ParseBatch::Results ParseBatch::parseFiles(const QStringList &fileNames) const
+{
+    Results results(fileNames.count());
+    //Every result is written by exactly one worker:
+    Result* const data = results.data();
+    d->run(this, fileNames, [this, &fileNames, data](int index) {
+        data[index] = d->parseFile(fileNames.at(index));
+    });
+    return results;
+}
+
+/** @brief Parse the files and report their elements to the handlers that handlers returns for them.
+ *
+ * Every file is parsed by one worker, so a handler that is used for one file only needs no locking.
+ * @return The errors in the order of fileNames, empty strings for the files that have been parsed.
+ */
+QStringList ParseBatch::parseFiles(const QStringList &fileNames, const HandlerFactory &handlers) const
+{
+    QStringList errors;
+    errors.resize(fileNames.count());
+    QString* const data = errors.data();
+    d->run(this, fileNames, [this, &fileNames, &handlers, data](int index) {
+        try {
+            d->parser_.parseFile(fileNames.at(index), handlers(index));
+        } catch (const Exception& ex) {
+            data[index] = ex.message();
+        } catch (const std::exception& ex) {
+            data[index] = QString::fromLocal8Bit(ex.what());
+        }
+    });
+    return errors;
+}
+
+}
@@ -0,0 +1,89 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PARSEBATCH_H
+#define PARSEBATCH_H
+
+#include <functional>
+#include <memory>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+
+class QThreadPool;
+
+namespace OrgMode {
+
+class Parser;
+class ParseCache;
+class OrgEventHandler;
+
+/** @brief ParseBatch parses a number of files concurrently.
+ *
+ * The files are distributed over the worker threads largest first, so that a huge file does not start last and
+ * delay the end of the batch. Workers that run out of files steal work from the others. The calling thread works on
+ * the batch as well, the other workers are run on a thread pool (the global thread pool by default).
+ *
+ * Files can be parsed into element trees, or for events with one handler per file. Errors are reported per file,
+ * parseFiles() does not throw. If a ParseCache is set, element trees are loaded from it by the workers, and only
+ * the files that changed are parsed.
+ */
+class ORGMODEPARSER_EXPORT ParseBatch
+{
+    Q_DECLARE_TR_FUNCTIONS(ParseBatch)
+public:
+    /** @brief The result of parsing one file of the batch. */
+    struct Result {
+        QString fileName;
+        /** The parsed file, a null pointer if it could not be parsed. */
+        OrgElement::Pointer element;
+        /** The reason why the file could not be parsed. */
+        QString error;
+
+        bool isValid() const { return !element.isNull(); }
+    };
+    typedef QVector<Result> Results;
+    /** @brief Returns the handler for the events of the file at index. It is called by the worker threads. */
+    typedef std::function<OrgEventHandler*(int index)> HandlerFactory;
+
+    explicit ParseBatch(const Parser& parser);
+    ParseBatch(ParseBatch&&);
+    ParseBatch& operator=(ParseBatch&&);
+    ~ParseBatch();
+
+    void setThreadPool(QThreadPool* pool);
+    QThreadPool* threadPool() const;
+    void setThreadCount(int count);
+    int threadCount() const;
+    void setCache(const ParseCache* cache);
+    const ParseCache* cache() const;
+
+    Results parseFiles(const QStringList& fileNames) const;
+    QStringList parseFiles(const QStringList& fileNames, const HandlerFactory& handlers) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // PARSEBATCH_H
@@ -0,0 +1,181 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+#include "ParseCache.h"
+#include "Parser.h"
+#include "Exception.h"
+#include "OrgFile.h"
+#include "BinaryFormat.h"
+
+namespace OrgMode {
+
+namespace {
+
+//The first bytes of every entry, "OMPC", and the version of the entry format:
+const quint32 Magic = 0x4f4d5043;
+const quint32 Version = 2;
+
+}
+
+struct ParseCache::Private {
+    /** @brief The size, modification time and content hash of a file, which identify a version of it. */
+    struct Stamp {
+        QString path;
+        qint64 size;
+        qint64 modified;
+        QByteArray hash;
+    };
+
+    QString entryPath(const QString& path) const;
+    OrgElement::Pointer load(const Stamp& stamp) const;
+    void store(const Stamp& stamp, const OrgElement::Pointer& element) const;
+
+    QString directory_;
+};
+
+/** @brief The entries are named after a hash of the absolute path of the file. */
+QString ParseCache::Private::entryPath(const QString &path) const
+{
+    const QByteArray key = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(directory_).filePath(QString::fromLatin1(key) + QLatin1String(".orgcache"));
+}
+
+/** @brief Load the entry for the file, if it has been written for the same version of the file. */
+OrgElement::Pointer ParseCache::Private::load(const Stamp &stamp) const
+{
+    QFile file(entryPath(stamp.path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return OrgElement::Pointer();
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic;
+    quint32 version;
+    Stamp entry;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != Magic || version != Version) {
+        return OrgElement::Pointer();
+    }
+    stream >> entry.path >> entry.size >> entry.modified >> entry.hash;
+    if (stream.status() != QDataStream::Ok || entry.path != stamp.path || entry.size != stamp.size
+            || entry.modified != stamp.modified || entry.hash != stamp.hash) {
+        return OrgElement::Pointer();
+    }
+    //The element tree follows the stamp, in the binary format:
+    const qint64 offset = file.pos();
+    const qint64 size = file.size() - offset;
+    QByteArray content;
+    QByteArrayView data;
+    if (uchar* mapped = size > 0 ? file.map(offset, size) : nullptr) {
+        data = QByteArrayView(mapped, size);
+    } else {
+        content = file.readAll();
+        data = QByteArrayView(content);
+    }
+    try {
+        return BinaryFormat::deserialize(data);
+    } catch (const RuntimeException&) {
+        return OrgElement::Pointer();
+    }
+}
+
+void ParseCache::Private::store(const Stamp &stamp, const OrgElement::Pointer &element) const
+{
+    if (!QDir().mkpath(directory_)) {
+        return;
+    }
+    //The entry replaces the old one when it is committed:
+    QSaveFile file(entryPath(stamp.path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << Magic << Version << stamp.path << stamp.size << stamp.modified << stamp.hash;
+    const QByteArray data = BinaryFormat::serialize(element);
+    if (stream.status() == QDataStream::Ok && file.write(data) == data.size()) {
+        file.commit();
+    }
+}
+
+/** @brief A cache with its entries in directory. */
+ParseCache::ParseCache(const QString &directory)
+    : d(new Private)
+{
+    d->directory_ = directory;
+}
+
+ParseCache::ParseCache(ParseCache && other) = default;
+ParseCache& ParseCache::operator=(ParseCache &&other) = default;
+ParseCache::~ParseCache() = default;
+
+QString ParseCache::directory() const
+{
+    return d->directory_;
+}
+
+/** @brief Return the element tree of the file fileName, from the cache or parsed by parser.
+ *
+ * The file is read to verify the hash of its content. A RuntimeException is thrown if the file cannot be opened.
+ */
+OrgElement::Pointer ParseCache::parseFile(const Parser &parser, const QString &fileName) const
+{
+    //The stamp is taken before the content is read, so that changes while reading invalidate the entry:
+    const QFileInfo info(fileName);
+    Private::Stamp stamp;
+    stamp.path = info.absoluteFilePath();
+    stamp.size = info.size();
+    stamp.modified = info.lastModified().toMSecsSinceEpoch();
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw RuntimeException(tr("Unable to open file %1!").arg(fileName));
+    }
+    QByteArray content;
+    QByteArrayView data;
+    if (uchar* mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr) {
+        data = QByteArrayView(mapped, file.size());
+    } else {
+        content = file.readAll();
+        data = QByteArrayView(content);
+    }
+    stamp.hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    if (const OrgFile::Pointer element = element_cast<OrgFile>(d->load(stamp))) {
+        element->setFileName(fileName);
+        return element;
+    }
+    const OrgElement::Pointer element = parser.parse(data, fileName);
+    d->store(stamp, element);
+    return element;
+}
+
+/** @brief The OrgModeParser directory in the user's cache location, which is $XDG_CACHE_HOME on Linux. */
+QString ParseCache::defaultDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation))
+            .filePath(QStringLiteral("OrgModeParser"));
+}
+
+}
@@ -0,0 +1,61 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <memory>
+
+#include <QCoreApplication>
+#include <QString>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+
+namespace OrgMode {
+
+class Parser;
+
+/** @brief ParseCache keeps parsed files on disk, and loads them instead of parsing files that did not change.
+ *
+ * Every file has one entry in the cache directory, which holds the element tree in the BinaryFormat together with
+ * the size, modification time and a hash of the content of the file. An entry is only used if all of them match the
+ * file, otherwise the file is parsed and the entry is replaced. Entries are written atomically, so that processes
+ * that share the cache never read partial entries. Failing to write an entry is not an error.
+ */
+class ORGMODEPARSER_EXPORT ParseCache
+{
+    Q_DECLARE_TR_FUNCTIONS(ParseCache)
+public:
+    explicit ParseCache(const QString& directory = defaultDirectory());
+    ParseCache(ParseCache&&);
+    ParseCache& operator=(ParseCache&&);
+    ~ParseCache();
+
+    QString directory() const;
+    OrgElement::Pointer parseFile(const Parser& parser, const QString& fileName) const;
+
+    static QString defaultDirectory();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // PARSECACHE_H
@@ -16,10 +16,14 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include <QIODevice>
+#include <QFile>
 #include <QTextStream>
-#include <QRegularExpression>
 #include <QtDebug>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QThreadPool>
 
+#include <exception>
 
 #include "Parser.h"
 #include "OrgElement.h"
@@ -27,17 +31,22 @@
 #include "FileAttributeLine.h"
 #include "OrgFile.h"
 #include "Headline.h"
-#include "Attributes.h"
 #include "Properties.h"
 #include "ClockLine.h"
 #include "CompletedClockLine.h"
 #include "Exception.h"
 #include "OrgFileContent.h"
+#include "LineClassifier.h"
+#include "LineScanner.h"
 #include "Drawer.h"
 #include "DrawerEntry.h"
 #include "PropertyDrawer.h"
 #include "PropertyDrawerEntry.h"
 #include "DrawerClosingEntry.h"
+#include "OrgEventHandler.h"
+#include "Arena.h"
+#include "SourceText.h"
+#include "AtomTable.h"
 
 #include "OrgModeParserCMake.h" //generated by CMake
 
@@ -45,269 +54,787 @@ namespace OrgMode {
 
 class Parser::Private {
 public:
-    typedef std::pair<OrgFile::Pointer, QSharedPointer<OrgFileContent>> ParseRunOutput;
-
     Private(Parser* parser)
         : parser_(parser)
+        , parallelParsing_(false)
+        , chunkSize_(256 * 1024)
+        , lazyParsing_(false)
+        , arenaAllocation_(false)
     {}
 
-    /** @brief First parse pass that provide the file-level attributes.
-     * @return The parse results and the content for the second pass in a std::pair.
+    /** @brief The input of a lazy parse, which is kept by the headlines until their sections are parsed. */
+    struct Source {
+        QByteArray data;
+        LineScanner::LineIndex index;
+        FileSettings settings;
+    };
+    typedef QSharedPointer<const Source> SourcePointer;
+
+    /** @brief The state of one call to parse(), which is kept on the stack of the calling thread.
+     *
+     * Keeping all per-parse state in the context makes parsing reentrant, so that one Parser can be used by many
+     * threads at the same time.
+     */
+    struct Context {
+        explicit Context(QByteArrayView data)
+            : content(data)
+        {}
+        Context(QByteArrayView data, const LineScanner::LineIndex& index, bool endsBeforeHeadline)
+            : content(data, index, endsBeforeHeadline)
+        {}
+        explicit Context(const OrgFileContent& content)
+            : content(content)
+        {}
+        /** @brief The line that has been read last, as a slice of the buffer, or as a copy if there is none. */
+        SourceText lastLine(const QString& line) const;
+        /** @brief The part of the line that has been read last, see lastLine(). */
+        SourceText slice(const QString& line, QStringView part) const;
+        OrgFileContent content;
+        FileSettings settings;
+        //The buffer of the content, if the elements keep slices of it:
+        QByteArray buffer;
+        //Set for lazy parsing, the lines of the content are the lines of the source:
+        SourcePointer source;
+    };
+
+    /** @brief Pre-scan that provides the file-level settings before the body is parsed.
+     *
+     * Only the lines that the line index marks as file attribute candidates are decoded and matched, so that the
+     * body is read and parsed exactly once.
      */
-    ParseRunOutput parseOrgFileFirstPass(const OrgFileContent::Pointer& content, const QString& filename) const;
+    FileSettings scanFileAttributes(QByteArrayView data, const LineScanner::LineIndex& index) const;
+    /** @brief The pre-scan for streamed content, which reads the lines of data one at a time. */
+    FileSettings scanFileAttributes(QByteArrayView data) const;
+    /** @brief Parse buffer into an element tree, whose elements keep slices of buffer instead of copies. */
+    OrgElement::Pointer parseBuffer(const QByteArray& buffer, const QString& fileName) const;
     /** @brief Parse a sequence of top level elements, considering it as one file unit. */
-    OrgFile::Pointer parseOrgFile(OrgFileContent::Pointer content, const QString& filename) const;
+    OrgFile::Pointer parseOrgFile(Context& context, const QString& filename) const;
+    /** @brief Split the file before level 1 headlines, and parse the chunks concurrently.
+     *
+     * Level 1 headlines end every element that precedes them, so every chunk can be parsed on its own. The top
+     * level elements of the chunks are then added to the file in order.
+     */
+    OrgFile::Pointer parseChunks(const QByteArray& data, const QString& filename) const;
+    /** @brief Parse the headlines of the file, and defer parsing the sections of the headlines.
+     *
+     * The section of a headline are the lines between the headline and the next headline. Sections contain no
+     * headlines, so every section can be parsed on its own when the children of its headline are accessed.
+     */
+    OrgFile::Pointer parseLazy(const QByteArray& data, const QString& filename) const;
+    /** @brief Return a loader that parses the lines from begin to end of source, for a lazily parsed headline. */
+    static OrgElement::Loader sectionLoader(const SourcePointer& source, qsizetype begin, qsizetype end);
+
+    OrgElement::Pointer parseOrgElement(OrgElement* parent, Context& context) const;
+    OrgElement::Pointer parseHeadline(const QString& line, QStringView description, OrgElement* parent,
+                                      Context& context) const;
+    OrgElement::Pointer parseClockLine(const QString& line, OrgElement* parent, const Context& context) const;
+    OrgElement::Pointer parseFileAttributeLine(const QString& line, OrgElement* parent,
+                                               const Context& context) const;
+    OrgElement::Pointer parseDrawerLine(const QString& line, OrgElement* parent,
+                                        Context& context) const;
+    /** @brief Entries of property drawers may extend existing values, with a "+" after the key. */
+    static Property drawerEntryProperty(const Context& context, const QString& line, QStringView name,
+                                        QStringView value, bool propertyDrawer);
+
+    /** @brief Read the content of the file, which becomes the source buffer of the elements. */
+    static QByteArray readFile(const QString& fileName);
+
+    /** @brief Call parse with the content of the file, which is mapped into memory if possible.
+     *
+     * This is used where nothing refers to the content after parsing, element trees keep a copy of it instead.
+     */
+    template <typename Function>
+    auto withFileContent(const QString& fileName, Function parse) const -> decltype(parse(QByteArrayView()))
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            throw RuntimeException(Parser::tr("Unable to open file %1!").arg(fileName));
+        }
+        const qint64 size = file.size();
+        if (size > 0) {
+            if (uchar* mapped = file.map(0, size)) {
+                //The mapping is released when file is closed:
+                return parse(QByteArrayView(mapped, size));
+            }
+        }
+        const QByteArray content = file.readAll();
+        return parse(QByteArrayView(content));
+    }
 
-    OrgElement::Pointer parseOrgElement(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const;
-    OrgElement::Pointer parseOrgLine(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const;
-    OrgElement::Pointer parseClockLine(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const;
-    OrgElement::Pointer parseFileAttributeLine(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const;
-    OrgElement::Pointer parseDrawerLine(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const;
+    /** @brief Replace lines of the file, and reparse the smallest headline subtree that contains them. */
+    OrgElement::Pointer reparse(const OrgFile::Pointer& file, qsizetype firstLine, qsizetype lineCount,
+                                const QString& text) const;
+
+    /** @brief Report the elements to handler, in the order of the file, without building elements. */
+    void parseEvents(Context& context, OrgEventHandler* handler) const;
+    bool parseDrawerEvents(const QString& line, Context& context, OrgEventHandler* handler) const;
 
     Parser* parser_;
-    OrgFile::Pointer firstPassResults_;
+    bool parallelParsing_;
+    qsizetype chunkSize_;
+    bool lazyParsing_;
+    bool arenaAllocation_;
 
 private:
-    QRegularExpressionMatch headlineMatch(const QString& line) const;
-    QDateTime parseTimeStamp(const QString& text) const;
+    bool matchClockLine(const QString& line, QDateTime* start, QDateTime* end) const;
+    QDateTime parseTimeStamp(QStringView text) const;
 };
 
-Parser::Private::ParseRunOutput Parser::Private::parseOrgFileFirstPass(const OrgFileContent::Pointer &content,
-                                                                       const QString &filename) const
+FileSettings Parser::Private::scanFileAttributes(QByteArrayView data, const LineScanner::LineIndex& index) const
 {
-    const QSharedPointer<OrgFileContent> output(new OrgFileContent);
-    const OrgFile::Pointer file(new OrgFile);
-    file->setFileName(filename);
-    QStringList lines;
-    while(!content->atEnd()) {
-        if (const OrgElement::Pointer element = parseFileAttributeLine(file, content)) {
-            file->addChild(element);
-            lines.append(element->line());
-        } else {
-            lines.append(content->getLine());
+    FileSettings settings;
+    for (const LineScanner::Line& entry : index) {
+        if (entry.type != LineClassifier::FileAttribute) {
+            continue;
+        }
+        const QString line = QString::fromUtf8(data.sliced(entry.offset, entry.length));
+        QStringView key;
+        QStringView value;
+        if (LineClassifier::matchFileAttribute(line, &key, &value)) {
+            settings.addAttribute(Property(key.toString(), value.toString()));
+        }
+    }
+    return settings;
+}
+
+FileSettings Parser::Private::scanFileAttributes(QByteArrayView data) const
+{
+    FileSettings settings;
+    qsizetype offset = 0;
+    LineScanner::Line entry;
+    while (LineScanner::next(data, &offset, &entry)) {
+        if (entry.type != LineClassifier::FileAttribute) {
+            continue;
         }
+        const QString line = QString::fromUtf8(data.sliced(entry.offset, entry.length));
+        QStringView key;
+        QStringView value;
+        if (LineClassifier::matchFileAttribute(line, &key, &value)) {
+            settings.addAttribute(Property(key.toString(), value.toString()));
+        }
+    }
+    return settings;
+}
+
+QByteArray Parser::Private::readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw RuntimeException(Parser::tr("Unable to open file %1!").arg(fileName));
     }
-    output->ungetLines(lines);
-    return std::make_pair(file, output);
+    return file.readAll();
 }
 
-OrgFile::Pointer Parser::Private::parseOrgFile(OrgFileContent::Pointer content, const QString &filename) const
+SourceText Parser::Private::Context::lastLine(const QString &line) const
+{
+    if (buffer.isNull()) {
+        return SourceText(line);
+    }
+    const LineScanner::Line& entry = content.lineIndex().at(content.position() - 1);
+    return SourceText(buffer, entry.offset, entry.length);
+}
+
+SourceText Parser::Private::Context::slice(const QString &line, QStringView part) const
+{
+    return buffer.isNull() ? SourceText(part.toString()) : lastLine(line).slice(line, part);
+}
+
+OrgElement::Pointer Parser::Private::parseBuffer(const QByteArray &buffer, const QString &fileName) const
+{
+    const Arena::Scope scope(arenaAllocation_ ? new Arena : nullptr);
+    const AtomTable::Scope atoms(AtomTable::Pointer(new AtomTable));
+    if (lazyParsing_) {
+        return parseLazy(buffer, fileName);
+    }
+    if (parallelParsing_) {
+        return parseChunks(buffer, fileName);
+    }
+    Context context(buffer);
+    context.buffer = buffer;
+    context.settings = scanFileAttributes(buffer, context.content.lineIndex());
+    return parseOrgFile(context, fileName);
+}
+
+OrgFile::Pointer Parser::Private::parseOrgFile(Context& context, const QString &filename) const
 {
     auto file = OrgFile::Pointer(new OrgFile);
     file->setFileName(filename);
-    while(!content->atEnd()) {
-        file->addChild(parseOrgElement(file, content));
+    file->setFileSettings(context.settings);
+    while(!context.content.atEnd()) {
+        //The elements keep their lines as slices of the buffer, the decoded lines are not needed anymore:
+        if (!context.buffer.isNull()) {
+            context.content.discardLines();
+        }
+        file->addChild(parseOrgElement(file.data(), context));
     }
     return file;
 }
 
-OrgElement::Pointer Parser::Private::parseOrgElement(const OrgElement::Pointer &parent,
-                                                     const OrgFileContent::Pointer &content) const
-{
-    //Let's see, is it a headline?
-    const QString line = content->getLine();
-    auto const match = headlineMatch(line);
-    if (match.hasMatch()) {
-        //If so, is it at the same or a lower level than the current element?
-        const QString structureMarker = match.captured(1);
-        if (structureMarker.length() <= parent->level()) {
-            //The matched element is at the same level as this element.
-            //Stop and return, this element has been completely parsed:
-            content->ungetLine(line);
-            return OrgElement::Pointer(); // end recursing
-        } else {
-            //This is a new headline, parse it and it's children until another sibling or parent headline is discovered
-            auto self = Headline::Pointer(new Headline(line, parent.data()));
-            QString description = match.captured(2);
-            static const QRegularExpression tagsMatch(QStringLiteral("^(.+)(\\s+):(.+):\\s*$"));
-            auto const match = tagsMatch.match(description);
-            if (match.hasMatch()) {
-                //We have tags:
-                const QStringList tagsList = match.captured(3).split(QLatin1Char(':'));
-                Headline::Tags tags;
-                std::copy(tagsList.begin(), tagsList.end(), std::inserter(tags, tags.begin()));
-                self->setTags(tags);
-                //Set description to the remainder of the headline:
-                description = match.captured(1).trimmed();
+namespace {
+
+/** Return true if line is a level 1 headline ("* " in the first column). */
+bool isTopLevelHeadline(QByteArrayView data, const LineScanner::Line& line)
+{
+    if (line.type != LineClassifier::Headline || line.length < 2) {
+        return false;
+    }
+    const char c = data.at(line.offset + 1);
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+QStringList splitTags(QStringView tags)
+{
+    return tags.toString().split(QLatin1Char(':'));
+}
+
+/** Create an element of type T, with line as a slice of the source. */
+template <typename T>
+QSharedPointer<T> createElement(const SourceText& line, OrgElement* parent)
+{
+    QSharedPointer<T> element(new T(parent));
+    element->setLine(line);
+    return element;
+}
+
+}
+
+Property Parser::Private::drawerEntryProperty(const Context &context, const QString &line, QStringView name,
+                                              QStringView value, bool propertyDrawer)
+{
+    if (propertyDrawer && name.endsWith(QLatin1Char('+'))) {
+        return Property(context.slice(line, name.left(name.length() - 1)), context.slice(line, value),
+                        Property::Property_Add);
+    }
+    return Property(context.slice(line, name), context.slice(line, value));
+}
+
+OrgFile::Pointer Parser::Private::parseChunks(const QByteArray &data, const QString &filename) const
+{
+    const LineScanner::LineIndex index = LineScanner::scan(data);
+    const FileSettings settings = scanFileAttributes(data, index);
+    //Chunks are ranges of lines, that are at least chunkSize_ bytes long:
+    QVector<qsizetype> chunkStarts;
+    chunkStarts.append(0);
+    qsizetype chunkOffset = 0;
+    for (qsizetype i = 0; i < index.size(); ++i) {
+        const LineScanner::Line& line = index.at(i);
+        if (line.offset - chunkOffset >= qMax<qsizetype>(chunkSize_, 1) && isTopLevelHeadline(data, line)) {
+            chunkStarts.append(i);
+            chunkOffset = line.offset;
+        }
+    }
+    chunkStarts.append(index.size());
+    const int chunkCount = int(chunkStarts.size()) - 1;
+    QVector<OrgFile::Pointer> chunks(chunkCount);
+    QVector<std::exception_ptr> errors(chunkCount);
+    OrgFile::Pointer* const results = chunks.data();
+    std::exception_ptr* const failures = errors.data();
+    QAtomicInt next(0);
+    //The atom table is shared by the chunks, looking up atoms does not lock:
+    const AtomTable::Pointer atoms = AtomTable::current();
+    auto const work = [&]() {
+        const AtomTable::Scope atomScope(atoms);
+        for (int chunk = next.fetchAndAddRelaxed(1); chunk < chunkCount; chunk = next.fetchAndAddRelaxed(1)) {
+            try {
+                //Allocating from an arena is not thread-safe, every chunk uses its own:
+                const Arena::Scope scope(arenaAllocation_ ? new Arena : nullptr);
+                const qsizetype first = chunkStarts.at(chunk);
+                //All chunks but the last one end before a level 1 headline:
+                Context context(data, index.mid(first, chunkStarts.at(chunk + 1) - first), chunk + 1 < chunkCount);
+                context.buffer = data;
+                context.settings = settings;
+                results[chunk] = parseOrgFile(context, filename);
+            } catch (...) {
+                failures[chunk] = std::current_exception();
             }
-            self->setCaption(description);
-            while(OrgElement::Pointer child = parseOrgElement(self, content)) {
-                self->addChild(child);
+        }
+    };
+    //The calling thread works on the chunks as well, workers the pool cannot start right away are not waited for:
+    QSemaphore finished;
+    int started = 0;
+    const int workers = qMin(QThreadPool::globalInstance()->maxThreadCount(), chunkCount);
+    for (int worker = 1; worker < workers; ++worker) {
+        if (QThreadPool::globalInstance()->tryStart([&work, &finished]() { work(); finished.release(); })) {
+            ++started;
+        }
+    }
+    work();
+    finished.acquire(started);
+    //Stitch the top level elements of the chunks together:
+    auto file = OrgFile::Pointer(new OrgFile);
+    file->setFileName(filename);
+    file->setFileSettings(settings);
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        if (errors.at(chunk)) {
+            std::rethrow_exception(errors.at(chunk));
+        }
+        for(auto const& child : chunks.at(chunk)->children()) {
+            file->addChild(child);
+        }
+    }
+    return file;
+}
+
+OrgFile::Pointer Parser::Private::parseLazy(const QByteArray &data, const QString &filename) const
+{
+    //The headlines keep the data and its line index, until their sections are parsed:
+    QSharedPointer<Source> source(new Source);
+    source->data = data;
+    source->index = LineScanner::scan(source->data);
+    source->settings = scanFileAttributes(source->data, source->index);
+    Context context(source->data, source->index, false);
+    context.buffer = source->data;
+    context.settings = source->settings;
+    context.source = source;
+    return parseOrgFile(context, filename);
+}
+
+OrgElement::Loader Parser::Private::sectionLoader(const SourcePointer &source, qsizetype begin, qsizetype end)
+{
+    return [source, begin, end](OrgElement* parent) {
+        //Sections are allocated on the heap, not in an arena of the calling thread:
+        const Arena::Scope scope(nullptr);
+        //A section that is followed by a headline ends before it, see OrgFileContent::drawerEnd():
+        Context context(source->data, source->index.mid(begin, end - begin), end < source->index.size());
+        context.buffer = source->data;
+        context.settings = source->settings;
+        const Private parser(nullptr);
+        OrgElement::List children;
+        while(OrgElement::Pointer child = parser.parseOrgElement(parent, context)) {
+            children.append(child);
+        }
+        return children;
+    };
+}
+
+OrgElement::Pointer Parser::Private::parseOrgElement(OrgElement* parent,
+                                                     Context& context) const
+{
+    if (context.content.atEnd()) {
+        return OrgElement::Pointer();
+    }
+    LineClassifier::Type type;
+    const QString line = context.content.getLine(&type);
+    //Dispatch on the candidate type from the leading characters, then validate the syntax of the element type:
+    switch (type) {
+    case LineClassifier::Headline: {
+        int level = 0;
+        QStringView description;
+        if (LineClassifier::matchHeadline(line, &level, &description)) {
+            //If so, is it at the same or a lower level than the current element?
+            if (level <= parent->level()) {
+                //The matched element is at the same level as this element.
+                //Stop and return, this element has been completely parsed:
+                context.content.ungetLine(line);
+                return OrgElement::Pointer(); // end recursing
             }
-            return self;
+            return parseHeadline(line, description, parent, context);
         }
-    } else {
-        //Not a headline, parse it as a non-recursive element.
-        content->ungetLine(line);
-        if (const OrgElement::Pointer element = parseClockLine(parent, content)) {
+        break;
+    }
+    case LineClassifier::Clock:
+        if (const OrgElement::Pointer element = parseClockLine(line, parent, context)) {
             return element;
-        } else if (const OrgElement::Pointer element = parseFileAttributeLine(parent, content)) {
+        }
+        break;
+    case LineClassifier::FileAttribute:
+        if (const OrgElement::Pointer element = parseFileAttributeLine(line, parent, context)) {
             return element;
-        } else if (const OrgElement::Pointer element = parseDrawerLine(parent, content)) {
+        }
+        break;
+    case LineClassifier::Drawer:
+        if (const OrgElement::Pointer element = parseDrawerLine(line, parent, context)) {
             return element;
-        } else {
-            //Every line is an OrgLine, so this is the fallback:
-            return parseOrgLine(parent, content);
         }
+        break;
+    case LineClassifier::Text:
+        break;
     }
+    //Every line is an OrgLine, so this is the fallback:
+    return createElement<OrgLine>(context.lastLine(line), parent);
 }
 
-OrgElement::Pointer Parser::Private::parseOrgLine(const OrgElement::Pointer &parent, const OrgFileContent::Pointer &content) const
+OrgElement::Pointer Parser::Private::parseHeadline(const QString &line, QStringView description,
+                                                   OrgElement* parent,
+                                                   Context& context) const
 {
-    Q_UNUSED(parent)
-    if (content->atEnd()) {
+    //This is a new headline, parse it and it's children until another sibling or parent headline is discovered
+    const SourceText source = context.lastLine(line);
+    auto self = createElement<Headline>(source, parent);
+    QStringView caption = description;
+    QStringView tagsText;
+    if (LineClassifier::matchTags(description, &caption, &tagsText)) {
+        //We have tags, they are interned in the atom table of the document:
+        for(auto const& tag : splitTags(tagsText)) {
+            self->addTag(tag);
+        }
+    }
+    self->setCaption(source.slice(line, caption));
+    if (!context.source) {
+        while(OrgElement::Pointer child = parseOrgElement(self.data(), context)) {
+            self->addChild(child);
+        }
+        return self;
+    }
+    //Lazy parsing: skip the section of the headline up to the next headline, and parse the sub-headlines.
+    const qsizetype sectionBegin = context.content.position();
+    const qsizetype sectionEnd = context.content.nextHeadline();
+    context.content.setPosition(sectionEnd);
+    while(OrgElement::Pointer child = parseOrgElement(self.data(), context)) {
+        self->addChild(child);
+    }
+    if (sectionEnd > sectionBegin) {
+        self->setLazyChildren(sectionLoader(context.source, sectionBegin, sectionEnd));
+    }
+    return self;
+}
+
+OrgElement::Pointer Parser::Private::parseClockLine(const QString &line, OrgElement* parent,
+                                                    const Context &context) const
+{
+    QDateTime start;
+    QDateTime end;
+    if (!matchClockLine(line, &start, &end)) {
         return OrgElement::Pointer();
     }
-    const QString text = content->getLine();
-    const auto element = OrgElement::Pointer(new OrgLine(text, parent.data()));
-    return element;
+    if (!end.isValid()) {
+        //Incomplete clock entry
+        auto self = createElement<ClockLine>(context.lastLine(line), parent);
+        self->setStartTime(start);
+        return self;
+    }
+    //Closed clock entry
+    auto self = createElement<CompletedClockLine>(context.lastLine(line), parent);
+    self->setStartTime(start);
+    self->setEndTime(end);
+    return self;
 }
 
-OrgElement::Pointer Parser::Private::parseClockLine(const OrgElement::Pointer& parent, const OrgFileContent::Pointer& content) const
-{
-    static const QRegularExpression clockLineOpeningStructure(QStringLiteral("^(\\s*)CLOCK:\\s*\\[([- A-Z a-z 0-9 :]+)\\](.*)$"));
-    const QString line = content->getLine();
-    auto const match = clockLineOpeningStructure.match(line);
-    if (match.hasMatch()) {
-        auto const startText = match.captured(2);
-        const QDateTime start = parseTimeStamp(startText);
-        if (start.isValid()) {
-            static const QRegularExpression clockLineStructure(QStringLiteral("^--\\[([- A-Z a-z 0-9 :]+)\\]"));
-            const QString remainder = match.captured(3);
-            auto const fullmatch = clockLineStructure.match(remainder);
-            //update regex, match the rest
-            if (fullmatch.hasMatch()) {
-                auto const endText = fullmatch.captured(1);
-                const QDateTime end = parseTimeStamp(endText);
-                if (end.isValid()) {
-                    //Closed clock entry
-                    auto self = CompletedClockLine::Pointer(new CompletedClockLine(line, parent.data()));
-                    self->setStartTime(start);
-                    self->setEndTime(end);
-                    return self;
-                }
+/** @brief Match a clock line and parse its time stamps. end is invalid if the clock line is incomplete. */
+bool Parser::Private::matchClockLine(const QString &line, QDateTime *start, QDateTime *end) const
+{
+    QStringView startText;
+    QStringView endText;
+    if (!LineClassifier::matchClockLine(line, &startText, &endText)) {
+        return false;
+    }
+    *start = parseTimeStamp(startText);
+    if (!start->isValid()) {
+        return false;
+    }
+    *end = endText.isNull() ? QDateTime() : parseTimeStamp(endText);
+    //A complete clock line needs a valid end time:
+    return endText.isNull() || end->isValid();
+}
+
+OrgElement::Pointer Parser::Private::parseFileAttributeLine(const QString &line, OrgElement* parent,
+                                                            const Context &context) const
+{
+    QStringView key;
+    QStringView value;
+    if (!LineClassifier::matchFileAttribute(line, &key, &value)) {
+        return OrgElement::Pointer();
+    }
+    const SourceText source = context.lastLine(line);
+    auto self = createElement<FileAttributeLine>(source, parent);
+    self->setProperty(Property(source.slice(line, key), source.slice(line, value)));
+    return self;
+}
+
+/** @brief Parse a drawer that starts with the title line.
+ *
+ * If the drawer is not closed before the next headline, a null element is returned without reading any lines
+ * after the title. The lookahead for the closing line is memorized by the content, so that every line is scanned
+ * only once, even if it follows many unclosed drawer titles.
+ */
+OrgElement::Pointer Parser::Private::parseDrawerLine(const QString &line, OrgElement* parent,
+                                                     Context& context) const
+{
+    QStringView nameView;
+    if (!LineClassifier::matchDrawerTitle(line, &nameView)) {
+        return OrgElement::Pointer();
+    }
+    const QString name = nameView.toString();
+    if (!context.settings.isDrawerName(name)) {
+        //This is just a regular line that looks like a drawer
+        return OrgElement::Pointer();
+    }
+    //A drawer that is interrupted by a headline is a regular line. Check before anything is parsed:
+    const qsizetype end = context.content.drawerEnd();
+    if (end < 0) {
+        return OrgElement::Pointer();
+    }
+    //This is a drawer
+    Drawer::Pointer self;
+    if (name == QLatin1String("PROPERTIES")) {
+        self = createElement<PropertyDrawer>(context.lastLine(line), parent);
+    } else {
+        self = createElement<Drawer>(context.lastLine(line), parent);
+    }
+    self->setName(name);
+    //Parse elements until :END:, or the end of the file
+    while(context.content.position() < end) {
+        const QString entryLine = context.content.getLine();
+        QStringView entryName;
+        QStringView entryValue;
+        const SourceText entrySource = context.lastLine(entryLine);
+        if (LineClassifier::matchDrawerEntry(entryLine, &entryName, &entryValue)) {
+            if (entryName == QLatin1String("END")) {
+                //The end element, add it to the drawer, return
+                const DrawerClosingEntry::Pointer child = createElement<DrawerClosingEntry>(entrySource, self.data());
+                child->setProperty(Property(entrySource.slice(entryLine, entryName),
+                                            entrySource.slice(entryLine, entryValue)));
+                self->addChild(child);
+                break;
             } else {
-                //Incomplete clock entry
-                auto self = ClockLine::Pointer(new ClockLine(line, parent.data()));
-                self->setStartTime(start);
-                return self;
+                //This is a drawer entry, specifying one key-value pair
+                DrawerEntry::Pointer child;
+                const bool propertyDrawer = self->isKindOf(OrgElement::PropertyDrawerKind);
+                if (propertyDrawer) {
+                    child = createElement<PropertyDrawerEntry>(entrySource, self.data());
+                } else {
+                    child = createElement<DrawerEntry>(entrySource, self.data());
+                }
+                child->setProperty(drawerEntryProperty(context, entryLine, entryName, entryValue, propertyDrawer));
+                self->addChild(child);
             }
+        } else {
+            //The line is not a drawer entry, but located within a drawer.
+            //Consider it a regular OrgLine.
+            self->addChild(createElement<OrgLine>(entrySource, self.data()));
         }
     }
-    content->ungetLine(line);
-    return OrgElement::Pointer();
+    return self;
 }
 
-OrgElement::Pointer Parser::Private::parseFileAttributeLine(const OrgElement::Pointer &parent,
-                                                            const OrgFileContent::Pointer &content) const
+namespace {
+
+/** A headline, and the range of lines of its subtree in the file. */
+struct Subtree {
+    Headline::Pointer headline;
+    qsizetype begin;
+    qsizetype end;
+};
+
+/** Collect the lines of element and its children in the order of the file, and the subtrees of the headlines. */
+void collectLines(const OrgElement::Pointer& element, QVector<QString>* lines, QVector<Subtree>* subtrees)
 {
-    static const QRegularExpression fileAttributeStructure(QStringLiteral("\\#\\+(.+):\\s+(.*)$"));
-    const QString line = content->getLine();
-    auto const match = fileAttributeStructure.match(line);
-    if (match.hasMatch()) {
-        const QString key = match.captured(1);
-        const QString value = match.captured(2);
-        if (!key.isEmpty()) {
-            auto self = new FileAttributeLine(line, parent.data());
-            self->setProperty(Property(key, value));
-            return OrgElement::Pointer(self);
-        }
+    qsizetype subtree = -1;
+    if (auto const headline = element_cast<Headline>(element)) {
+        subtree = subtrees->size();
+        subtrees->append(Subtree{headline, lines->size(), lines->size()});
+    }
+    const QString line = element->line();
+    if (!line.isNull()) {
+        lines->append(line);
+    }
+    for(auto const& child : element->children()) {
+        collectLines(child, lines, subtrees);
+    }
+    if (subtree >= 0) {
+        (*subtrees)[subtree].end = lines->size();
     }
-    content->ungetLine(line);
-    return OrgElement::Pointer();
 }
 
-//TODO implement as traverse_depth_first(element, [](const OrgElement::Pointer&) {});
-QStringList collectLines(const OrgElement::Pointer& element) {
-    QStringList lines;
-    lines << element->line();
-    for(auto const& child : element->children()) {
-        lines << collectLines(child);
+/** Encode the lines from begin to end as UTF-8, every line followed by a line feed. */
+void appendLines(QByteArray* data, const QVector<QString>& lines, qsizetype begin, qsizetype end)
+{
+    for (qsizetype i = begin; i < end; ++i) {
+        *data += lines.at(i).toUtf8();
+        *data += '\n';
     }
-    return lines;
 }
 
-OrgElement::Pointer Parser::Private::parseDrawerLine(const OrgElement::Pointer &parent,
-                                                     const OrgFileContent::Pointer &content) const
+/** Return the number of stars of a headline, or 0 if line is not a headline. */
+int headlineLevel(const QString& line)
+{
+    int level = 0;
+    QStringView description;
+    return LineClassifier::matchHeadline(line, &level, &description) ? level : 0;
+}
+
+}
+
+/** @brief Replace lines firstLine to firstLine + lineCount of file with the lines of text.
+ *
+ * The subtree of the innermost headline that contains the edit is reparsed and replaces the old one, if the
+ * result is a single headline that starts at the same level and ends where the old one ended. Otherwise the
+ * enclosing headlines are tried. All elements outside of the reparsed subtree are kept. The whole file is
+ * reparsed if the edit contains no headline subtree, or changes file attributes.
+ * @return The element that has been reparsed, the file if the whole file has been reparsed.
+ */
+OrgElement::Pointer Parser::Private::reparse(const OrgFile::Pointer &file, qsizetype firstLine, qsizetype lineCount,
+                                             const QString &text) const
 {
-    static const QRegularExpression drawerTitleStructure(QStringLiteral("^\\s+:(.+):\\s*(.*)$"));
-    const QString line = content->getLine();
-    auto const match = drawerTitleStructure.match(line);
-    if (match.hasMatch()) {
-        const QString name = match.captured(1);
-        const QString value = match.captured(2);
-        if (!value.isEmpty()) {
-            content->ungetLine(line);
-            return OrgElement::Pointer();
+    //The reparsed elements are part of the document of file:
+    const AtomTable::Scope atoms(file->atomTable());
+    //Reparsed elements are allocated on the heap, not in an arena of the calling thread:
+    const Arena::Scope scope(nullptr);
+    QVector<QString> lines;
+    QVector<Subtree> subtrees;
+    collectLines(file, &lines, &subtrees);
+    const qsizetype lastLine = firstLine + lineCount;
+    if (firstLine < 0 || lineCount < 0 || lastLine > lines.size()) {
+        throw RuntimeException(Parser::tr("Lines %1 to %2 are not part of the file!").arg(firstLine).arg(lastLine));
+    }
+    //The text replaces whole lines, a final line feed does not start another line:
+    QStringList newLines = text.split(QLatin1Char('\n'));
+    if (text.isEmpty() || text.endsWith(QLatin1Char('\n'))) {
+        newLines.removeLast();
+    }
+    //File attributes apply to the whole file, for example by declaring drawer names:
+    bool attributesChanged = false;
+    for (qsizetype i = firstLine; i < lastLine; ++i) {
+        attributesChanged |= LineClassifier::classify(lines.at(i)) == LineClassifier::FileAttribute;
+    }
+    for(auto const& line : newLines) {
+        attributesChanged |= LineClassifier::classify(line) == LineClassifier::FileAttribute;
+    }
+    //Subtrees follow their ancestors in the list, so the innermost subtree that contains the edit is found first:
+    for (auto it = subtrees.crbegin(); !attributesChanged && it != subtrees.crend(); ++it) {
+        const Subtree& subtree = *it;
+        //An edit that starts at a headline only replaces it if it replaces at least one line:
+        const bool contains = (subtree.begin < firstLine || (subtree.begin == firstLine && lineCount > 0))
+                && lastLine <= subtree.end;
+        if (!contains) {
+            continue;
         }
-        const Attributes attributes(firstPassResults_);
-        const QStringList drawernames = attributes.drawerNames();
-        if (drawernames.contains(name)) {
-            //This is a drawer
-            Drawer::Pointer self;
-            if (name == QLatin1String("PROPERTIES")) {
-                self.reset(new PropertyDrawer(line, parent.data()));
-            } else {
-                self.reset(new Drawer(line, parent.data()));
+        QByteArray data;
+        appendLines(&data, lines, subtree.begin, firstLine);
+        for(auto const& line : newLines) {
+            data += line.toUtf8();
+            data += '\n';
+        }
+        appendLines(&data, lines, lastLine, subtree.end);
+        //The line after the subtree is a headline that ends the subtree, or the end of the file:
+        Context context(data, LineScanner::scan(data), subtree.end < lines.size());
+        context.buffer = data;
+        context.settings = file->fileSettings();
+        OrgElement* const parent = subtree.headline->parent();
+        const Headline::Pointer headline = element_cast<Headline>(parseOrgElement(parent, context));
+        if (!headline || !context.content.atEnd()
+                || headlineLevel(headline->line()) != headlineLevel(subtree.headline->line())) {
+            //The edit changes the structure around the subtree:
+            continue;
+        }
+        OrgElement::List siblings = parent->children();
+        for (auto& sibling : siblings) {
+            if (sibling == subtree.headline) {
+                sibling = headline;
             }
-            self->setName(name);
-            //Parse elements until :END: (complete) or headline (cancel)
-            static const QRegularExpression drawerEntryStructure(QStringLiteral("^\\s*:(.+?):\\s*(.*)$"));
-            Q_ASSERT(drawerEntryStructure.isValid());
-            while(!content->atEnd()) {
-                const QString line = content->getLine();
-                if (headlineMatch(line).hasMatch()) {
-                    const QStringList lines = QStringList() << collectLines(self) << line;
-                    content->ungetLines(lines);
-                    return OrgElement::Pointer();
-                }
-                auto const drawerEntryMatch = drawerEntryStructure.match(line);
-                if (drawerEntryMatch.hasMatch()) {
-                    const QString name = drawerEntryMatch.captured(1);
-                    const QString value = drawerEntryMatch.captured(2).trimmed();
-                    if (name == QStringLiteral("END")) {
-                        //The end element, add it to the drawer, return
-                        const DrawerClosingEntry::Pointer child(new DrawerClosingEntry(line, self.data()));
-                        child->setProperty(Property(name, value));
-                        self->addChild(child);
-                        break;
-                    } else {
-                        //This is a drawer entry, specifying one key-value pair
-                        DrawerEntry::Pointer child;
-                        Property property(name, value);
-                        if (self.dynamicCast<PropertyDrawer>()) {
-                            //Property drawer entries may extend existing values:
-                            if (name.endsWith(QLatin1Char('+'))) {
-                                property.setKey(name.mid(0, name.length() -1));
-                                property.setOperation(Property::Property_Add);
-                            }
-                            child.reset(new PropertyDrawerEntry(line, self.data()));
-                        } else {
-                            child.reset(new DrawerEntry(line, self.data()));
-                        }
-                        child->setProperty(property);
-                        self->addChild(child);
-                    }
-                } else {
-                    //The line is not a drawer entry, but located within a drawer.
-                    //Consider it a regular OrgLine.
-                    self->addChild(OrgLine::Pointer(new OrgLine(line, self.data())));
+        }
+        //The replaced subtree is detached from parent, and the revision of the file incremented:
+        parent->setChildren(siblings);
+        return headline;
+    }
+    QByteArray data;
+    appendLines(&data, lines, 0, firstLine);
+    for(auto const& line : newLines) {
+        data += line.toUtf8();
+        data += '\n';
+    }
+    appendLines(&data, lines, lastLine, lines.size());
+    Context context(data);
+    context.buffer = data;
+    context.settings = scanFileAttributes(data, context.content.lineIndex());
+    const OrgFile::Pointer parsed = parseOrgFile(context, file->fileName());
+    file->setFileSettings(parsed->fileSettings());
+    file->setChildren(parsed->children());
+    return file;
+}
+
+void Parser::Private::parseEvents(Context& context, OrgEventHandler *handler) const
+{
+    //The levels of the open headlines. The tree depth of a headline is its position in the stack:
+    QVector<int> headlines;
+    while(!context.content.atEnd()) {
+        LineClassifier::Type type;
+        const QString line = context.content.getLine(&type);
+        switch (type) {
+        case LineClassifier::Headline: {
+            int level = 0;
+            QStringView description;
+            if (LineClassifier::matchHeadline(line, &level, &description)) {
+                //End the open headlines that this one is not nested in, as in parseOrgElement():
+                while (!headlines.isEmpty() && level <= headlines.size()) {
+                    handler->onHeadlineEnd(headlines.takeLast());
                 }
+                QStringView caption = description;
+                QStringView tagsText;
+                const QStringList tags = LineClassifier::matchTags(description, &caption, &tagsText)
+                        ? splitTags(tagsText) : QStringList();
+                handler->onHeadline(level, caption, tags, line);
+                headlines.append(level);
+                continue;
             }
-            return self;
-        } else {
-           //This is just a regular line that looks like a drawer, do nothing
+            break;
+        }
+        case LineClassifier::Clock: {
+            QDateTime start;
+            QDateTime end;
+            if (matchClockLine(line, &start, &end)) {
+                handler->onClockLine(start, end, line);
+                continue;
+            }
+            break;
+        }
+        case LineClassifier::FileAttribute: {
+            QStringView key;
+            QStringView value;
+            if (LineClassifier::matchFileAttribute(line, &key, &value)) {
+                handler->onFileAttribute(Property(key.toString(), value.toString()), line);
+                continue;
+            }
+            break;
+        }
+        case LineClassifier::Drawer:
+            if (parseDrawerEvents(line, context, handler)) {
+                continue;
+            }
+            break;
+        case LineClassifier::Text:
+            break;
         }
+        handler->onLine(line);
+    }
+    while (!headlines.isEmpty()) {
+        handler->onHeadlineEnd(headlines.takeLast());
     }
-    content->ungetLine(line);
-    return OrgElement::Pointer();
 }
 
-QRegularExpressionMatch Parser::Private::headlineMatch(const QString &line) const
+/** @brief The event version of parseDrawerLine().
+ *
+ * @return False if line does not start a drawer.
+ */
+bool Parser::Private::parseDrawerEvents(const QString &line, Context &context, OrgEventHandler *handler) const
 {
-    static const QRegularExpression beginningOfHeadline(QStringLiteral("^([*]+)\\s+(.*)$"));
-    auto const match = beginningOfHeadline.match(line);
-    return match;
+    QStringView name;
+    if (!LineClassifier::matchDrawerTitle(line, &name) || !context.settings.isDrawerName(name.toString())) {
+        return false;
+    }
+    const qsizetype end = context.content.drawerEnd();
+    if (end < 0) {
+        return false;
+    }
+    const bool propertyDrawer = name == QLatin1String("PROPERTIES");
+    handler->onDrawerBegin(name, line);
+    while(context.content.position() < end) {
+        const QString entryLine = context.content.getLine();
+        QStringView entryName;
+        QStringView entryValue;
+        if (!LineClassifier::matchDrawerEntry(entryLine, &entryName, &entryValue)) {
+            handler->onLine(entryLine);
+        } else if (entryName == QLatin1String("END")) {
+            handler->onDrawerEnd(entryLine);
+            return true;
+        } else {
+            handler->onDrawerEntry(drawerEntryProperty(context, entryLine, entryName, entryValue, propertyDrawer),
+                                   entryLine);
+        }
+    }
+    //The drawer ends with the file:
+    handler->onDrawerEnd(QStringView());
+    return true;
 }
 
 namespace {
@@ -318,7 +845,7 @@ public:
     ConversionException() : RuntimeException(QString()) {}
 };
 
-int qstring_toint(const QString& value) {
+int qstringview_toint(QStringView value) {
     bool ok;
     const int result = value.toInt(&ok);
     if (!ok) {
@@ -329,23 +856,23 @@ int qstring_toint(const QString& value) {
 
 }
 
-QDateTime Parser::Private::parseTimeStamp(const QString &text) const
+QDateTime Parser::Private::parseTimeStamp(QStringView text) const
 {
     static const QString format = QString::fromLatin1("yyyy-MM-dd ddd hh:mm");
     static const int formatLength = format.length();
     //test is of format "yyyy-MM-dd ddd hh:mm"
     //Using QDateTime::fromString(text, "yyyy-MM-dd ddd hh:mm") causes repeated calls to libicu and is rather slow
     //Instead, the strings will be parsed directly:
-    const QString input = text.trimmed(); // don't break on leading or trailing whitespace
+    const QStringView input = text.trimmed(); // don't break on leading or trailing whitespace
     if (input.length() != formatLength) {
         return QDateTime();
     }
     try {
-        const int year = qstring_toint(input.mid(0, 4));
-        const int month = qstring_toint(input.mid(5, 2));
-        const int day = qstring_toint(input.mid(8, 2));
-        const int hours = qstring_toint(input.mid(15, 2));
-        const int minutes = qstring_toint(input.mid(18, 2));
+        const int year = qstringview_toint(input.mid(0, 4));
+        const int month = qstringview_toint(input.mid(5, 2));
+        const int day = qstringview_toint(input.mid(8, 2));
+        const int hours = qstringview_toint(input.mid(15, 2));
+        const int minutes = qstringview_toint(input.mid(18, 2));
         const QTime time(hours, minutes);
         const QDate date(year, month, day);
         return QDateTime(date, time);
@@ -362,13 +889,164 @@ Parser::Parser(QObject *parent)
 
 Parser::~Parser() = default;
 
+/** @brief Parse org mode text from a stream.
+ *
+ * The remaining content of the stream is read and converted to UTF-8, and then parsed like a buffer.
+ */
 OrgElement::Pointer Parser::parse(QTextStream *data, const QString &fileName) const
 {
     Q_ASSERT(data);
-    const OrgFileContent::Pointer content(new OrgFileContent(data));
-    auto const firstPassResults = d->parseOrgFileFirstPass(content, fileName);
-    d->firstPassResults_ = firstPassResults.first;
-    return d->parseOrgFile(firstPassResults.second, fileName);
+    return d->parseBuffer(data->readAll().toUtf8(), fileName);
+}
+
+/** @brief Parse UTF-8 encoded org mode text from a buffer owned by the caller.
+ *
+ * The buffer is copied once, and split into lines by the LineScanner. Lines are decoded as they are parsed. The
+ * elements of the returned tree keep their lines as slices of the copy (see SourceText), which is released with
+ * the last element that refers to it. The buffer of the caller may be released after the call.
+ * @see setParallelParsing()
+ */
+OrgElement::Pointer Parser::parse(QByteArrayView data, const QString &fileName) const
+{
+    return d->parseBuffer(data.toByteArray(), fileName);
+}
+
+/** @brief Parse the org file fileName.
+ *
+ * The file is read once into the buffer the elements keep their text in (see SourceText). A RuntimeException is
+ * thrown if the file cannot be opened.
+ */
+OrgElement::Pointer Parser::parseFile(const QString &fileName) const
+{
+    return d->parseBuffer(Private::readFile(fileName), fileName);
+}
+
+/** @brief Replace lineCount lines of file, starting at line firstLine (counting from 0), with the lines of text.
+ *
+ * Only the smallest headline subtree that the edit can affect is parsed again, and replaces the old subtree in
+ * the element tree of file. The resulting tree is identical to the one of parsing the edited file. The lines of
+ * text are separated by line feeds, empty text removes the lines. The replaced elements are detached from the
+ * tree, and the revision of file is incremented (see OrgFile::markChanged()), so that indexes built before the
+ * edit, like PropertyIndex, are stale.
+ * @return The element that replaced the old subtree, or file if the whole file has been reparsed.
+ */
+OrgElement::Pointer Parser::reparse(const OrgFile::Pointer &file, int firstLine, int lineCount,
+                                    const QString &text) const
+{
+    Q_ASSERT(file);
+    return d->reparse(file, firstLine, lineCount, text);
+}
+
+/** @brief Parse UTF-8 encoded org mode text from a buffer and report the elements to handler.
+ *
+ * No element tree is built, and the buffer is read one line at a time without a line index, so that the memory
+ * use does not depend on the size of the buffer. The events describe the same structure as the element tree parse()
+ * returns.
+ */
+void Parser::parse(QByteArrayView data, OrgEventHandler *handler) const
+{
+    Q_ASSERT(handler);
+    Private::Context context(OrgFileContent::stream(data));
+    context.settings = d->scanFileAttributes(data);
+    d->parseEvents(context, handler);
+}
+
+/** @brief Parse the org file fileName and report the elements to handler.
+ *
+ * @see parse(QByteArrayView, OrgEventHandler*)
+ */
+void Parser::parseFile(const QString &fileName, OrgEventHandler *handler) const
+{
+    d->withFileContent(fileName, [this, handler](QByteArrayView data) {
+        parse(data, handler);
+    });
+}
+
+/** @brief Parse UTF-8 encoded org mode text from a buffer into a CompactDocument.
+ *
+ * The document is built from the events of the parser, no element tree is created. It is identical to the
+ * document that is converted from the element tree parse() returns.
+ */
+CompactDocument Parser::parseCompact(QByteArrayView data, const QString &fileName) const
+{
+    Private::Context context(OrgFileContent::stream(data));
+    context.settings = d->scanFileAttributes(data);
+    CompactDocument::Builder builder(fileName, context.settings);
+    d->parseEvents(context, &builder);
+    return builder.document();
+}
+
+/** @brief Parse single files in parallel, by splitting them into chunks at level 1 headlines.
+ *
+ * The chunks are parsed concurrently on the global thread pool, the resulting element tree is identical to the
+ * one of a sequential parse. This should be configured before the Parser is shared between threads.
+ */
+void Parser::setParallelParsing(bool enabled)
+{
+    d->parallelParsing_ = enabled;
+}
+
+bool Parser::parallelParsing() const
+{
+    return d->parallelParsing_;
+}
+
+/** @brief Parse only the headlines of files, and parse the sections of headlines when their children are accessed.
+ *
+ * The line index of the file is kept by the headlines until their children are accessed the first time.
+ * This makes parsing a file for its outline (see Headline::headlines()) about as fast as scanning it for
+ * headlines. The resulting element tree is identical to the one of a regular parse. Lazy parsing takes
+ * precedence over parallel parsing. This should be configured before the Parser is shared between threads.
+ */
+void Parser::setLazyParsing(bool enabled)
+{
+    d->lazyParsing_ = enabled;
+}
+
+bool Parser::lazyParsing() const
+{
+    return d->lazyParsing_;
+}
+
+/** @brief Allocate the elements of parse results and their private data in an arena.
+ *
+ * Every parse result gets its own arena, which is released in one piece when the last element in it is destroyed.
+ * This saves most of the allocations and deallocations of elements. Memory of elements that are removed from the
+ * tree is only reclaimed with the arena. Sections of lazily parsed headlines are not allocated in the arena. If
+ * arena allocation is disabled, the elements are allocated on the heap, even if the calling thread has an active
+ * Arena::Scope.
+ */
+void Parser::setArenaAllocation(bool enabled)
+{
+    d->arenaAllocation_ = enabled;
+}
+
+bool Parser::arenaAllocation() const
+{
+    return d->arenaAllocation_;
+}
+
+/** @brief Set the minimum size of the chunks in bytes, for parallel parsing. The default is 256 KiB. */
+void Parser::setChunkSize(qsizetype bytes)
+{
+    d->chunkSize_ = bytes;
+}
+
+qsizetype Parser::chunkSize() const
+{
+    return d->chunkSize_;
+}
+
+/** @brief Parse the files concurrently, using the global thread pool.
+ *
+ * The results are returned in the order of fileNames. Errors are reported in the results, per file.
+ * @see ParseBatch
+ */
+ParseBatch::Results Parser::parseFiles(const QStringList &fileNames, int threadCount) const
+{
+    ParseBatch batch(*this);
+    batch.setThreadCount(threadCount);
+    return batch.parseFiles(fileNames);
 }
 
 QString version()
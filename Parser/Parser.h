@@ -21,14 +21,25 @@
 #include <memory>
 
 #include <QObject>
+#include <QByteArrayView>
 
 #include "orgmodeparser_export.h"
 #include <OrgElement.h>
+#include <OrgFile.h>
+#include <ParseBatch.h>
+#include <CompactDocument.h>
 
 class QTextStream;
 
 namespace OrgMode {
 
+class OrgEventHandler;
+
+/** @brief Parser creates an element tree from OrgMode text.
+ *
+ * All state of a parse is kept on the stack of the calling thread. The parse methods are reentrant and thread-safe,
+ * one Parser can be shared by any number of threads.
+ */
 class ORGMODEPARSER_EXPORT Parser : public QObject
 {
     Q_OBJECT
@@ -37,6 +48,23 @@ public:
     ~Parser() override;
 
     OrgElement::Pointer parse(QTextStream* data, const QString& fileName = QString()) const;
+    OrgElement::Pointer parse(QByteArrayView data, const QString& fileName = QString()) const;
+    OrgElement::Pointer parseFile(const QString& fileName) const;
+    OrgElement::Pointer reparse(const OrgFile::Pointer& file, int firstLine, int lineCount,
+                                const QString& text) const;
+    void parse(QByteArrayView data, OrgEventHandler* handler) const;
+    void parseFile(const QString& fileName, OrgEventHandler* handler) const;
+    CompactDocument parseCompact(QByteArrayView data, const QString& fileName = QString()) const;
+    ParseBatch::Results parseFiles(const QStringList& fileNames, int threadCount = 0) const;
+
+    void setParallelParsing(bool enabled);
+    bool parallelParsing() const;
+    void setChunkSize(qsizetype bytes);
+    qsizetype chunkSize() const;
+    void setLazyParsing(bool enabled);
+    bool lazyParsing() const;
+    void setArenaAllocation(bool enabled);
+    bool arenaAllocation() const;
 private:
     struct Private;
     std::unique_ptr<Private> d;
@@ -19,7 +19,6 @@
 #include <QMap>
 
 #include <Properties.h>
-#include <FileAttributeLine.h>
 #include <Exception.h>
 #include <OrgFile.h>
 #include <Drawer.h>
@@ -32,10 +31,12 @@ namespace OrgMode {
 
 class Properties::Private {
 public:
-    explicit Private(const OrgElement::Pointer &element)
+    explicit Private(const OrgElement::Pointer &element, const PropertyIndex::Pointer& index = PropertyIndex::Pointer())
         : element_(element)
+        , index_(index)
     {}
     OrgElement::Pointer element_;
+    PropertyIndex::Pointer index_;
 };
 
 Properties::Properties(const OrgElement::Pointer &element)
@@ -43,6 +44,12 @@ Properties::Properties(const OrgElement::Pointer &element)
 {
 }
 
+/** @brief Query the properties of element in index, which has to contain element. */
+Properties::Properties(const OrgElement::Pointer &element, const PropertyIndex::Pointer &index)
+    : d(new Private(element, index))
+{
+}
+
 Properties::Properties(Properties && other) = default;
 Properties& Properties::operator=(Properties &&other) = default;
 Properties::~Properties() = default;
@@ -50,40 +57,19 @@ Properties::~Properties() = default;
 /** @brief Query the specified property for this element. */
 QString Properties::property(const QString& key) const
 {
-    //Collect attribute lines that are propeties:
-    Attributes attributes(d->element_);
-    const Vector attr(attributes.fileAttributes(QString::fromLatin1("PROPERTY")));
-    //Traverse the element chain up to the next OrgFile, collecting property definitions for the specified key on the way:
-    QList<PropertyDrawerEntry::Pointer> propertyDrawerEntries;
-    OrgElement* element(d->element_.data());
-    while(element) {
-        auto const drawers = findElements<PropertyDrawer>(element, 1);
-        for(auto const& drawer : drawers) {
-            auto isPropertyEntryForKey = [key](const PropertyDrawerEntry::Pointer& element) {
-                return element->key() == key;
-            };
-            auto const elementPropertyDrawers = findElements<PropertyDrawerEntry>(drawer, isPropertyEntryForKey, 1);
-            propertyDrawerEntries = elementPropertyDrawers + propertyDrawerEntries;
+    if (!d->index_) {
+        //Elements inherit from their closest file, which keeps an index for all of its elements:
+        OrgElement* document = d->element_.data();
+        while (document && document->parent() && !document->isKindOf(OrgFile::StaticKind)) {
+            document = document->parent();
         }
-        element = element->parent();
-    }
-    //Create single list of all definitions that affect the property:
-    Vector definitions;
-    for(auto const& prop : attr) {
-        Property property  = parseAttributeAsProperty(prop);
-        if (property.key() == key) {
-            definitions << property;
+        if (auto const file = element_cast<OrgFile>(document)) {
+            d->index_ = file->propertyIndex();
+        } else {
+            d->index_ = PropertyIndex::Pointer(new PropertyIndex(OrgElement::Pointer(document, NilDeleter)));
         }
     }
-    for( auto const& entry : propertyDrawerEntries ) {
-        definitions << entry->property();
-    }
-    if (definitions.isEmpty()) {
-        throw RuntimeException(tr("Undefined property %1").arg(key));
-    }
-    //Calculate property value:
-    const QString result = propertyValue(key, definitions);
-    return result;
+    return d->index_->property(d->element_.data(), key);
 }
 
 Properties::Vector Properties::properties() const
@@ -123,7 +109,8 @@ QString Properties::propertyValue(const QString &key, const Properties::Vector &
 
 Property Properties::parseAttributeAsProperty(const Property& attribute)
 {
-    const QRegularExpression re(QString::fromLatin1("^(\\w+)(\\+{0,1})\\s+(\\w.*)$"));
+    //The expression is compiled once, matching is thread-safe:
+    static const QRegularExpression re(QString::fromLatin1("^(\\w+)(\\+{0,1})\\s+(\\w.*)$"));
     auto const match = re.match(attribute.value());
     if (match.hasMatch()) {
         Property result;
@@ -25,6 +25,7 @@
 #include "orgmodeparser_export.h"
 #include <OrgElement.h>
 #include <Attributes.h>
+#include <PropertyIndex.h>
 
 namespace OrgMode {
 
@@ -35,6 +36,10 @@ namespace OrgMode {
  *
  * See http://orgmode.org/manual/Property-syntax.html. The OrgModePropertiesExample.org resource emulates the
  * examples from the OrgMode manual and verifies with unit tests that the results are as expected.
+ *
+ * Property values are looked up in a PropertyIndex of the document. Elements of a file share the index the file
+ * keeps, see OrgFile::propertyIndex(). For elements that are not part of a file, the index is built for the first
+ * query of every Properties object, unless a shared index is passed to the constructor.
  */
 class ORGMODEPARSER_EXPORT Properties
 {
@@ -43,6 +48,7 @@ public:
     typedef QVector<Property> Vector;
 
     explicit Properties(const OrgElement::Pointer& element);
+    Properties(const OrgElement::Pointer& element, const PropertyIndex::Pointer& index);
     Properties(const Properties&) = delete;
     Properties& operator=(const Properties&);
     Properties(Properties&&);
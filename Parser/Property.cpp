@@ -17,12 +17,13 @@
 */
 #include "Exception.h"
 #include "Property.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class Property::Private {
+class Property::Private : public ArenaAllocated {
 public:
-    Private(QString key_, QString value_, Property::Operation operation_)
+    Private(const SourceText& key_, const SourceText& value_, Property::Operation operation_)
         : key(key_)
         , value(value_)
         , operation(operation_)
@@ -34,23 +35,29 @@ public:
                 && operation == other.operation;
     }
 
-    QString key;
-    QString value;
+    SourceText key;
+    SourceText value;
     Property::Operation operation;
 };
 
 Property::Property(const QString &key, const QString &value, Operation op)
+    : d(new Private(SourceText(key), SourceText(value), op))
+{
+}
+
+/** @brief A property whose key and value are slices of a source buffer, usually of the line of an element. */
+Property::Property(const SourceText &key, const SourceText &value, Operation op)
     : d(new Private(key, value, op))
 {
 }
 
 Property::Property()
-    : Property(QString(), QString())
+    : Property(SourceText(), SourceText())
 {
 }
 
 Property::Property(const Property& other)
-    : Property(other.key(), other.value(), other.operation())
+    : d(new Private(*other.d))
 {
 }
 
@@ -73,17 +80,17 @@ bool Property::operator==(const Property& other) const
 
 bool Property::isValid() const
 {
-    return !key().isEmpty();
+    return !d->key.isEmpty();
 }
 
 void Property::apply(const Property &token)
 {
     if (token.operation() == Property::Property_Define) {
-        d->key = token.key();
-        d->value = token.value();
+        d->key = token.d->key;
+        d->value = token.d->value;
     } else if (token.operation() == Property::Property_Add) {
-        d->key = token.key();
-        d->value = QString::fromLatin1("%1 %2").arg(d->value).arg(token.value());
+        d->key = token.d->key;
+        d->value = SourceText(QString::fromLatin1("%1 %2").arg(value()).arg(token.value()));
     } else {
         Q_ASSERT_X(false, Q_FUNC_INFO, "Unsupported operation!");
     }
@@ -91,22 +98,45 @@ void Property::apply(const Property &token)
 
 QString Property::key() const
 {
-    return d->key;
+    return d->key.toString();
+}
+
+/** @brief The UTF-8 encoded key, without decoding it. The view is valid until the key is changed. */
+QUtf8StringView Property::keyView() const
+{
+    return d->key.view();
 }
 
 void Property::setKey(const QString &key)
+{
+    d->key = SourceText(key);
+}
+
+void Property::setKey(const SourceText &key)
 {
     d->key = key;
 }
 
 QString Property::value() const
+{
+    return d->value.toString();
+}
+
+/** @brief The UTF-8 encoded value, without decoding it. The view is valid until the value is changed. */
+QUtf8StringView Property::valueView() const
+{
+    return d->value.view();
+}
+
+/** @brief The value as it is stored, which is usually a slice of the line of an element. */
+SourceText Property::valueText() const
 {
     return d->value;
 }
 
 void Property::setValue(const QString &value) const
 {
-    d->value = value;
+    d->value = SourceText(value);
 }
 
 Property::Operation Property::operation() const
@@ -24,6 +24,7 @@
 #include <QString>
 
 #include "orgmodeparser_export.h"
+#include "SourceText.h"
 
 namespace OrgMode {
 
@@ -38,6 +39,7 @@ public:
 
     Property();
     explicit Property(const QString& key, const QString& value, Operation op = Property_Define);
+    Property(const SourceText& key, const SourceText& value, Operation op = Property_Define);
     Property(const Property& other);
     Property& operator=(const Property&);
 
@@ -51,9 +53,13 @@ public:
     void apply(const Property& token);
 
     QString key() const;
+    QUtf8StringView keyView() const;
     void setKey(const QString& key);
+    void setKey(const SourceText& key);
 
     QString value() const;
+    QUtf8StringView valueView() const;
+    SourceText valueText() const;
     void setValue(const QString& value) const;
 
     Operation operation() const;
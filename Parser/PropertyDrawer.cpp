@@ -16,10 +16,11 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "PropertyDrawer.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class PropertyDrawer::Private {
+class PropertyDrawer::Private : public ArenaAllocated {
 public:
 };
 
@@ -32,6 +33,7 @@ PropertyDrawer::PropertyDrawer(const QString &line, OrgElement *parent)
     : Drawer(line, parent)
     , d(new Private())
 {
+    setKind(PropertyDrawerKind);
 }
 
 PropertyDrawer::PropertyDrawer(PropertyDrawer && other) = default;
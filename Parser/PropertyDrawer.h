@@ -32,6 +32,7 @@ class ORGMODEPARSER_EXPORT PropertyDrawer : public Drawer
     Q_DECLARE_TR_FUNCTIONS(PropertyDrawer)
 public:
     typedef QSharedPointer<PropertyDrawer> Pointer;
+    static const Kind StaticKind = PropertyDrawerKind;
 
     explicit PropertyDrawer(OrgElement* parent = nullptr);
     explicit PropertyDrawer(const QString& line, OrgElement* parent = nullptr);
@@ -16,10 +16,11 @@
     OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "PropertyDrawerEntry.h"
+#include "Arena.h"
 
 namespace OrgMode {
 
-class PropertyDrawerEntry::Private {
+class PropertyDrawerEntry::Private : public ArenaAllocated {
 public:
 };
 
@@ -33,6 +34,7 @@ PropertyDrawerEntry::PropertyDrawerEntry(const QString &line, OrgElement *parent
     : DrawerEntry(line, parent)
     , d(new Private)
 {
+    setKind(PropertyDrawerEntryKind);
 }
 
 PropertyDrawerEntry::PropertyDrawerEntry(PropertyDrawerEntry && other) = default;
@@ -32,6 +32,7 @@ class ORGMODEPARSER_EXPORT PropertyDrawerEntry : public DrawerEntry
     Q_DECLARE_TR_FUNCTIONS(PropertyDrawerEntry)
 public:
     typedef QSharedPointer<PropertyDrawerEntry> Pointer;
+    static const Kind StaticKind = PropertyDrawerEntryKind;
 
     explicit PropertyDrawerEntry(OrgElement* parent = nullptr);
     explicit PropertyDrawerEntry(const QString& line, OrgElement* parent = nullptr);
@@ -0,0 +1,251 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "PropertyIndex.h"
+#include "Properties.h"
+#include "Exception.h"
+#include "OrgFile.h"
+#include "FileAttributeLine.h"
+#include "PropertyDrawer.h"
+#include "PropertyDrawerEntry.h"
+#include "Traversal.h"
+
+namespace OrgMode {
+
+struct PropertyIndex::Private {
+    struct Definition {
+        QString key;
+        Property property;
+    };
+
+    //The resolved value of a key at a node, defined is false if no definition applies:
+    struct Value {
+        bool defined;
+        QString value;
+    };
+
+    //An element that has property drawers, an OrgFile, or the document:
+    struct Node {
+        const Node* parent = nullptr;
+        //Set for OrgFiles, which do not inherit from their ancestors:
+        const OrgFile* file = nullptr;
+        QVector<Definition> definitions;
+        QHash<QString, Value> values;
+    };
+
+    const Node* nodeFor(const OrgElement* element) const;
+    const OrgFile* fileOf(const OrgElement* element) const;
+    Value resolve(const Node* node, const QString& key);
+
+    OrgElement* document_ = nullptr;
+    //The file the document is part of, and its revision when the index was built:
+    const OrgFile* file_ = nullptr;
+    int revision_ = 0;
+    //The PROPERTY file attributes of the files of the document:
+    QHash<const OrgFile*, QVector<Definition>> fileProperties_;
+    QHash<const OrgElement*, Node> nodes_;
+    QMutex mutex_;
+};
+
+/** @brief The node of element or of its closest ancestor that has one, nullptr if element is not in the document. */
+const PropertyIndex::Private::Node* PropertyIndex::Private::nodeFor(const OrgElement *element) const
+{
+    for (; element; element = element->parent()) {
+        auto const it = nodes_.constFind(element);
+        if (it != nodes_.constEnd()) {
+            return &it.value();
+        }
+    }
+    return nullptr;
+}
+
+/** @brief The closest OrgFile at or above element that is part of the document, nullptr if there is none. */
+const OrgFile* PropertyIndex::Private::fileOf(const OrgElement *element) const
+{
+    for (; element; element = element->parent()) {
+        if (auto const file = element_cast<OrgFile>(element)) {
+            return file;
+        }
+        if (element == document_) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+/** @brief Resolve key at node, applying its definitions to the value inherited from its parent.
+ *
+ * Files start from their PROPERTY file attributes instead, so that files that are part of one document do not
+ * inherit from each other.
+ */
+PropertyIndex::Private::Value PropertyIndex::Private::resolve(const Node *node, const QString &key)
+{
+    //Nodes are not moved once the index is built, the values are the only part that is changed:
+    Node* mutableNode = const_cast<Node*>(node);
+    auto const it = mutableNode->values.constFind(key);
+    if (it != mutableNode->values.constEnd()) {
+        return it.value();
+    }
+    Property property;
+    bool defined = false;
+    if (node->file) {
+        for(auto const& definition : fileProperties_.value(node->file)) {
+            if (definition.key == key) {
+                property.apply(definition.property);
+                defined = true;
+            }
+        }
+    } else if (node->parent) {
+        const Value inherited = resolve(node->parent, key);
+        if (inherited.defined) {
+            property = Property(key, inherited.value);
+            defined = true;
+        }
+    }
+    for(auto const& definition : node->definitions) {
+        if (definition.key == key) {
+            property.apply(definition.property);
+            defined = true;
+        }
+    }
+    const Value value = { defined, defined ? property.value() : QString() };
+    mutableNode->values.insert(key, value);
+    return value;
+}
+
+PropertyIndex::PropertyIndex(const OrgElement::Pointer &document)
+    : d(new Private)
+{
+    if (!document) {
+        return;
+    }
+    d->document_ = document.data();
+    for (const OrgElement* element = d->document_; element && !d->file_; element = element->parent()) {
+        d->file_ = element_cast<OrgFile>(element);
+    }
+    d->revision_ = d->file_ ? d->file_->revision() : 0;
+    d->nodes_.insert(d->document_, Private::Node());
+    for (auto const& element : preorder(document)) {
+        auto const drawer = element_cast<PropertyDrawer>(element);
+        if (drawer && drawer->parent()) {
+            Private::Node& node = d->nodes_[drawer->parent()];
+            for(auto const& child : drawer->childSpan()) {
+                if (auto const entry = element_cast<PropertyDrawerEntry>(child)) {
+                    const Property property = entry->property();
+                    node.definitions.append(Private::Definition{ property.key(), property });
+                }
+            }
+        } else if (auto const file = element_cast<OrgFile>(element)) {
+            d->nodes_[file.data()].file = file.data();
+        } else if (auto const attribute = element_cast<FileAttributeLine>(element)) {
+            //File attributes belong to the closest file, as in Attributes::fileAttributes():
+            auto const file = d->fileOf(attribute->parent());
+            if (file && attribute->key() == QLatin1String("PROPERTY")) {
+                const Property property = Properties::parseAttributeAsProperty(attribute->property());
+                if (property.isValid()) {
+                    d->fileProperties_[file].append(Private::Definition{ property.key(), property });
+                }
+            }
+        }
+    }
+    //Link the nodes to the nodes of their closest ancestors:
+    for (auto it = d->nodes_.begin(); it != d->nodes_.end(); ++it) {
+        if (it.key() != d->document_) {
+            it.value().parent = d->nodeFor(it.key()->parent());
+        }
+    }
+}
+
+PropertyIndex::~PropertyIndex() = default;
+
+OrgElement *PropertyIndex::document() const
+{
+    return d->document_;
+}
+
+/** @brief Return true if the file of the document has been changed since the index was built.
+ *
+ * A stale index refers to elements that may have been destroyed, queries throw a RuntimeException.
+ */
+bool PropertyIndex::isStale() const
+{
+    return d->file_ && d->file_->revision() != d->revision_;
+}
+
+/** @brief The definitions of PROPERTY file attributes of the closest file of element, in the order they are defined.
+ *
+ * If element is nullptr, the file properties of the document are returned.
+ */
+PropertyIndex::Vector PropertyIndex::fileProperties(const OrgElement *element) const
+{
+    Vector result;
+    for(auto const& definition : d->fileProperties_.value(d->fileOf(element ? element : d->document_))) {
+        result.append(definition.property);
+    }
+    return result;
+}
+
+/** @brief The definitions in the property drawers of element, in the order they are defined. */
+PropertyIndex::Vector PropertyIndex::definitions(const OrgElement *element) const
+{
+    Vector result;
+    auto const it = d->nodes_.constFind(element);
+    if (it != d->nodes_.constEnd()) {
+        for(auto const& definition : it.value().definitions) {
+            result.append(definition.property);
+        }
+    }
+    return result;
+}
+
+/** @brief Resolve the value of key for element, including inherited definitions.
+ *
+ * Returns false if the property is not defined for element. A RuntimeException is thrown if element is not part
+ * of the indexed document, or if the index is stale.
+ */
+bool PropertyIndex::resolve(const OrgElement *element, const QString &key, QString *value) const
+{
+    if (isStale()) {
+        throw RuntimeException(tr("The indexed document has been changed!"));
+    }
+    auto const node = d->nodeFor(element);
+    if (!node) {
+        throw RuntimeException(tr("The element is not part of the indexed document!"));
+    }
+    QMutexLocker locker(&d->mutex_);
+    const Private::Value result = d->resolve(node, key);
+    if (result.defined && value) {
+        *value = result.value;
+    }
+    return result.defined;
+}
+
+/** @brief Return the value of key for element. A RuntimeException is thrown if it is not defined. */
+QString PropertyIndex::property(const OrgElement *element, const QString &key) const
+{
+    QString value;
+    if (!resolve(element, key, &value)) {
+        throw RuntimeException(tr("Undefined property %1").arg(key));
+    }
+    return value;
+}
+
+}
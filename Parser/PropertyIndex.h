@@ -0,0 +1,71 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PROPERTYINDEX_H
+#define PROPERTYINDEX_H
+
+#include <memory>
+
+#include <QCoreApplication>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+#include <Property.h>
+
+namespace OrgMode {
+
+/** @brief PropertyIndex resolves the inherited properties of the elements of a document.
+ *
+ * The index is built in one traversal of the document. It keeps the PROPERTY file attributes of every file and, for
+ * every element that has property drawers, the definitions of its drawers. Elements inherit from the closest file
+ * they are part of, files do not inherit from the files that contain them. Resolved values are memoized per element
+ * and key, so that repeated queries, for example for columns of a report over all headlines, are lookups.
+ * Definitions with the key+ syntax are accumulated as described in Property::apply().
+ *
+ * Queries are thread-safe. The index refers to the elements by address, and has to be built again after the
+ * document has been changed. Changes that increment the revision of the file of the document, like
+ * Parser::reparse(), are detected, see isStale() and OrgFile::markChanged().
+ */
+class ORGMODEPARSER_EXPORT PropertyIndex
+{
+    Q_DECLARE_TR_FUNCTIONS(PropertyIndex)
+public:
+    typedef QSharedPointer<PropertyIndex> Pointer;
+    typedef QVector<Property> Vector;
+
+    explicit PropertyIndex(const OrgElement::Pointer& document);
+    PropertyIndex(const PropertyIndex&) = delete;
+    PropertyIndex& operator=(const PropertyIndex&) = delete;
+    ~PropertyIndex();
+
+    OrgElement* document() const;
+    bool isStale() const;
+    Vector fileProperties(const OrgElement* element = nullptr) const;
+    Vector definitions(const OrgElement* element) const;
+    bool resolve(const OrgElement* element, const QString& key, QString* value) const;
+    QString property(const OrgElement* element, const QString& key) const;
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // PROPERTYINDEX_H
@@ -0,0 +1,137 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstring>
+
+#include "SourceText.h"
+
+namespace OrgMode {
+
+namespace {
+
+/** The number of bytes of text, encoded as UTF-8. */
+qsizetype utf8Length(QStringView text)
+{
+    qsizetype length = 0;
+    for (const QChar c : text) {
+        const ushort code = c.unicode();
+        //The two surrogates of a code point take 4 bytes together:
+        length += code < 0x80 ? 1 : code < 0x800 || (code >= 0xd800 && code < 0xe000) ? 2 : 3;
+    }
+    return length;
+}
+
+}
+
+/** @brief Null text. */
+SourceText::SourceText()
+    : offset_(0)
+    , length_(-1)
+{
+}
+
+/** @brief Text that is kept in a buffer of its own. A null text results in a null SourceText. */
+SourceText::SourceText(const QString &text)
+    : source_(text.toUtf8())
+    , offset_(0)
+    , length_(text.isNull() ? -1 : source_.size())
+{
+}
+
+/** @brief The length bytes of source, starting at offset. source is shared, not copied. */
+SourceText::SourceText(const QByteArray &source, qsizetype offset, qsizetype length)
+    : source_(source)
+    , offset_(offset)
+    , length_(length)
+{
+    Q_ASSERT(offset >= 0 && length >= 0 && offset + length <= source.size());
+}
+
+/** @brief Compare the text, as QString does, a null text is equal to an empty one. */
+bool SourceText::operator==(const SourceText &other) const
+{
+    return size() == other.size()
+            && (size() == 0 || std::memcmp(view().data(), other.view().data(), size_t(size())) == 0);
+}
+
+bool SourceText::operator!=(const SourceText &other) const
+{
+    return !(*this == other);
+}
+
+bool SourceText::isNull() const
+{
+    return length_ < 0;
+}
+
+bool SourceText::isEmpty() const
+{
+    return length_ <= 0;
+}
+
+/** @brief The size of the text in bytes. */
+qsizetype SourceText::size() const
+{
+    return qMax<qsizetype>(length_, 0);
+}
+
+/** @brief Decode the text. An empty text results in an empty, but not null string. */
+QString SourceText::toString() const
+{
+    if (isNull()) {
+        return QString();
+    } else if (length_ == 0) {
+        return QString(QLatin1String(""));
+    }
+    return QString::fromUtf8(source_.constData() + offset_, length_);
+}
+
+/** @brief The UTF-8 text, without decoding it. The view is valid as long as the SourceText exists. */
+QUtf8StringView SourceText::view() const
+{
+    return isNull() ? QUtf8StringView() : QUtf8StringView(source_.constData() + offset_, length_);
+}
+
+/** @brief The shared buffer of the text. */
+QByteArray SourceText::source() const
+{
+    return source_;
+}
+
+/** @brief The slice of this text that holds part, a view into text, where text has been decoded from this text.
+ *
+ * If text has not been decoded from valid UTF-8, the offsets of text do not map to the bytes of the source, and
+ * part is copied instead.
+ */
+SourceText SourceText::slice(QStringView text, QStringView part) const
+{
+    Q_ASSERT(part.isNull() || (part.data() >= text.data() && part.data() + part.size() <= text.data() + text.size()));
+    if (part.isNull() || isNull()) {
+        return SourceText(part.toString());
+    }
+    const qsizetype begin = part.data() - text.data();
+    //Every character takes at least one byte. If the sizes are equal, every character is one byte:
+    if (text.size() == length_) {
+        return SourceText(source_, offset_ + begin, part.size());
+    }
+    if (utf8Length(text) != length_) {
+        return SourceText(part.toString());
+    }
+    return SourceText(source_, offset_ + utf8Length(text.left(begin)), utf8Length(part));
+}
+
+}
@@ -0,0 +1,64 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SOURCETEXT_H
+#define SOURCETEXT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStringView>
+
+#include "orgmodeparser_export.h"
+
+namespace OrgMode {
+
+/** @brief SourceText is UTF-8 text, stored as a slice of a shared, immutable buffer.
+ *
+ * The elements of a parse result keep their text as slices of one copy of the parsed file, instead of every element
+ * keeping a UTF-16 copy of its line. The text is decoded to a QString only when it is requested. Text that is set
+ * from a QString is kept in a buffer of its own. Slices keep the whole buffer alive.
+ * SourceText is a plain value, it is not implicitly shared itself, and has no private data, to keep it small.
+ */
+class ORGMODEPARSER_EXPORT SourceText {
+public:
+    SourceText();
+    explicit SourceText(const QString& text);
+    SourceText(const QByteArray& source, qsizetype offset, qsizetype length);
+
+    bool operator==(const SourceText& other) const;
+    bool operator!=(const SourceText& other) const;
+
+    bool isNull() const;
+    bool isEmpty() const;
+    qsizetype size() const;
+
+    QString toString() const;
+    QUtf8StringView view() const;
+    QByteArray source() const;
+
+    SourceText slice(QStringView text, QStringView part) const;
+
+private:
+    QByteArray source_;
+    qsizetype offset_;
+    //-1 for null text:
+    qsizetype length_;
+};
+
+}
+
+#endif // SOURCETEXT_H
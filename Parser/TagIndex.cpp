@@ -0,0 +1,336 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QHash>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "TagIndex.h"
+#include "Exception.h"
+
+namespace OrgMode {
+
+struct TagIndex::Private {
+    struct Postings {
+        PostingList direct;
+        PostingList inherited;
+    };
+
+    void collect(const OrgElement::Pointer& element);
+    void collectHeadline(const Headline::Pointer& headline);
+    int subtreeEnd(const Headline::Pointer& headline, int position) const;
+    void index(int begin, int end);
+    void remove(int begin, int end);
+
+    //The headlines in the order of the documents, and their positions:
+    Headline::List headlines_;
+    QHash<const Headline*, int> positions_;
+    QHash<QString, Postings> postings_;
+};
+
+void TagIndex::Private::collect(const OrgElement::Pointer &element)
+{
+    if (auto const headline = element_cast<Headline>(element)) {
+        collectHeadline(headline);
+        return;
+    }
+    for(auto const& child : element->childSpan()) {
+        collect(child);
+    }
+}
+
+/** @brief Add headline and its sub-headlines. The sections of lazily parsed headlines are not loaded. */
+void TagIndex::Private::collectHeadline(const Headline::Pointer &headline)
+{
+    positions_.insert(headline.data(), int(headlines_.size()));
+    headlines_.append(headline);
+    for(auto const& child : headline->headlines()) {
+        collectHeadline(child);
+    }
+}
+
+/** @brief The position after the subtree of headline, which is at position. Throws if the subtree has changed. */
+int TagIndex::Private::subtreeEnd(const Headline::Pointer &headline, int position) const
+{
+    if (positions_.value(headline.data(), -1) != position) {
+        throw RuntimeException(TagIndex::tr("The headlines have changed, the tag index needs to be built again!"));
+    }
+    int end = position + 1;
+    for(auto const& child : headline->headlines()) {
+        end = subtreeEnd(child, end);
+    }
+    return end;
+}
+
+/** @brief Add the postings of the headlines from begin to end, which are not in the posting lists. */
+void TagIndex::Private::index(int begin, int end)
+{
+    QHash<QString, Postings> added;
+    //Tags are looked up once per atom table:
+    AtomTable::Pointer atoms;
+    QVector<QString> names;
+    auto const name = [&atoms, &names](AtomTable::Atom atom) {
+        if (atom >= names.size()) {
+            names.resize(atoms->size());
+        }
+        QString& name = names[atom];
+        if (name.isNull()) {
+            name = atoms->string(atom);
+        }
+        return name;
+    };
+    for (int position = begin; position < end; ++position) {
+        const Headline::Pointer& headline = headlines_.at(position);
+        if (headline->atomTable() != atoms) {
+            atoms = headline->atomTable();
+            names.clear();
+        }
+        for(auto const atom : headline->tagSet().atoms()) {
+            added[name(atom)].direct.append(position);
+        }
+        for(auto const atom : headline->inheritedTagSet().atoms()) {
+            added[name(atom)].inherited.append(position);
+        }
+    }
+    //The new positions are a block in every posting list:
+    auto const insert = [](PostingList* list, const PostingList& block) {
+        if (!block.isEmpty()) {
+            auto const it = std::lower_bound(list->cbegin(), list->cend(), block.first());
+            PostingList merged;
+            merged.reserve(list->size() + block.size());
+            std::copy(list->cbegin(), it, std::back_inserter(merged));
+            std::copy(block.cbegin(), block.cend(), std::back_inserter(merged));
+            std::copy(it, list->cend(), std::back_inserter(merged));
+            *list = std::move(merged);
+        }
+    };
+    for (auto it = added.cbegin(); it != added.cend(); ++it) {
+        Postings& postings = postings_[it.key()];
+        insert(&postings.direct, it.value().direct);
+        insert(&postings.inherited, it.value().inherited);
+    }
+}
+
+/** @brief Remove the positions from begin to end from all posting lists. */
+void TagIndex::Private::remove(int begin, int end)
+{
+    auto const erase = [begin, end](PostingList* list) {
+        auto const first = std::lower_bound(list->begin(), list->end(), begin);
+        auto const last = std::lower_bound(first, list->end(), end);
+        list->erase(first, last);
+    };
+    QStringList unused;
+    for (auto it = postings_.begin(); it != postings_.end(); ++it) {
+        erase(&it.value().direct);
+        erase(&it.value().inherited);
+        if (it.value().direct.isEmpty() && it.value().inherited.isEmpty()) {
+            unused.append(it.key());
+        }
+    }
+    for(auto const& tag : unused) {
+        postings_.remove(tag);
+    }
+}
+
+/** @brief An empty index. */
+TagIndex::TagIndex()
+    : d(new Private)
+{
+}
+
+/** @brief Index the headlines of document, which is usually an OrgFile. */
+TagIndex::TagIndex(const OrgElement::Pointer &document)
+    : TagIndex()
+{
+    if (document) {
+        d->collect(document);
+        d->index(0, int(d->headlines_.size()));
+    }
+}
+
+TagIndex::TagIndex(const TagIndex &other)
+    : d(new Private(*other.d))
+{
+}
+
+TagIndex& TagIndex::operator=(const TagIndex &other)
+{
+    if (this != &other) {
+        *d = *other.d;
+    }
+    return *this;
+}
+
+TagIndex::TagIndex(TagIndex && other) = default;
+TagIndex& TagIndex::operator=(TagIndex &&other) = default;
+TagIndex::~TagIndex() = default;
+
+int TagIndex::headlineCount() const
+{
+    return int(d->headlines_.size());
+}
+
+Headline::Pointer TagIndex::headline(int position) const
+{
+    return d->headlines_.value(position);
+}
+
+/** @brief The position of headline, or -1 if it is not in the index. */
+int TagIndex::position(const Headline::Pointer &headline) const
+{
+    return d->positions_.value(headline.data(), -1);
+}
+
+Headline::List TagIndex::headlines(const PostingList &postings) const
+{
+    Headline::List result;
+    result.reserve(postings.size());
+    for(auto const position : postings) {
+        result.append(d->headlines_.at(position));
+    }
+    return result;
+}
+
+/** @brief The tags that at least one headline has, in no particular order. */
+QStringList TagIndex::tags() const
+{
+    return d->postings_.keys();
+}
+
+/** @brief The positions of the headlines that have tag, in ascending order. */
+TagIndex::PostingList TagIndex::postings(const QString &tag, Occurrence occurrence) const
+{
+    auto const it = d->postings_.constFind(tag);
+    if (it == d->postings_.constEnd()) {
+        return PostingList();
+    }
+    switch (occurrence) {
+    case Direct:
+        return it.value().direct;
+    case Inherited:
+        return it.value().inherited;
+    default:
+        return unite(it.value().direct, it.value().inherited);
+    }
+}
+
+/** @brief The positions of the headlines that have all tags of required and none of excluded, directly or inherited.
+ *
+ * If required is empty, all headlines that have none of the excluded tags are returned.
+ */
+TagIndex::PostingList TagIndex::query(const QStringList &required, const QStringList &excluded) const
+{
+    QVector<PostingList> lists;
+    for(auto const& tag : required) {
+        lists.append(postings(tag));
+    }
+    //Intersecting the shortest lists first keeps the intermediate results short:
+    std::sort(lists.begin(), lists.end(), [](const PostingList& first, const PostingList& second) {
+        return first.size() < second.size();
+    });
+    PostingList result;
+    if (lists.isEmpty()) {
+        result.resize(d->headlines_.size());
+        std::iota(result.begin(), result.end(), 0);
+    } else {
+        result = lists.first();
+        for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+            result = intersect(result, lists.at(i));
+        }
+    }
+    for(auto const& tag : excluded) {
+        if (result.isEmpty()) {
+            break;
+        }
+        result = subtract(result, postings(tag));
+    }
+    return result;
+}
+
+/** @brief Append the headlines of other to the index, their positions follow the ones of this index.
+ *
+ * The indexes have to be built for different documents. A RuntimeException is thrown if they share headlines.
+ */
+void TagIndex::merge(const TagIndex &other)
+{
+    //This also rejects merging an index into itself, before the lists that are read are changed:
+    for(auto const& headline : other.d->headlines_) {
+        if (d->positions_.contains(headline.data())) {
+            throw RuntimeException(tr("The tag indexes contain the same headlines and cannot be merged!"));
+        }
+    }
+    const int offset = headlineCount();
+    for(auto const& headline : other.d->headlines_) {
+        d->positions_.insert(headline.data(), int(d->headlines_.size()));
+        d->headlines_.append(headline);
+    }
+    for (auto it = other.d->postings_.cbegin(); it != other.d->postings_.cend(); ++it) {
+        Private::Postings& postings = d->postings_[it.key()];
+        for(auto const position : it.value().direct) {
+            postings.direct.append(offset + position);
+        }
+        for(auto const position : it.value().inherited) {
+            postings.inherited.append(offset + position);
+        }
+    }
+}
+
+/** @brief Refresh the postings of headline and its sub-headlines, after tags have been changed.
+ *
+ * Changing the tags of a headline changes the inherited tags of its sub-headlines, see Headline::addTag(). A
+ * RuntimeException is thrown if the headline is not in the index, or if its subtree has changed since the index
+ * was built.
+ */
+void TagIndex::update(const Headline::Pointer &headline)
+{
+    const int begin = position(headline);
+    if (begin < 0) {
+        throw RuntimeException(tr("The headline is not part of the tag index!"));
+    }
+    const int end = d->subtreeEnd(headline, begin);
+    d->remove(begin, end);
+    d->index(begin, end);
+}
+
+/** @brief The positions that are in both posting lists. */
+TagIndex::PostingList TagIndex::intersect(const PostingList &first, const PostingList &second)
+{
+    PostingList result;
+    std::set_intersection(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+    return result;
+}
+
+/** @brief The positions that are in either posting list. */
+TagIndex::PostingList TagIndex::unite(const PostingList &first, const PostingList &second)
+{
+    PostingList result;
+    result.reserve(first.size() + second.size());
+    std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+    return result;
+}
+
+/** @brief The positions of first that are not in second. */
+TagIndex::PostingList TagIndex::subtract(const PostingList &first, const PostingList &second)
+{
+    PostingList result;
+    std::set_difference(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+    return result;
+}
+
+}
@@ -0,0 +1,84 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <memory>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include <Headline.h>
+
+namespace OrgMode {
+
+/** @brief TagIndex maps the tags of documents to the sorted lists of the headlines that have them.
+ *
+ * Headlines are numbered in the order of the documents (their position), and every tag has a posting list of the
+ * positions of the headlines that have it directly, and of those that inherit it (see Headline::inheritedTagSet()).
+ * Boolean tag queries are intersections, unions and differences of posting lists, and take time in the order of
+ * the length of the lists instead of the size of the documents.
+ *
+ * Indexes of several documents can be merged. After the tags of a headline have been changed, update() refreshes
+ * the postings of its subtree. The index has to be built again when headlines are added, moved or removed.
+ */
+class ORGMODEPARSER_EXPORT TagIndex
+{
+    Q_DECLARE_TR_FUNCTIONS(TagIndex)
+public:
+    typedef QVector<int> PostingList;
+    enum Occurrence {
+        Direct = 0x1,
+        Inherited = 0x2,
+        DirectOrInherited = Direct | Inherited
+    };
+
+    TagIndex();
+    explicit TagIndex(const OrgElement::Pointer& document);
+    TagIndex(const TagIndex& other);
+    TagIndex& operator=(const TagIndex& other);
+    TagIndex(TagIndex&&);
+    TagIndex& operator=(TagIndex&&);
+    ~TagIndex();
+
+    int headlineCount() const;
+    Headline::Pointer headline(int position) const;
+    int position(const Headline::Pointer& headline) const;
+    Headline::List headlines(const PostingList& postings) const;
+
+    QStringList tags() const;
+    PostingList postings(const QString& tag, Occurrence occurrence = DirectOrInherited) const;
+    PostingList query(const QStringList& required, const QStringList& excluded = QStringList()) const;
+
+    void merge(const TagIndex& other);
+    void update(const Headline::Pointer& headline);
+
+    static PostingList intersect(const PostingList& first, const PostingList& second);
+    static PostingList unite(const PostingList& first, const PostingList& second);
+    static PostingList subtract(const PostingList& first, const PostingList& second);
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif // TAGINDEX_H
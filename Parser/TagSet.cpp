@@ -0,0 +1,193 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtAlgorithms>
+
+#include "TagSet.h"
+
+namespace OrgMode {
+
+TagSet::TagSet()
+    : first_(0)
+{
+}
+
+bool TagSet::operator==(const TagSet &other) const
+{
+    //Trailing zero words are removed, so equal sets have equal words:
+    return first_ == other.first_ && words_ == other.words_;
+}
+
+bool TagSet::operator!=(const TagSet &other) const
+{
+    return !(*this == other);
+}
+
+/** @brief Return true if the set contains all tags of other. */
+bool TagSet::containsAll(const TagSet &other) const
+{
+    if ((first_ & other.first_) != other.first_ || other.words_.size() > words_.size()) {
+        return false;
+    }
+    for (int word = 0; word < other.words_.size(); ++word) {
+        if ((words_.at(word) & other.words_.at(word)) != other.words_.at(word)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Return true if the set contains at least one tag of other. */
+bool TagSet::intersects(const TagSet &other) const
+{
+    if (first_ & other.first_) {
+        return true;
+    }
+    const int words = int(qMin(words_.size(), other.words_.size()));
+    for (int word = 0; word < words; ++word) {
+        if (words_.at(word) & other.words_.at(word)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TagSet::isEmpty() const
+{
+    return first_ == 0 && words_.isEmpty();
+}
+
+int TagSet::count() const
+{
+    int count = int(qPopulationCount(first_));
+    for(auto const word : words_) {
+        count += int(qPopulationCount(word));
+    }
+    return count;
+}
+
+void TagSet::insert(AtomTable::Atom tag)
+{
+    Q_ASSERT(tag >= 0);
+    if (tag < WordBits) {
+        first_ |= quint64(1) << tag;
+        return;
+    }
+    const int word = tag / WordBits - 1;
+    if (word >= words_.size()) {
+        words_.resize(word + 1);
+    }
+    words_[word] |= quint64(1) << (tag % WordBits);
+}
+
+void TagSet::remove(AtomTable::Atom tag)
+{
+    if (tag < 0) {
+        return;
+    } else if (tag < WordBits) {
+        first_ &= ~(quint64(1) << tag);
+        return;
+    }
+    const int word = tag / WordBits - 1;
+    if (word < words_.size()) {
+        words_[word] &= ~(quint64(1) << (tag % WordBits));
+        trim();
+    }
+}
+
+void TagSet::clear()
+{
+    first_ = 0;
+    words_.clear();
+}
+
+TagSet &TagSet::operator|=(const TagSet &other)
+{
+    first_ |= other.first_;
+    if (other.words_.size() > words_.size()) {
+        words_.resize(other.words_.size());
+    }
+    for (int word = 0; word < other.words_.size(); ++word) {
+        words_[word] |= other.words_.at(word);
+    }
+    return *this;
+}
+
+TagSet &TagSet::operator&=(const TagSet &other)
+{
+    first_ &= other.first_;
+    words_.resize(qMin(words_.size(), other.words_.size()));
+    for (int word = 0; word < words_.size(); ++word) {
+        words_[word] &= other.words_.at(word);
+    }
+    trim();
+    return *this;
+}
+
+/** @brief Remove the tags of other from the set. */
+TagSet &TagSet::operator-=(const TagSet &other)
+{
+    first_ &= ~other.first_;
+    const int words = int(qMin(words_.size(), other.words_.size()));
+    for (int word = 0; word < words; ++word) {
+        words_[word] &= ~other.words_.at(word);
+    }
+    trim();
+    return *this;
+}
+
+TagSet TagSet::operator|(const TagSet &other) const
+{
+    TagSet result(*this);
+    return result |= other;
+}
+
+TagSet TagSet::operator&(const TagSet &other) const
+{
+    TagSet result(*this);
+    return result &= other;
+}
+
+TagSet TagSet::operator-(const TagSet &other) const
+{
+    TagSet result(*this);
+    return result -= other;
+}
+
+/** @brief The atoms of the tags in the set, in ascending order. */
+QVector<AtomTable::Atom> TagSet::atoms() const
+{
+    QVector<AtomTable::Atom> atoms;
+    for (int word = -1; word < words_.size(); ++word) {
+        quint64 bits = word < 0 ? first_ : words_.at(word);
+        while (bits) {
+            const int bit = qCountTrailingZeroBits(bits);
+            atoms.append((word + 1) * WordBits + bit);
+            bits &= bits - 1;
+        }
+    }
+    return atoms;
+}
+
+void TagSet::trim()
+{
+    while (!words_.isEmpty() && words_.last() == 0) {
+        words_.removeLast();
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TAGSET_H
+#define TAGSET_H
+
+#include <QVector>
+
+#include "orgmodeparser_export.h"
+#include "AtomTable.h"
+
+namespace OrgMode {
+
+/** @brief TagSet is a set of tags, stored as a bitset over the atoms of a document.
+ *
+ * The bit position of a tag is its atom in the atom table of the document. Sets are combined and compared a
+ * machine word at a time. The first 64 atoms are kept inline, so that sets of the usual documents do not allocate.
+ * Sets can only be combined if their atoms are from the same table.
+ */
+class ORGMODEPARSER_EXPORT TagSet
+{
+public:
+    TagSet();
+
+    bool operator==(const TagSet& other) const;
+    bool operator!=(const TagSet& other) const;
+
+    /** @brief Return true if the set contains tag. */
+    bool contains(AtomTable::Atom tag) const
+    {
+        if (tag < 0) {
+            return false;
+        } else if (tag < WordBits) {
+            return first_ & (quint64(1) << tag);
+        }
+        const int word = tag / WordBits - 1;
+        return word < words_.size() && (words_.at(word) & (quint64(1) << (tag % WordBits)));
+    }
+    bool containsAll(const TagSet& other) const;
+    bool intersects(const TagSet& other) const;
+    bool isEmpty() const;
+    int count() const;
+
+    void insert(AtomTable::Atom tag);
+    void remove(AtomTable::Atom tag);
+    void clear();
+
+    TagSet& operator|=(const TagSet& other);
+    TagSet& operator&=(const TagSet& other);
+    TagSet& operator-=(const TagSet& other);
+    TagSet operator|(const TagSet& other) const;
+    TagSet operator&(const TagSet& other) const;
+    TagSet operator-(const TagSet& other) const;
+
+    QVector<AtomTable::Atom> atoms() const;
+
+private:
+    static const int WordBits = 64;
+    void trim();
+
+    quint64 first_;
+    //The words for the atoms from 64 on, without trailing zero words:
+    QVector<quint64> words_;
+};
+
+}
+
+#endif // TAGSET_H
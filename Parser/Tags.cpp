@@ -27,26 +27,8 @@ public:
     {}
 
     Headline::Pointer element_;
-
-    bool isTagged(Headline* element, const QString& tag);
 };
 
-bool Tags::Private::isTagged(Headline *element, const QString &tag)
-{
-    auto const tags = element->tags();
-    auto const it = std::find(tags.begin(), tags.end(), tag);
-    if (it != tags.end()) {
-        return true;
-    } else {
-        Headline* const parent = dynamic_cast<Headline*>(element->parent());
-        if (parent) {
-            return isTagged(parent, tag);
-        } else {
-            return false;
-        }
-    }
-}
-
 Tags::Tags(const Headline::Pointer& element)
     : d(new Private(element))
 {
@@ -58,11 +40,61 @@ Tags::~Tags() = default;
 
 /** @brief hasTag checks if the element is tagged with the specified key.
  *
- * @return true if the element is tagged "tag", directly or inherited from a parent
+ * @return true if the element is tagged "tag", directly, inherited from a parent, or by the file tags
  */
 bool Tags::hasTag(const QString &tag) const
 {
-    return d->isTagged(d->element_.data(), tag);
+    return hasTag(d->element_->atomTable()->find(tag));
+}
+
+/** @brief Check for the tag with the atom tag, from the atom table of the element. This tests two bits. */
+bool Tags::hasTag(AtomTable::Atom tag) const
+{
+    return d->element_->tagSet().contains(tag) || d->element_->inheritedTagSet().contains(tag);
+}
+
+/** @brief Return the headlines that have all tags of required and none of excluded, directly or inherited.
+ *
+ * The tags are looked up once per atom table, every headline is then tested a machine word at a time.
+ */
+Headline::List Tags::filter(const Headline::List &headlines, const QStringList &required,
+                            const QStringList &excluded)
+{
+    Headline::List result;
+    AtomTable::Pointer atoms;
+    TagSet requiredTags;
+    TagSet excludedTags;
+    bool satisfiable = false;
+    for(auto const& headline : headlines) {
+        if (headline->atomTable() != atoms) {
+            atoms = headline->atomTable();
+            requiredTags.clear();
+            excludedTags.clear();
+            satisfiable = true;
+            for(auto const& tag : required) {
+                const AtomTable::Atom atom = atoms->find(tag);
+                //A tag that is not in the table is not on any headline of the document:
+                satisfiable &= atom != AtomTable::InvalidAtom;
+                if (atom != AtomTable::InvalidAtom) {
+                    requiredTags.insert(atom);
+                }
+            }
+            for(auto const& tag : excluded) {
+                const AtomTable::Atom atom = atoms->find(tag);
+                if (atom != AtomTable::InvalidAtom) {
+                    excludedTags.insert(atom);
+                }
+            }
+        }
+        if (!satisfiable) {
+            continue;
+        }
+        const TagSet tags = headline->tagSet() | headline->inheritedTagSet();
+        if (tags.containsAll(requiredTags) && !tags.intersects(excludedTags)) {
+            result.append(headline);
+        }
+    }
+    return result;
 }
 
 }
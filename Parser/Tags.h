@@ -38,6 +38,10 @@ public:
     virtual ~Tags();
 
     bool hasTag(const QString& tag) const;
+    bool hasTag(AtomTable::Atom tag) const;
+
+    static Headline::List filter(const Headline::List& headlines, const QStringList& required,
+                                 const QStringList& excluded = QStringList());
 
 private:
     struct Private;
@@ -0,0 +1,98 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Traversal.h"
+
+namespace OrgMode {
+
+namespace {
+
+/** The entry of element in the child list of its parent, or root if element is the root of the traversal. */
+const OrgElement::Pointer* entryOf(OrgElement* element, const OrgElement::Pointer* root)
+{
+    if (element == root->data()) {
+        return root;
+    }
+    Q_ASSERT(element->parent() && element->childIndex() >= 0);
+    return element->parent()->childSpan().begin() + element->childIndex();
+}
+
+/** The first element of the subtree of entry in postorder, its leftmost leaf. */
+const OrgElement::Pointer* firstLeaf(const OrgElement::Pointer* entry)
+{
+    for (OrgElement::ChildSpan children = (*entry)->childSpan(); !children.isEmpty();
+         children = (*entry)->childSpan()) {
+        entry = children.begin();
+    }
+    return entry;
+}
+
+}
+
+PreorderIterator::PreorderIterator(const OrgElement::Pointer* root)
+    : root_(root)
+    , current_(root && *root ? root : nullptr)
+{
+}
+
+PreorderIterator& PreorderIterator::operator++()
+{
+    Q_ASSERT(current_);
+    if (!skip_) {
+        const OrgElement::ChildSpan children = (*current_)->childSpan();
+        if (!children.isEmpty()) {
+            current_ = children.begin();
+            return *this;
+        }
+    }
+    skip_ = false;
+    //Climb up to the first ancestor that has a next sibling:
+    while (current_ != root_) {
+        OrgElement* const parent = (*current_)->parent();
+        if (current_ + 1 != parent->childSpan().end()) {
+            ++current_;
+            return *this;
+        }
+        current_ = entryOf(parent, root_);
+    }
+    current_ = nullptr;
+    return *this;
+}
+
+PostorderIterator::PostorderIterator(const OrgElement::Pointer* root)
+    : root_(root)
+    , current_(root && *root ? firstLeaf(root) : nullptr)
+{
+}
+
+PostorderIterator& PostorderIterator::operator++()
+{
+    Q_ASSERT(current_);
+    if (current_ == root_) {
+        current_ = nullptr;
+        return *this;
+    }
+    OrgElement* const parent = (*current_)->parent();
+    if (current_ + 1 != parent->childSpan().end()) {
+        current_ = firstLeaf(current_ + 1);
+    } else {
+        current_ = entryOf(parent, root_);
+    }
+    return *this;
+}
+
+}
@@ -0,0 +1,124 @@
+/** OrgModeParser - a parser for Emacs Org Mode files, written in C++.
+    Copyright (C) 2015 Mirko Boehm
+
+    This file is part of OrgModeParser.
+    OrgModeParser is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, version 3 of the
+    License.
+
+    OrgModeParser is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+    See the GNU General Public License for more details. You should
+    have received a copy of the GNU General Public License along with
+    OrgModeParser. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <iterator>
+
+#include "orgmodeparser_export.h"
+#include <OrgElement.h>
+
+namespace OrgMode {
+
+/** @brief PreorderIterator visits the elements of a subtree in preorder, parents before their children.
+ *
+ * The iterator refers to the entries of the child lists of the elements. It does not change reference counts and
+ * does not allocate memory. The tree must not be changed while it is traversed. Lazy children are created when
+ * the iterator enters their parent. A default constructed iterator is the end iterator.
+ */
+class ORGMODEPARSER_EXPORT PreorderIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef OrgElement::Pointer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const OrgElement::Pointer* pointer;
+    typedef const OrgElement::Pointer& reference;
+
+    PreorderIterator() = default;
+    explicit PreorderIterator(const OrgElement::Pointer* root);
+
+    reference operator*() const { return *current_; }
+    pointer operator->() const { return current_; }
+    PreorderIterator& operator++();
+    bool operator==(const PreorderIterator& other) const { return current_ == other.current_; }
+    bool operator!=(const PreorderIterator& other) const { return current_ != other.current_; }
+
+    /** @brief Continue after the subtree of the current element, without visiting its children. */
+    void skipSubtree() { skip_ = true; }
+
+private:
+    const OrgElement::Pointer* root_ = nullptr;
+    const OrgElement::Pointer* current_ = nullptr;
+    bool skip_ = false;
+};
+
+/** @brief PostorderIterator visits the elements of a subtree in postorder, children before their parents.
+ *
+ * @see PreorderIterator
+ */
+class ORGMODEPARSER_EXPORT PostorderIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef OrgElement::Pointer value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const OrgElement::Pointer* pointer;
+    typedef const OrgElement::Pointer& reference;
+
+    PostorderIterator() = default;
+    explicit PostorderIterator(const OrgElement::Pointer* root);
+
+    reference operator*() const { return *current_; }
+    pointer operator->() const { return current_; }
+    PostorderIterator& operator++();
+    bool operator==(const PostorderIterator& other) const { return current_ == other.current_; }
+    bool operator!=(const PostorderIterator& other) const { return current_ != other.current_; }
+
+private:
+    const OrgElement::Pointer* root_ = nullptr;
+    const OrgElement::Pointer* current_ = nullptr;
+};
+
+/** @brief A range of the elements of the subtree of root, for range based for loops.
+ *
+ * The range keeps a reference to root, so that it can be created from a temporary element pointer. Leaving the
+ * loop ends the traversal early, PreorderIterator::skipSubtree() skips the children of an element.
+ */
+template <typename Iterator>
+class TraversalRange
+{
+public:
+    explicit TraversalRange(const OrgElement::Pointer& root)
+        : root_(root)
+    {}
+    Iterator begin() const { return Iterator(&root_); }
+    Iterator end() const { return Iterator(); }
+
+private:
+    OrgElement::Pointer root_;
+};
+
+typedef TraversalRange<PreorderIterator> PreorderRange;
+typedef TraversalRange<PostorderIterator> PostorderRange;
+
+/** @brief The elements of the subtree of root in preorder. */
+inline PreorderRange preorder(const OrgElement::Pointer& root)
+{
+    return PreorderRange(root);
+}
+
+/** @brief The elements of the subtree of root in postorder. */
+inline PostorderRange postorder(const OrgElement::Pointer& root)
+{
+    return PostorderRange(root);
+}
+
+}
+
+#endif // TRAVERSAL_H
@@ -25,6 +25,7 @@
 #include <Exception.h>
 #include "ClockTimeSummary.h"
 #include <Parser.h>
+#include <ParseCache.h>
 
 using namespace OrgMode;
 using namespace std;
@@ -44,8 +45,12 @@ int main(int argc, char *argv[])
                                          a.translate("main", "columns"));
         QCommandLineOption promptModeOption(QStringList() << QStringLiteral("p") << QStringLiteral("promptmode"),
                                             a.translate("main", "Prompt mode (no newline at end)."));
+        QCommandLineOption cacheOption(QStringList() << QStringLiteral("C") << QStringLiteral("cache"),
+                                       a.translate("main", "Cache the parsed files (in %1).")
+                                       .arg(ParseCache::defaultDirectory()));
         parser.addOption(columnsOption);
         parser.addOption(promptModeOption);
+        parser.addOption(cacheOption);
         parser.process(a);
         int columns;
         if (parser.isSet(columnsOption)) {
@@ -58,7 +63,7 @@ int main(int argc, char *argv[])
             columns = 60;
         }
         const bool promptMode = parser.isSet(promptModeOption);
-        ClockTimeSummary clocktime(parser.positionalArguments());
+        ClockTimeSummary clocktime(parser.positionalArguments(), nullptr, parser.isSet(cacheOption));
         clocktime.report(promptMode, columns);
     } catch (const RuntimeException& ex) {
         wcerr << "Error: " << ex.message().toStdWString() << endl
@@ -18,8 +18,6 @@
 #include <numeric>
 #include <iostream>
 
-#include <QTextStream>
-#include <QFile>
 #include <QtDebug>
 #include <QDateTime>
 
@@ -28,6 +26,8 @@
 #include <TimeInterval.h>
 #include <Clock.h>
 #include <Parser.h>
+#include <ParseBatch.h>
+#include <ParseCache.h>
 #include <Exception.h>
 #include <ClockLine.h>
 #include <CompletedClockLine.h>
@@ -39,19 +39,22 @@
 using namespace std;
 using namespace OrgMode;
 
-ClockTimeSummary::ClockTimeSummary(const QStringList &orgfiles, QObject *parent)
+ClockTimeSummary::ClockTimeSummary(const QStringList &orgfiles, QObject *parent, bool useCache)
     : QObject(parent)
     , toplevel_(new OrgFile)
 {
-    for(const QString& filename : orgfiles) {
-        Parser parser;
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            throw RuntimeException(tr("Unable to open file %1!").arg(filename));
+    const Parser parser;
+    ParseBatch batch(parser);
+    //Files that did not change since the last run are loaded from the cache:
+    const ParseCache cache;
+    if (useCache) {
+        batch.setCache(&cache);
+    }
+    for(auto const& result : batch.parseFiles(orgfiles)) {
+        if (!result.isValid()) {
+            throw RuntimeException(result.error);
         }
-        QTextStream stream(&file);
-        OrgElement::Pointer orgfile = parser.parse(&stream, filename);
-        toplevel_->addChild(orgfile);
+        toplevel_->addChild(result.element);
     }
 }
 
@@ -76,7 +79,7 @@ template <typename T>
 T* findParent(OrgElement* element)
 {
     if (!element) return nullptr;
-    auto castedElement = dynamic_cast<T*>(element);
+    auto castedElement = element_cast<T>(element);
     if (castedElement) {
         return castedElement;
     } else {
@@ -92,7 +95,7 @@ void ClockTimeSummary::report(bool promptMode, int columns)
     QString clockedTime;
     //Find all clocklines that are incomplete (not closed):
     auto const notCompleted = [](const ClockLine::Pointer& element) {
-        return element.dynamicCast<CompletedClockLine>() == nullptr;
+        return !element->isKindOf(OrgElement::CompletedClockLineKind);
     };
     auto clocklines = findElements<ClockLine>(toplevel_, notCompleted);
     //Sort by start time, to determine the latest task that was started:
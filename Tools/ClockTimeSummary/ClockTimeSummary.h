@@ -25,7 +25,7 @@ class ClockTimeSummary : public QObject
 {
     Q_OBJECT
 public:
-    explicit ClockTimeSummary(const QStringList& orgfiles, QObject *parent = nullptr);
+    explicit ClockTimeSummary(const QStringList& orgfiles, QObject *parent = nullptr, bool useCache = false);
     int secondsClockedToday() const;
     int secondsClockedThisWeek() const;
 